@@ -0,0 +1,58 @@
+# Measures how matrix load affects latency of unrelated processes.
+#
+# One heavy process per scheduler keeps calling `Matrex.dot/2` on large matrices,
+# while a probe process measures how late it wakes up from a 1 ms sleep.
+# Run it with and without dirty scheduling to see the difference:
+#
+#   mix run bench/dirty_schedulers.exs
+
+defmodule DirtySchedulersBench do
+  @probes 2_000
+  @size 1_000
+
+  def run(label, threshold) do
+    :ok = Matrex.NIFs.set_dirty_threshold(threshold)
+
+    a = Matrex.random(@size)
+    b = Matrex.random(@size)
+
+    workers =
+      for _ <- 1..System.schedulers_online() do
+        spawn(fn -> load(a, b) end)
+      end
+
+    latencies = probe(@probes, [])
+
+    Enum.each(workers, &Process.exit(&1, :kill))
+
+    report(label, latencies)
+  end
+
+  defp load(a, b) do
+    Matrex.dot(a, b)
+    load(a, b)
+  end
+
+  defp probe(0, acc), do: Enum.sort(acc)
+
+  defp probe(n, acc) do
+    started = System.monotonic_time(:microsecond)
+    Process.sleep(1)
+    late = System.monotonic_time(:microsecond) - started - 1_000
+    probe(n - 1, [late | acc])
+  end
+
+  defp report(label, sorted) do
+    count = length(sorted)
+    percentile = fn p -> Enum.at(sorted, min(count - 1, trunc(count * p))) end
+
+    IO.puts(
+      String.pad_trailing(label, 24) <>
+        "p50: #{percentile.(0.50)} µs\tp99: #{percentile.(0.99)} µs\tmax: #{List.last(sorted)} µs"
+    )
+  end
+end
+
+IO.puts("Probe wake-up delay with #{System.schedulers_online()} schedulers busy with dot/2")
+DirtySchedulersBench.run("normal schedulers", 0xFFFFFFFFFFFFFFFF)
+DirtySchedulersBench.run("dirty schedulers", 250_000)
@@ -46,3 +46,32 @@ Benchee.run(
     ]
   ]
 )
+
+# Matrex alone on larger matrices. Run it once with default MATREX_BLAS and once
+# after `MATREX_BLAS=noblas mix compile --force` to compare built-in GEMM with BLAS.
+matrex_dot_jobs = %{
+  "dot" => fn {a, b} -> Matrex.dot(a, b) end,
+  "dot_nt" => fn {a, b} -> Matrex.dot_nt(a, b) end,
+  "dot_tn" => fn {a, b} -> Matrex.dot_tn(a, b) end
+}
+
+matrex_dot_inputs = [
+  {"100x100", {Matrex.random(100), Matrex.random(100)}},
+  {"500x500", {Matrex.random(500), Matrex.random(500)}},
+  {"1000x1000", {Matrex.random(1000), Matrex.random(1000)}},
+  {"2000x2000", {Matrex.random(2000), Matrex.random(2000)}}
+]
+
+Benchee.run(
+  matrex_dot_jobs,
+  inputs: matrex_dot_inputs,
+  formatters: [
+    &Benchee.Formatters.HTML.output/1,
+    &Benchee.Formatters.Console.output/1
+  ],
+  formatter_options: [
+    html: [
+      file: Path.expand("output/matrex_dot.html", __DIR__)
+    ]
+  ]
+)
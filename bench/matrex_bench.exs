@@ -166,4 +166,62 @@ defmodule MatrexBench do
   bench "Add two matrices with scaling" do
     Matrex.add(@random_a_xlarge, @random_b_xlarge, 3.9, 7.5)
   end
+
+  # Elementwise kernels, built for different instruction sets.
+  # Those, not supported by the CPU, fall back to the best supported one.
+
+  bench "Add two 100x100 matrices with scaling, generic" do
+    with_simd(:generic, fn -> Matrex.add(@random_a_large, @random_b_large, 3.9, 7.5) end)
+  end
+
+  bench "Add two 100x100 matrices with scaling, SSE2" do
+    with_simd(:sse2, fn -> Matrex.add(@random_a_large, @random_b_large, 3.9, 7.5) end)
+  end
+
+  bench "Add two 100x100 matrices with scaling, AVX2" do
+    with_simd(:avx2, fn -> Matrex.add(@random_a_large, @random_b_large, 3.9, 7.5) end)
+  end
+
+  bench "Add two 100x100 matrices with scaling, AVX-512" do
+    with_simd(:avx512, fn -> Matrex.add(@random_a_large, @random_b_large, 3.9, 7.5) end)
+  end
+
+  bench "Divide 1000x1000 matrices, generic" do
+    with_simd(:generic, fn -> Matrex.divide(@random_a_xlarge, @random_b_xlarge) end)
+  end
+
+  bench "Divide 1000x1000 matrices, SSE2" do
+    with_simd(:sse2, fn -> Matrex.divide(@random_a_xlarge, @random_b_xlarge) end)
+  end
+
+  bench "Divide 1000x1000 matrices, AVX2" do
+    with_simd(:avx2, fn -> Matrex.divide(@random_a_xlarge, @random_b_xlarge) end)
+  end
+
+  bench "Divide 1000x1000 matrices, AVX-512" do
+    with_simd(:avx512, fn -> Matrex.divide(@random_a_xlarge, @random_b_xlarge) end)
+  end
+
+  bench "1000x1000 matrix sum" do
+    sum(@random_a_xlarge)
+  end
+
+  bench "1000x1000 matrix sum, Kahan" do
+    sum(@random_a_xlarge, :kahan)
+  end
+
+  bench "1000x1000 matrix max" do
+    Matrex.max(@random_a_xlarge)
+  end
+
+  bench "1000x1000 matrix argmax" do
+    argmax(@random_a_xlarge)
+  end
+
+  defp with_simd(isa, fun) do
+    with :unsupported <- Matrex.NIFs.set_simd(isa), do: Matrex.NIFs.set_simd(:auto)
+    result = fun.()
+    Matrex.NIFs.set_simd(:auto)
+    result
+  end
 end
@@ -165,7 +165,8 @@ defmodule Matrex do
   ## Saving and loading matrix
 
   You can save/load matrix with native binary file format (extra fast)
-  and CSV (slow, especially on large matrices).
+  and CSV, which is parsed and written natively in chunks, so large files
+  take little more memory than the matrix itself.
 
   Matrex CSV format is compatible with GNU Octave CSV output,
   so you can use it to exchange data between two systems.
@@ -239,11 +240,21 @@ defmodule Matrex do
   @type element :: number | :nan | :inf | :neg_inf
   @type index :: pos_integer
   @type matrex :: %Matrex{data: binary}
+  @type axis :: :rows | :columns
   @type t :: matrex
 
   # Size of matrix element (float) in bytes
   @element_size 4
 
+  # Size of text chunks, in which CSV files are read and written
+  @csv_chunk_size 1_048_576
+
+  # Size of compressed chunks, in which gzipped files are read
+  @gzip_chunk_size 65_536
+
+  # Number of elements, which Elixir functions are applied to at once
+  @apply_chunk_size 65_536
+
   # Float special values in binary form
   @not_a_number <<0, 0, 192, 255>>
   @positive_infinity <<0, 0, 128, 127>>
@@ -275,7 +286,6 @@ defmodule Matrex do
             multiply: 2,
             ones: 2,
             ones: 1,
-            parse_float: 1,
             random: 2,
             random: 1,
             reshape: 3,
@@ -388,39 +398,48 @@ defmodule Matrex do
   end
 
   defimpl Enumerable do
-    # Matrix element size in bytes
-    @element_size 4
+    # Number of elements decoded into a list at once, while reducing
+    @chunk_size 4096
 
     import Matrex.Guards
+    alias Matrex.NIFs
 
     @doc false
     def count(matrex_data(rows, cols, _data)), do: {:ok, rows * cols}
 
     @doc false
-    def member?(%Matrex{} = matrex, element), do: {:ok, Matrex.contains?(matrex, element)}
+    def member?(%Matrex{} = matrex, element)
+        when is_number(element) or element in [:nan, :inf, :neg_inf],
+        do: {:ok, Matrex.contains?(matrex, element)}
+
+    def member?(%Matrex{}, _element), do: {:ok, false}
 
     @doc false
-    def slice(matrex_data(rows, cols, body)) do
-      {:ok, rows * cols,
-       fn start, length ->
-         Matrex.binary_to_list(binary_part(body, start * @element_size, length * @element_size))
-       end}
+    def slice(matrex_data(rows, cols, _body, data)) do
+      {:ok, rows * cols, &NIFs.chunk_to_list(data, &1, &2)}
     end
 
     @doc false
-    def reduce(matrex_data(_rows, _cols, body), acc, fun) do
-      reduce_each(body, acc, fun)
+    def reduce(matrex_data(rows, cols, _body, data), acc, fun) do
+      reduce_chunks([], data, 0, rows * cols, acc, fun)
     end
 
-    defp reduce_each(_, {:halt, acc}, _fun), do: {:halted, acc}
+    defp reduce_chunks(_elements, _data, _offset, _size, {:halt, acc}, _fun), do: {:halted, acc}
 
-    defp reduce_each(matrix, {:suspend, acc}, fun),
-      do: {:suspended, acc, &reduce_each(matrix, &1, fun)}
+    defp reduce_chunks(elements, data, offset, size, {:suspend, acc}, fun),
+      do: {:suspended, acc, &reduce_chunks(elements, data, offset, size, &1, fun)}
 
-    defp reduce_each(<<elem::binary-@element_size, rest::binary>>, {:cont, acc}, fun),
-      do: reduce_each(rest, fun.(Matrex.binary_to_float(elem), acc), fun)
+    defp reduce_chunks([element | rest], data, offset, size, {:cont, acc}, fun),
+      do: reduce_chunks(rest, data, offset, size, fun.(element, acc), fun)
 
-    defp reduce_each(<<>>, {:cont, acc}, _fun), do: {:done, acc}
+    defp reduce_chunks([], _data, size, size, {:cont, acc}, _fun), do: {:done, acc}
+
+    defp reduce_chunks([], data, offset, size, acc, fun) do
+      length = min(@chunk_size, size - offset)
+      elements = NIFs.chunk_to_list(data, offset, length)
+
+      reduce_chunks(elements, data, offset + length, size, acc, fun)
+    end
   end
 
   @doc """
@@ -443,7 +462,11 @@ defmodule Matrex do
 
   C = αA + βB
 
-  Raises `ErlangError` if matrices' sizes do not match.
+  Matrices of different sizes are broadcast: a 1×n row is added to each row of an m×n matrix,
+  an m×1 column — to each column, without expanding the vector into a full matrix.
+  The same holds for `subtract/2`, `multiply/2` and `divide/2`.
+
+  Raises `ErlangError` if matrices' sizes neither match, nor can be broadcast.
 
   ## Examples
 
@@ -479,23 +502,19 @@ defmodule Matrex do
       │     11.0    10.0    9.0 │
       │     26.0    25.0   24.0 │
       └                         ┘
+
+  Adding a row to each row of a matrix:
+
+      iex> Matrex.add(Matrex.new("1 2 3; 4 5 6"), Matrex.new("10 20 30"))
+      #Matrex[2×3]
+      ┌                         ┐
+      │    11.0    22.0    33.0 │
+      │    14.0    25.0    36.0 │
+      └                         ┘
   """
 
   @spec add(matrex, matrex, number, number) :: matrex
-  def add(
-        %Matrex{
-          data:
-            <<rows::unsigned-integer-little-32, columns::unsigned-integer-little-32,
-              _data1::binary>> = first
-        },
-        %Matrex{
-          data:
-            <<rows::unsigned-integer-little-32, columns::unsigned-integer-little-32,
-              _data2::binary>> = second
-        },
-        alpha \\ 1.0,
-        beta \\ 1.0
-      )
+  def add(%Matrex{data: first}, %Matrex{data: second}, alpha \\ 1.0, beta \\ 1.0)
       when is_number(alpha) and is_number(beta),
       do: %Matrex{data: NIFs.add(first, second, alpha, beta)}
 
@@ -529,6 +548,12 @@ defmodule Matrex do
   If second argument is a function that takes one argument,
   then this function receives the element of the matrix.
 
+  Elements are passed to Elixir functions in chunks of #{@apply_chunk_size}, and chunks
+  of larger matrices are processed by parallel tasks, so the function must not depend
+  on the calling process. Whatever the function raises, or `ArgumentError` for its results,
+  which are not numbers, is raised in the caller. Special values are passed and may be returned
+  as `:nan`, `:inf` and `:neg_inf`.
+
   ## Example
 
       iex> Matrex.magic(5) |> Matrex.apply(&:math.cos/1)
@@ -614,96 +639,83 @@ defmodule Matrex do
           | (element, index -> element)
           | (element, index, index -> element)
         ) :: matrex
-  def apply(%Matrex{data: data} = _matrix, function_atom)
+  def apply(matrex_data(rows, columns, _body, data), function_atom)
       when function_atom in @math_functions do
-    # {rows, cols} = size(matrix)
-
     %Matrex{
       data:
         if(
-          true,
-          # rows * cols < 100_000,
+          rows * columns < 100_000,
           do: NIFs.apply_math(data, function_atom),
           else: NIFs.apply_parallel_math(data, function_atom)
         )
     }
   end
 
-  def apply(
-        %Matrex{
-          data:
-            <<rows::unsigned-integer-little-32, columns::unsigned-integer-little-32,
-              data::binary>>
-        },
-        function
-      )
+  def apply(matrex_data(_rows, _columns, _body, data) = matrex, function)
       when is_function(function, 1) do
-    initial = <<rows::unsigned-integer-little-32, columns::unsigned-integer-little-32>>
-
-    %Matrex{data: apply_on_matrix(data, function, initial)}
+    apply_in_chunks(matrex, fn offset, length ->
+      data |> NIFs.chunk_to_list(offset, length) |> Enum.map(function)
+    end)
   end
 
-  def apply(matrex_data(rows, columns, data), function)
+  def apply(matrex_data(_rows, _columns, _body, data) = matrex, function)
       when is_function(function, 2) do
-    initial = <<rows::unsigned-integer-little-32, columns::unsigned-integer-little-32>>
-    size = rows * columns
-    %Matrex{data: apply_on_matrix(data, function, 1, size, initial)}
+    apply_in_chunks(matrex, fn offset, length ->
+      data
+      |> NIFs.chunk_to_list(offset, length)
+      |> Enum.with_index(offset + 1)
+      |> Enum.map(fn {value, index} -> function.(value, index) end)
+    end)
   end
 
-  def apply(matrex_data(rows, columns, data), function)
+  def apply(matrex_data(_rows, columns, _body, data) = matrex, function)
       when is_function(function, 3) do
-    initial = <<rows::unsigned-integer-little-32, columns::unsigned-integer-little-32>>
-
-    %Matrex{data: apply_on_matrix(data, function, 1, 1, columns, initial)}
-  end
-
-  defp apply_on_matrix(<<>>, _, accumulator), do: accumulator
-
-  defp apply_on_matrix(<<value::float-little-32, rest::binary>>, function, accumulator) do
-    new_value = function.(value)
-
-    apply_on_matrix(rest, function, <<accumulator::binary, new_value::float-little-32>>)
-  end
-
-  defp apply_on_matrix(<<>>, _, _, _, accumulator), do: accumulator
-
-  defp apply_on_matrix(
-         <<value::float-little-32, rest::binary>>,
-         function,
-         index,
-         size,
-         accumulator
-       ) do
-    new_value = function.(value, index)
-
-    apply_on_matrix(
-      rest,
-      function,
-      index + 1,
-      size,
-      <<accumulator::binary, new_value::float-little-32>>
-    )
+    apply_in_chunks(matrex, fn offset, length ->
+      data
+      |> NIFs.chunk_to_list(offset, length)
+      |> Enum.with_index(offset)
+      |> Enum.map(fn {value, index} ->
+        function.(value, div(index, columns) + 1, rem(index, columns) + 1)
+      end)
+    end)
   end
 
-  defp apply_on_matrix(<<>>, _, _, _, _, accumulator), do: accumulator
-
-  defp apply_on_matrix(
-         <<value::float-little-32, rest::binary>>,
-         function,
-         row_index,
-         column_index,
-         columns,
-         accumulator
-       ) do
-    new_value = function.(value, row_index, column_index)
-    new_accumulator = <<accumulator::binary, new_value::float-little-32>>
-
-    case column_index < columns do
-      true ->
-        apply_on_matrix(rest, function, row_index, column_index + 1, columns, new_accumulator)
+  # Elements are decoded into lists and function results are written back natively,
+  # chunk by chunk. Chunks of large matrices are mapped by parallel tasks, each writing
+  # into its place in the preallocated result. Tasks return what they raise, so that the caller
+  # raises it, as it does with the small matrices, instead of exiting with the linked task.
+  defp apply_in_chunks(matrex_data(rows, columns, _body, data), map_chunk) do
+    size = rows * columns
 
-      false ->
-        apply_on_matrix(rest, function, row_index + 1, 1, columns, new_accumulator)
+    if size <= @apply_chunk_size do
+      %Matrex{data: NIFs.from_list(map_chunk.(0, size), rows, columns)}
+    else
+      result = NIFs.mutable_new(data)
+
+      0..div(size - 1, @apply_chunk_size)
+      |> Task.async_stream(
+        fn chunk ->
+          offset = chunk * @apply_chunk_size
+
+          try do
+            values = map_chunk.(offset, min(@apply_chunk_size, size - offset))
+
+            NIFs.mutable_write_list(result, offset, values)
+          catch
+            kind, reason -> {kind, reason, __STACKTRACE__}
+          end
+        end,
+        max_concurrency: System.schedulers_online(),
+        timeout: :infinity
+      )
+      |> Enum.find_value(fn
+        {:ok, :ok} -> nil
+        {:ok, failure} -> failure
+      end)
+      |> case do
+        nil -> %Matrex{data: NIFs.mutable_to_binary(result)}
+        {kind, reason, stacktrace} -> :erlang.raise(kind, reason, stacktrace)
+      end
     end
   end
 
@@ -725,25 +737,18 @@ defmodule Matrex do
       └                                         ┘
   """
   @spec apply(matrex, matrex, (element, element -> element)) :: matrex
-  def apply(matrex_data(rows, columns, data1), matrex_data(rows, columns, data2), function)
+  def apply(
+        matrex_data(rows, columns, _body1, data1) = matrex,
+        matrex_data(rows, columns, _body2, data2),
+        function
+      )
       when is_function(function, 2) do
-    initial = <<rows::unsigned-integer-little-32, columns::unsigned-integer-little-32>>
-    %Matrex{data: apply_on_matrices(data1, data2, function, initial)}
-  end
-
-  defp apply_on_matrices(<<>>, <<>>, _, accumulator), do: accumulator
-
-  defp apply_on_matrices(
-         <<first_value::float-little-32, first_rest::binary>>,
-         <<second_value::float-little-32, second_rest::binary>>,
-         function,
-         accumulator
-       )
-       when is_function(function, 2) do
-    new_value = function.(first_value, second_value)
-    new_accumulator = <<accumulator::binary, new_value::float-little-32>>
-
-    apply_on_matrices(first_rest, second_rest, function, new_accumulator)
+    apply_in_chunks(matrex, fn offset, length ->
+      data1
+      |> NIFs.chunk_to_list(offset, length)
+      |> Enum.zip(NIFs.chunk_to_list(data2, offset, length))
+      |> Enum.map(fn {first, second} -> function.(first, second) end)
+    end)
   end
 
   @doc """
@@ -767,6 +772,25 @@ defmodule Matrex do
   @spec argmax(matrex) :: index
   def argmax(%Matrex{data: data}), do: NIFs.argmax(data) + 1
 
+  @doc """
+  One-based indices of the biggest elements of each row or column. NIF.
+
+  With `:rows` returns rows×1 column of column indices, with `:columns` — 1×columns row of row indices.
+  Indices are stored as floats, like any other matrix elements.
+
+  ## Example
+
+      iex> m = Matrex.new("1 7 3; 8 5 6")
+      iex> Matrex.argmax(m, :rows) |> Matrex.to_list()
+      [2.0, 1.0]
+      iex> Matrex.argmax(m, :columns) |> Matrex.to_list()
+      [2.0, 1.0, 2.0]
+
+  """
+  @spec argmax(matrex, axis) :: matrex
+  def argmax(%Matrex{} = matrex, axis) when axis in [:rows, :columns],
+    do: reduce_axis(matrex, :argmax, axis)
+
   @doc """
   Get element of a matrix at given one-based (row, column) position.
 
@@ -873,9 +897,10 @@ defmodule Matrex do
     do: NIFs.column_to_list(matrix, column - 1)
 
   @doc """
-  Concatenate list of matrices along columns.
+  Concatenate list of matrices along columns or rows. NIF.
 
-  The number of rows must be equal.
+  The number of rows or columns, respectively, must be equal, otherwise `ArgumentError` is raised.
+  The result is allocated once and every matrix is copied into its place.
 
   ## Example
 
@@ -884,10 +909,22 @@ defmodule Matrex do
       │     0.0     0.0     1.0     1.0     2.0     2.0 │
       │     0.0     0.0     1.0     1.0     2.0     2.0 │
       └                                                 ┘
+      iex> Matrex.concat([Matrex.fill(1, 2, 0), Matrex.fill(1, 2, 1)], :rows)
+      #Matrex[2×2]
+      ┌                 ┐
+      │     0.0     0.0 │
+      │     1.0     1.0 │
+      └                 ┘
 
   """
-  @spec concat([matrex]) :: matrex
-  def concat([%Matrex{} | _] = list_of_ma), do: Enum.reduce(list_of_ma, &Matrex.concat(&2, &1))
+  @spec concat([matrex], axis) :: matrex
+  @spec concat(matrex, matrex) :: matrex
+  def concat(list_of_ma, type \\ :columns)
+
+  def concat([%Matrex{} | _] = list_of_ma, type) when type in [:columns, :rows],
+    do: %Matrex{data: NIFs.concat(Enum.map(list_of_ma, & &1.data), type)}
+
+  def concat(%Matrex{} = matrex1, %Matrex{} = matrex2), do: concat(matrex1, matrex2, :columns)
 
   @doc """
   Concatenate two matrices along rows or columns. NIF.
@@ -924,8 +961,6 @@ defmodule Matrex do
       └                         ┘
   """
   @spec concat(matrex, matrex, :columns | :rows) :: matrex
-  def concat(matrex1, matrex2, type \\ :columns)
-
   def concat(
         %Matrex{
           data:
@@ -946,9 +981,12 @@ defmodule Matrex do
       when rows1 == rows2,
       do: %Matrex{data: Matrex.NIFs.concat_columns(first, second)}
 
-  def concat(matrex_data(rows1, columns, data1), matrex_data(rows2, columns, data2), :rows) do
-    matrex_data(rows1 + rows2, columns, data1 <> data2)
-  end
+  def concat(
+        matrex_data(_rows1, columns, _data1, first),
+        matrex_data(_rows2, columns, _data2, second),
+        :rows
+      ),
+      do: %Matrex{data: NIFs.concat([first, second], :rows)}
 
   def concat(matrex_data(rows1, columns1, _data1), matrex_data(rows2, columns2, _data2), type) do
     raise(
@@ -981,7 +1019,9 @@ defmodule Matrex do
   @doc """
   Divides two matrices element-wise or matrix by scalar or scalar by matrix. NIF through `find/2`.
 
-  Raises `ErlangError` if matrices' sizes do not match.
+  A row or a column vector is broadcast over the other matrix, see `add/4`.
+
+  Raises `ErlangError` if matrices' sizes neither match, nor can be broadcast.
 
   ## Examples
 
@@ -1456,7 +1496,11 @@ defmodule Matrex do
   @doc """
   Load matrex from file.
 
-  .csv and .mtx (binary) formats are supported.
+  .csv, .mtx (binary) and .idx formats are supported, gzipped ones too: they are inflated
+  in chunks straight into the matrix, so the whole file is never held in memory.
+  Typed matrices, saved with `Matrex.Typed.save/2`, are loaded as `Matrex.Typed`.
+  So are .idx files of integers, keeping their type, e.g. `:uint8` for MNIST images:
+  use `Matrex.Typed.to_matrex/1` or `load/2` options to convert them to floats.
 
   ## Example
 
@@ -1470,35 +1514,161 @@ defmodule Matrex do
       │     0.0     0.0     0.0     0.0 │
       └                                 ┘
   """
-  @spec load(binary) :: matrex
-  def load(file_name) when is_binary(file_name) do
+  @spec load(binary) :: matrex | Matrex.Typed.t()
+  def load(file_name) when is_binary(file_name), do: load(file_name, [])
+
+  @doc """
+  Load matrex from file in the given format or with options.
+
+  Format is one of `:idx`, `:csv` or `:mtx` and overrides the one from file extension.
+
+  ## Options
+
+    * `:float` — converts integer .idx data into float matrix instead of keeping its type.
+
+    * `:normalize` — converts .idx data into float matrix, mapping its range onto [0, 1],
+      like `normalize/1` does, in the same pass over the data.
+
+    * `:mmap` — maps .mtx file into memory instead of reading it. With `true` or `:read_only`
+      the matrix data is a binary backed by the file pages in the OS page cache,
+      so BEAM processes and OS processes loading the same file share a single copy of it
+      and loading takes the same time for any file size. Such file must not be truncated
+      or rewritten, while the matrix is in use: rewriting it in place, with `save/2` too,
+      changes the binaries the BEAM already holds, and reading past the end of a truncated
+      file crashes the VM. Write a new file and rename it over the old one instead, mapped
+      binaries keep the old contents then. With `:copy_on_write` float matrix is
+      returned as `Matrex.Mutable`, which pages are copied only when written to,
+      and writes never reach the file.
+
+  ## Example
+
+      iex> Matrex.magic(3) |> Matrex.save("magic.mtx")
+      :ok
+      iex> Matrex.load("magic.mtx", mmap: true) == Matrex.magic(3)
+      true
+
+  """
+  @spec load(binary, :idx | :csv | :mtx | keyword) ::
+          matrex | Matrex.Typed.t() | Matrex.Mutable.t()
+  def load(file_name, :csv), do: load_csv(file_name)
+
+  def load(file_name, format) when format in [:idx, :mtx],
+    do: do_load(File.read!(file_name), format)
+
+  def load(file_name, options) when is_binary(file_name) and is_list(options) do
+    case Keyword.get(options, :mmap, false) do
+      false ->
+        load_file(file_name, options)
+
+      mode when mode in [true, :read_only] ->
+        file_name |> NIFs.mmap_file(:read_only) |> do_load(:mtx)
+
+      :copy_on_write ->
+        %Matrex.Mutable{ref: NIFs.mmap_file(file_name, :copy_on_write)}
+    end
+  end
+
+  defp load_file(file_name, options) do
     cond do
       :filename.extension(file_name) == ".gz" ->
-        File.read!(file_name)
-        |> :zlib.gunzip()
-        |> do_load(String.split(file_name, ".") |> Enum.at(-2) |> String.to_existing_atom())
+        file_name
+        |> gunzip_stream()
+        |> load_stream(
+          String.split(file_name, ".") |> Enum.at(-2) |> String.to_existing_atom(),
+          options
+        )
 
       :filename.extension(file_name) == ".csv" ->
-        do_load(File.read!(file_name), :csv)
+        load_csv(file_name)
 
       :filename.extension(file_name) == ".mtx" ->
         do_load(File.read!(file_name), :mtx)
 
       :filename.extension(file_name) == ".idx" ->
-        do_load(File.read!(file_name), :idx)
+        do_load(File.read!(file_name), :idx, options)
 
       true ->
         raise "Unknown file format: #{file_name}"
     end
   end
 
-  @spec load(binary, :idx | :csv | :mtx) :: matrex
-  def load(file_name, format) when format in [:idx, :mtx, :csv],
-    do: do_load(File.read!(file_name), format)
+  defp do_load(data, format, options \\ [])
 
-  defp do_load(data, :csv), do: new(data)
-  defp do_load(data, :mtx), do: %Matrex{data: data}
-  defp do_load(data, :idx), do: %Matrex{data: Matrex.IDX.load(data)}
+  defp do_load(data, :mtx, _options) do
+    if Matrex.Typed.typed?(data),
+      do: %Matrex.Typed{data: data},
+      else: %Matrex{data: data}
+  end
+
+  defp do_load(data, :idx, options), do: data |> Matrex.IDX.load(options) |> do_load(:mtx)
+
+  # Stores inflated chunks right into the matrix, allocated, as soon as its header is read,
+  # so that neither compressed, nor inflated file is held in memory as a whole.
+  defp load_stream(chunks, :csv, _options), do: read_csv(chunks)
+
+  defp load_stream(chunks, format, options) when format in [:mtx, :idx] do
+    normalize = Keyword.get(options, :normalize, false)
+    stream = NIFs.stream_new(format, normalize or Keyword.get(options, :float, false), normalize)
+
+    Enum.each(chunks, &NIFs.stream_write(stream, &1))
+
+    stream |> NIFs.stream_finish() |> do_load(:mtx)
+  end
+
+  defp gunzip_stream(file_name) do
+    Stream.resource(
+      fn ->
+        zstream = :zlib.open()
+        # Window bits of 16 + 15 expect gzip header.
+        :ok = :zlib.inflateInit(zstream, 31)
+        {zstream, File.open!(file_name, [:read, :raw, :binary]), :read}
+      end,
+      &inflate_chunk/1,
+      fn {zstream, file, _} ->
+        :zlib.close(zstream)
+        File.close(file)
+      end
+    )
+  end
+
+  # Inflated data of one compressed chunk may be large, so it's taken out piece by piece.
+  defp inflate_chunk({zstream, file, :continue}), do: safe_inflate(zstream, file, [])
+
+  defp inflate_chunk({zstream, file, :read} = state) do
+    case :file.read(file, @gzip_chunk_size) do
+      {:ok, data} ->
+        safe_inflate(zstream, file, data)
+
+      # `:finished` of safeInflate/2 only means, that the input read so far is consumed,
+      # while inflateEnd/1 raises `:data_error`, when the gzip stream itself didn't end.
+      :eof ->
+        :ok = :zlib.inflateEnd(zstream)
+        {:halt, state}
+    end
+  end
+
+  defp safe_inflate(zstream, file, data) do
+    case :zlib.safeInflate(zstream, data) do
+      {:continue, output} -> {[IO.iodata_to_binary(output)], {zstream, file, :continue}}
+      {:finished, output} -> {[IO.iodata_to_binary(output)], {zstream, file, :read}}
+    end
+  end
+
+  # Reads CSV file in chunks, so that only the matrix itself is held in memory.
+  defp load_csv(file_name), do: file_name |> File.stream!([], @csv_chunk_size) |> read_csv()
+
+  defp read_csv(chunks) do
+    reader = NIFs.csv_reader_new()
+
+    Enum.each(chunks, fn chunk ->
+      with {:error, message} <- NIFs.csv_read(reader, chunk), do: raise(ArgumentError, message)
+    end)
+
+    case NIFs.csv_finish(reader) do
+      {:error, message} -> raise ArgumentError, message
+      data -> %Matrex{data: data}
+    end
+  end
 
   @doc """
   Creates "magic" n*n matrix, where sums of all dimensions are equal.
@@ -1547,6 +1717,22 @@ defmodule Matrex do
   @spec max(matrex) :: element
   def max(%Matrex{data: matrix}), do: NIFs.max(matrix)
 
+  @doc """
+  Maximum elements of each row (`:rows`) as a column or of each column (`:columns`) as a row. NIF.
+
+  ## Example
+
+      iex> m = Matrex.new("1 7 3; 8 5 6")
+      iex> Matrex.max(m, :rows) |> Matrex.to_list()
+      [7.0, 8.0]
+      iex> Matrex.max(m, :columns) |> Matrex.to_list()
+      [8.0, 7.0, 6.0]
+
+  """
+  @spec max(matrex, axis) :: matrex
+  def max(%Matrex{} = matrex, axis) when axis in [:rows, :columns],
+    do: reduce_axis(matrex, :max, axis)
+
   @doc """
   Returns maximum finite element of a matrex. NIF.
 
@@ -1561,6 +1747,22 @@ defmodule Matrex do
   @spec max_finite(matrex) :: float
   def max_finite(%Matrex{data: matrix}), do: NIFs.max_finite(matrix)
 
+  @doc """
+  Mean values of each row (`:rows`) as a column or of each column (`:columns`) as a row. NIF.
+
+  ## Example
+
+      iex> m = Matrex.new("1 7 3; 8 5 6")
+      iex> Matrex.mean(m, :rows) |> Matrex.to_list()
+      [3.6666667461395264, 6.333333492279053]
+      iex> Matrex.mean(m, :columns) |> Matrex.to_list()
+      [4.5, 6.0, 4.5]
+
+  """
+  @spec mean(matrex, axis) :: matrex
+  def mean(%Matrex{} = matrex, axis) when axis in [:rows, :columns],
+    do: reduce_axis(matrex, :mean, axis)
+
   @doc """
 
   Minimum element in a matrix. NIF.
@@ -1586,6 +1788,22 @@ defmodule Matrex do
   @spec min(matrex) :: element
   def min(%Matrex{data: matrix}), do: NIFs.min(matrix)
 
+  @doc """
+  Minimum elements of each row (`:rows`) as a column or of each column (`:columns`) as a row. NIF.
+
+  ## Example
+
+      iex> m = Matrex.new("1 7 3; 8 5 6")
+      iex> Matrex.min(m, :rows) |> Matrex.to_list()
+      [1.0, 5.0]
+      iex> Matrex.min(m, :columns) |> Matrex.to_list()
+      [1.0, 5.0, 3.0]
+
+  """
+  @spec min(matrex, axis) :: matrex
+  def min(%Matrex{} = matrex, axis) when axis in [:rows, :columns],
+    do: reduce_axis(matrex, :min, axis)
+
   @doc """
   Returns minimum finite element of a matrex. NIF.
 
@@ -1603,7 +1821,9 @@ defmodule Matrex do
   @doc """
   Elementwise multiplication of two matrices or matrix and a scalar. NIF.
 
-  Raises `ErlangError` if matrices' sizes do not match.
+  A row or a column vector is broadcast over the other matrix, see `add/4`.
+
+  Raises `ErlangError` if matrices' sizes neither match, nor can be broadcast.
 
   ## Examples
 
@@ -1678,16 +1898,16 @@ defmodule Matrex do
   @spec new(index, index, (() -> element)) :: matrex
   @spec new(index, index, (index, index -> element)) :: matrex
   def new(rows, columns, function) when is_function(function, 0) do
-    initial = <<rows::unsigned-integer-little-32, columns::unsigned-integer-little-32>>
+    elements = Stream.repeatedly(function) |> Enum.take(rows * columns)
 
-    new_matrix_from_function(rows * columns, function, initial)
+    %Matrex{data: NIFs.from_list(elements, rows, columns)}
   end
 
   def new(rows, columns, function) when is_function(function, 2) do
-    initial = <<rows::unsigned-integer-little-32, columns::unsigned-integer-little-32>>
-    size = rows * columns
+    elements =
+      for row <- 1..rows, column <- 1..columns, rows * columns > 0, do: function.(row, column)
 
-    new_matrix_from_function(size, rows, columns, function, initial)
+    %Matrex{data: NIFs.from_list(elements, rows, columns)}
   end
 
   @doc """
@@ -1720,6 +1940,10 @@ defmodule Matrex do
 
   List of lists can contain other matrices, which are concatenated in one.
 
+  Lists of numbers, `:nan`, `:inf` and `:neg_inf` are written straight into the new matrix natively,
+  yielding on huge ones. `ArgumentError` is raised, if rows have different lengths
+  or an element is unknown.
+
   ## Example
 
       iex> Matrex.new([[1, 2, 3], [4, 5, 6]])
@@ -1776,75 +2000,13 @@ defmodule Matrex do
       ) do
     lol_of_ma
     |> Enum.map(&Matrex.concat/1)
-    |> Enum.reduce(&Matrex.concat(&2, &1, :rows))
-  end
-
-  def new([first_list | _] = lol_or_binary) when is_list(first_list) do
-    rows = length(lol_or_binary)
-    columns = length(first_list)
-
-    initial = <<rows::unsigned-integer-little-32, columns::unsigned-integer-little-32>>
-
-    %Matrex{
-      data:
-        Enum.reduce(lol_or_binary, initial, fn list, accumulator ->
-          accumulator <>
-            Enum.reduce(list, <<>>, fn element, partial ->
-              <<partial::binary, float_to_binary(element)::binary>>
-            end)
-        end)
-    }
-  end
-
-  def new(text) when is_binary(text) do
-    text
-    |> String.split(["\n", ";"], trim: true)
-    |> Enum.map(fn line ->
-      line
-      |> String.split(["\s", ","], trim: true)
-      |> Enum.map(fn f -> parse_float(f) end)
-    end)
-    |> new()
+    |> Matrex.concat(:rows)
   end
 
-  @spec parse_float(binary) :: element | :nan | :inf | :neg_inf
-  defp parse_float("NaN"), do: :nan
-  defp parse_float("Inf"), do: :inf
-  defp parse_float("+Inf"), do: :inf
-  defp parse_float("-Inf"), do: :neg_inf
-  defp parse_float("NegInf"), do: :neg_inf
-
-  defp parse_float(string) do
-    case Float.parse(string) do
-      {value, _rem} -> value
-      :error -> raise ArgumentError, message: "Unparseable matrix element value: #{string}"
-    end
-  end
+  def new([first_list | _] = lol_or_binary) when is_list(first_list),
+    do: %Matrex{data: NIFs.from_list(lol_or_binary, length(lol_or_binary), length(first_list))}
 
-  defp new_matrix_from_function(0, _, accumulator), do: %Matrex{data: accumulator}
-
-  defp new_matrix_from_function(size, function, accumulator),
-    do:
-      new_matrix_from_function(
-        size - 1,
-        function,
-        <<accumulator::binary, function.()::float-little-32>>
-      )
-
-  defp new_matrix_from_function(0, _, _, _, accumulator), do: %Matrex{data: accumulator}
-
-  defp new_matrix_from_function(size, rows, columns, function, accumulator) do
-    {row, col} =
-      if rem(size, columns) == 0 do
-        {rows - div(size, columns), 0}
-      else
-        {rows - 1 - div(size, columns), columns - rem(size, columns)}
-      end
-
-    new_accumulator = <<accumulator::binary, function.(row + 1, col + 1)::float-little-32>>
-
-    new_matrix_from_function(size - 1, rows, columns, function, new_accumulator)
-  end
+  def new(text) when is_binary(text), do: read_csv([text])
 
   @doc """
   Bring all values of matrix into [0, 1] range. NIF.
@@ -1960,9 +2122,27 @@ defmodule Matrex do
   end
 
   @doc """
-  Create matrix of random floats in [0, 1] range. NIF.
+  Create matrix of random floats in [0, 1) range or of the given distribution. NIF.
+
+  Elements come from Philox4x32-10 counter-based generator: each one is computed
+  from its index and the seed, so there is no generator state shared between calls,
+  big matrices are generated by worker threads in parallel, and the same seed
+  gives the same matrix. Every call without a seed gets a new one.
+
+  ## Options
+
+    * `:seed` — integer seed for a reproducible matrix.
+
+    * `:distribution` — `:uniform` (the default), `:normal`, `:truncated_normal` or `:bernoulli`.
+
+    * `:min` and `:max` — range of `:uniform` distribution, 0 and 1 by default.
+
+    * `:mean` and `:std` — mean and standard deviation of `:normal` and `:truncated_normal`
+      distributions, 0 and 1 by default. Truncated normal elements, which fall further than
+      two standard deviations from the mean, are drawn again.
 
-  C language RNG is seeded on NIF libray load with `srandom(time(NULL) + clock())`.
+    * `:p` — probability of 1.0 for `:bernoulli` distribution, which gives 0.0 otherwise,
+      0.5 by default.
 
   ## Example
 
@@ -1974,11 +2154,33 @@ defmodule Matrex do
       │ 0.52953  0.9071 0.26743 │
       │ 0.82189 0.59311  0.8451 │
       └                         ┘
+      iex> Matrex.random(2, 3, distribution: :normal, std: 0.1, seed: 42) ==
+      ...>   Matrex.random(2, 3, distribution: :normal, std: 0.1, seed: 42)
+      true
 
   """
-  @spec random(index, index) :: matrex
-  def random(rows, columns) when is_integer(rows) and is_integer(columns),
-    do: %Matrex{data: NIFs.random(rows, columns)}
+  @spec random(index, index, keyword) :: matrex
+  def random(rows, columns, options \\ []) when is_integer(rows) and is_integer(columns) do
+    distribution =
+      case Keyword.get(options, :distribution, :uniform) do
+        :uniform ->
+          {:uniform, Keyword.get(options, :min, 0), Keyword.get(options, :max, 1)}
+
+        normal when normal in [:normal, :truncated_normal] ->
+          {normal, Keyword.get(options, :mean, 0), Keyword.get(options, :std, 1)}
+
+        :bernoulli ->
+          {:bernoulli, Keyword.get(options, :p, 0.5)}
+      end
+
+    seed =
+      case Keyword.get(options, :seed) do
+        nil -> nil
+        seed when is_integer(seed) -> :erlang.band(seed, 0xFFFF_FFFF_FFFF_FFFF)
+      end
+
+    %Matrex{data: NIFs.random(rows, columns, distribution, seed)}
+  end
 
   @doc """
   Create square matrix of random floats.
@@ -2102,15 +2304,7 @@ defmodule Matrex do
 
   @spec reshape([element], index, index) :: matrex
   def reshape([_ | _] = list, rows, columns),
-    do: %Matrex{
-      data:
-        do_reshape(
-          <<rows::unsigned-integer-little-32, columns::unsigned-integer-little-32>>,
-          list,
-          rows,
-          columns
-        )
-    }
+    do: %Matrex{data: NIFs.from_list(list, rows, columns)}
 
   @spec reshape(matrex, index, index) :: matrex
   def reshape(
@@ -2154,34 +2348,6 @@ defmodule Matrex do
   @spec reshape(Enumerable.t(), index, index) :: matrex
   def reshape(input, rows, columns), do: input |> Enum.to_list() |> reshape(rows, columns)
 
-  defp do_reshape(data, [], 1, 0), do: data
-
-  defp do_reshape(_data, [], _, _),
-    do: raise(ArgumentError, message: "Not enough elements for this shape")
-
-  defp do_reshape(_data, [_ | _], 1, 0),
-    do: raise(ArgumentError, message: "Too much elements for this shape")
-
-  # Another row is ready, restart counters
-  defp do_reshape(
-         <<_rows::unsigned-integer-little-32, columns::unsigned-integer-little-32, _::binary>> =
-           data,
-         list,
-         row,
-         0
-       ),
-       do: do_reshape(data, list, row - 1, columns)
-
-  defp do_reshape(
-         <<_rows::unsigned-integer-little-32, _columns::unsigned-integer-little-32, _::binary>> =
-           data,
-         [elem | tail],
-         row,
-         column
-       ) do
-    do_reshape(<<data::binary, float_to_binary(elem)::binary-4>>, tail, row, column - 1)
-  end
-
   @doc """
   Return matrix row as list by one-based index.
 
@@ -2265,23 +2431,26 @@ defmodule Matrex do
         File.write!(file_name, matrix)
 
       :filename.extension(file_name) == ".csv" ->
-        csv =
-          matrix
-          |> NIFs.to_list_of_lists()
-          |> Enum.reduce("", fn row_list, acc ->
-            acc <>
-              Enum.reduce(row_list, "", fn elem, line ->
-                line <> element_to_string(elem) <> ","
-              end) <> "\n"
-          end)
-
-        File.write!(file_name, csv)
+        File.open!(file_name, [:write, :raw, :binary], &write_csv(&1, matrix))
 
       true ->
         raise "Unknown file format: #{file_name}"
     end
   end
 
+  # Writes matrix in chunks of about @csv_chunk_size bytes, so the whole text is never in memory.
+  defp write_csv(file, matrix) do
+    <<rows::unsigned-integer-little-32, columns::unsigned-integer-little-32, _::binary>> = matrix
+    chunk_rows = max(div(@csv_chunk_size, columns * 16 + 1), 1)
+
+    0
+    |> Stream.iterate(&(&1 + chunk_rows))
+    |> Stream.take_while(&(&1 < rows))
+    |> Enum.each(fn from_row ->
+      :ok = :file.write(file, NIFs.csv_write(matrix, from_row, min(chunk_rows, rows - from_row)))
+    end)
+  end
+
   @doc false
   @spec element_to_string(element) :: binary
   # Save zero values without fraction part to save space
@@ -2478,7 +2647,9 @@ defmodule Matrex do
   @doc """
   Subtracts two matrices or matrix from scalar element-wise. NIF.
 
-  Raises `ErlangError` if matrices' sizes do not match.
+  A row or a column vector is broadcast over the other matrix, see `add/4`.
+
+  Raises `ErlangError` if matrices' sizes neither match, nor can be broadcast.
 
   ## Examples
 
@@ -2545,6 +2716,14 @@ defmodule Matrex do
 
   Can return special float values as atoms.
 
+  Elements are summed in double precision, block by block, in parallel for big matrices.
+  `mode` selects how block sums are combined: `:pairwise` (default) adds them up by halves,
+  `:kahan` uses compensated summation, which is slower, but accurate to the last bit in most cases.
+  Both give the same result regardless of the number of worker threads.
+
+  With `:rows` or `:columns` sums each row into a column or each column into a row.
+  Columns are accumulated row by row, reading the matrix in memory order.
+
   ## Example
 
       iex> m = Matrex.magic(3)
@@ -2565,9 +2744,24 @@ defmodule Matrex do
       └                 ┘
       iex> sum(m)
       :inf
+
+      iex> Matrex.new("1 2 3; 4 5 6") |> Matrex.sum(:columns) |> Matrex.to_list()
+      [5.0, 7.0, 9.0]
   """
-  @spec sum(matrex) :: element
-  def sum(%Matrex{data: matrix}), do: NIFs.sum(matrix)
+  @spec sum(matrex, :pairwise | :kahan | axis) :: element | matrex
+  def sum(matrex, mode \\ :pairwise)
+  def sum(%Matrex{data: matrix}, :pairwise), do: NIFs.sum(matrix)
+  def sum(%Matrex{data: matrix}, :kahan), do: NIFs.sum(matrix, :kahan)
+
+  def sum(%Matrex{} = matrex, axis) when axis in [:rows, :columns],
+    do: reduce_axis(matrex, :sum, axis)
+
+  # Reduces each row into rows×1 column or each column into 1×columns row.
+  defp reduce_axis(%Matrex{data: matrix}, reduction, :rows),
+    do: %Matrex{data: NIFs.reduce_rows(matrix, reduction)}
+
+  defp reduce_axis(%Matrex{data: matrix}, reduction, :columns),
+    do: %Matrex{data: NIFs.reduce_columns(matrix, reduction)}
 
   @doc """
   Trace of matrix (sum of all diagonal elements). Elixir.
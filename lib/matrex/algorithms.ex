@@ -23,6 +23,7 @@
 
 defmodule Matrex.Algorithms do
   alias Matrex.Dashboard
+  require Matrex.Lazy
 
   @moduledoc """
   Machine learning algorithms using matrices.
@@ -564,17 +565,10 @@ defmodule Matrex.Algorithms do
     # y_test = Matrex.load("test/data/Ytest.mtx")
 
     accuracy =
-      1..predictions[:rows]
-      |> Enum.reduce(0, fn row, acc ->
-        if y[row] == predictions[row][:argmax] do
-          acc + 1
-        else
-          # Show wrongful predictions
-          # x[row][2..785] |> Matrex.reshape(28, 28) |> Matrex.heatmap()
-          # IO.puts("#{y[row]} != #{predictions[row][:argmax]}")
-          acc
-        end
-      end)
+      predictions
+      |> Matrex.argmax(:rows)
+      |> Enum.zip(y)
+      |> Enum.count(fn {predicted, expected} -> predicted == expected end)
       |> Kernel./(predictions[:rows])
       |> Kernel.*(100)
       |> IO.inspect(label: "\rTraining set accuracy")
@@ -751,10 +745,7 @@ defmodule Matrex.Algorithms do
     y_b = M.zeros(num_labels, m)
     y_b = Enum.reduce(1..m, y_b, fn i, y_b -> M.set(y_b, trunc(y[i]), i, 1) end)
 
-    c =
-      M.neg(y_b)
-      |> M.multiply(M.apply(a3, :log))
-      |> M.subtract(M.multiply(M.subtract(1, y_b), M.apply(M.subtract(1, a3), :log)))
+    c = Matrex.Lazy.fuse((-y_b <|> log(a3)) - ((1 - y_b) <|> log(1 - a3)))
 
     theta1_sum =
       theta1
@@ -0,0 +1,273 @@
+defmodule Matrex.Lazy do
+  @moduledoc """
+  Elementwise matrix expressions, evaluated in a single pass.
+
+  Each `Matrex` function makes a full pass over memory and allocates a matrix for its result.
+  Functions of this module only build an expression tree, which `eval/1` runs as one NIF call:
+  operands are read block by block, intermediate results stay in processor cache
+  and only the final matrix is allocated.
+
+  `fuse/1` macro rewrites an expression, written with `Matrex.Operators` and math functions,
+  into lazy calls and evaluates it.
+
+  ## Example
+
+      iex> require Matrex.Lazy
+      iex> a = Matrex.new("1 2; 3 4")
+      iex> b = Matrex.new("4 3; 2 1")
+      iex> Matrex.Lazy.fuse((a + b) * 2 - (a <|> b)) |> Matrex.to_list()
+      [6.0, 4.0, 4.0, 6.0]
+
+  Operations on matrices of different sizes, which are broadcast, and matrix products
+  are not elementwise, so they are evaluated eagerly, as soon as they are built.
+  """
+
+  alias Matrex.NIFs
+
+  @enforce_keys [:expression, :rows, :columns]
+  defstruct [:expression, :rows, :columns]
+
+  @type expression ::
+          {:matrix, binary}
+          | {:add | :subtract | :multiply | :divide, expression | number, expression | number}
+          | {:neg, expression}
+          | {:apply, atom, expression}
+  @type t :: %Matrex.Lazy{expression: expression, rows: Matrex.index(), columns: Matrex.index()}
+  @type operand :: t | Matrex.t() | number
+
+  @math_functions Matrex.math_functions_list()
+  @binary_operations [:add, :subtract, :multiply, :divide]
+  @operators %{+: :add, -: :subtract, /: :divide, <|>: :multiply}
+
+  # Limits of the native evaluator: program length and depth of its value stack.
+  @max_length 256
+  @max_depth 16
+
+  @doc """
+  Lazy expression of a single matrix.
+  """
+  @spec new(t | Matrex.t()) :: t
+  def new(
+        %Matrex{
+          data:
+            <<rows::unsigned-integer-little-32, columns::unsigned-integer-little-32,
+              _rest::binary>> = data
+        }
+      ),
+      do: %Matrex.Lazy{expression: {:matrix, data}, rows: rows, columns: columns}
+
+  def new(%Matrex.Lazy{} = lazy), do: lazy
+
+  @doc """
+  Lazy elementwise sum. See `Matrex.add/2`.
+  """
+  @spec add(operand, operand) :: t | number
+  def add(a, b), do: binary(:add, a, b)
+
+  @doc """
+  Lazy elementwise difference. See `Matrex.subtract/2`.
+  """
+  @spec subtract(operand, operand) :: t | number
+  def subtract(a, b), do: binary(:subtract, a, b)
+
+  @doc """
+  Lazy elementwise product. See `Matrex.multiply/2`.
+  """
+  @spec multiply(operand, operand) :: t | number
+  def multiply(a, b), do: binary(:multiply, a, b)
+
+  @doc """
+  Lazy elementwise division. See `Matrex.divide/2`.
+  """
+  @spec divide(operand, operand) :: t | number
+  def divide(a, b), do: binary(:divide, a, b)
+
+  @doc """
+  Lazy elementwise square. See `Matrex.square/1`.
+  """
+  @spec square(operand) :: t | number
+  def square(a), do: multiply(a, a)
+
+  @doc """
+  Lazy negation. See `Matrex.neg/1`.
+  """
+  @spec neg(operand) :: t | number
+  def neg(a) when is_number(a), do: Kernel.-(a)
+
+  def neg(a) do
+    %Matrex.Lazy{expression: expression} = lazy = new(a)
+    %Matrex.Lazy{lazy | expression: {:neg, expression}}
+  end
+
+  @doc """
+  Lazy application of math function, one of those `Matrex.apply/2` accepts as atoms.
+  """
+  @spec apply(operand, atom) :: t | Matrex.element()
+  def apply(a, function) when is_number(a) and function in @math_functions,
+    do: [[a]] |> Matrex.new() |> Matrex.apply(function) |> Matrex.first()
+
+  def apply(a, function) when function in @math_functions do
+    %Matrex.Lazy{expression: expression} = lazy = new(a)
+    %Matrex.Lazy{lazy | expression: {:apply, function, expression}}
+  end
+
+  @doc """
+  Evaluates lazy expression in a single pass. NIF.
+  """
+  @spec eval(t | Matrex.t()) :: Matrex.t()
+  def eval(%Matrex{} = matrex), do: matrex
+  def eval(%Matrex.Lazy{expression: expression}), do: %Matrex{data: run(expression)}
+
+  @doc """
+  Evaluates expression, written with `Matrex.Operators`, in a single pass.
+
+  Rewrites `+`, `-`, `*`, `/`, `<|>` operators, math functions, e.g. `log/1`, `pow2/1`
+  and `Matrex.apply/2` with a math function atom, into calls to this module functions.
+  Other calls and variables are evaluated as usual and become operands of the expression.
+  As in `Matrex.Operators`, `*` of two matrices is a matrix product.
+
+      iex> require Matrex.Lazy
+      iex> y = Matrex.new("1 0 1")
+      iex> h = Matrex.new("0.5 0.25 1.0")
+      iex> Matrex.Lazy.fuse(1 - y + pow2(h - y) / 2) |> Matrex.to_list()
+      [0.125, 1.03125, 0.0]
+
+  """
+  defmacro fuse(expression) do
+    quote do
+      Matrex.Lazy.eval(unquote(lazy(expression)))
+    end
+  end
+
+  @doc false
+  # `*` of Matrex.Operators: matrix product of two matrices, elementwise product otherwise.
+  def operator_multiply(a, b) when is_number(a) or is_number(b), do: multiply(a, b)
+  def operator_multiply(a, b), do: a |> eval() |> Matrex.dot(eval(b)) |> new()
+
+  defp lazy({:|>, _, [left, right]}), do: lazy(Macro.pipe(left, right, 0))
+  defp lazy({:-, _, [a]}), do: quote(do: Matrex.Lazy.neg(unquote(lazy(a))))
+
+  defp lazy({:*, _, [a, b]}),
+    do: quote(do: Matrex.Lazy.operator_multiply(unquote(lazy(a)), unquote(lazy(b))))
+
+  defp lazy({operator, _, [a, b]}) when operator in [:+, :-, :/, :<|>] do
+    function = Map.fetch!(@operators, operator)
+    quote(do: Matrex.Lazy.unquote(function)(unquote(lazy(a)), unquote(lazy(b))))
+  end
+
+  defp lazy({:pow2, _, [a]}), do: quote(do: Matrex.Lazy.square(unquote(lazy(a))))
+
+  defp lazy({function, _, [a]}) when function in @math_functions,
+    do: quote(do: Matrex.Lazy.apply(unquote(lazy(a)), unquote(function)))
+
+  defp lazy({:apply, _, [a, function]}) when function in @math_functions,
+    do: quote(do: Matrex.Lazy.apply(unquote(lazy(a)), unquote(function)))
+
+  defp lazy({{:., _, [{:__aliases__, _, [:Matrex]}, :apply]}, _, [a, function]})
+       when function in @math_functions,
+       do: quote(do: Matrex.Lazy.apply(unquote(lazy(a)), unquote(function)))
+
+  defp lazy(other), do: other
+
+  defp binary(operation, a, b) when is_number(a) and is_number(b),
+    do: Kernel.apply(Kernel, kernel_operator(operation), [a, b])
+
+  defp binary(operation, a, b) when is_number(a) do
+    %Matrex.Lazy{expression: expression} = lazy = new(b)
+    %Matrex.Lazy{lazy | expression: {operation, a, expression}}
+  end
+
+  defp binary(operation, a, b) when is_number(b) do
+    %Matrex.Lazy{expression: expression} = lazy = new(a)
+    %Matrex.Lazy{lazy | expression: {operation, expression, b}}
+  end
+
+  defp binary(operation, a, b) do
+    case {new(a), new(b)} do
+      {%Matrex.Lazy{rows: rows, columns: columns} = a,
+       %Matrex.Lazy{rows: rows, columns: columns} = b} ->
+        %Matrex.Lazy{a | expression: {operation, a.expression, b.expression}}
+
+      {a, b} ->
+        Matrex |> Kernel.apply(operation, [eval(a), eval(b)]) |> new()
+    end
+  end
+
+  defp kernel_operator(:add), do: :+
+  defp kernel_operator(:subtract), do: :-
+  defp kernel_operator(:multiply), do: :*
+  defp kernel_operator(:divide), do: :/
+
+  defp run({:matrix, data}), do: data
+
+  defp run(expression) do
+    {expression, _length} = bound(expression)
+    {program, operands} = compile(expression, 0, {[], []})
+
+    NIFs.eval_expression(Enum.reverse(program), Enum.reverse(operands))
+  end
+
+  # Evaluates subexpressions separately, until the program fits into @max_length instructions.
+  # Returns the expression and the length of its program.
+  defp bound({operation, a, b}) when operation in @binary_operations do
+    {a, a_length} = bound(a)
+    {b, b_length} = bound(b)
+
+    cond do
+      a_length + b_length < @max_length -> {{operation, a, b}, a_length + b_length + 1}
+      a_length >= b_length -> bound({operation, {:matrix, run(a)}, b})
+      true -> bound({operation, a, {:matrix, run(b)}})
+    end
+  end
+
+  defp bound({:neg, a}) do
+    {a, a_length} = bound(a)
+
+    if a_length < @max_length,
+      do: {{:neg, a}, a_length + 1},
+      else: {{:neg, {:matrix, run(a)}}, 2}
+  end
+
+  defp bound({:apply, function, a}) do
+    {a, a_length} = bound(a)
+
+    if a_length < @max_length,
+      do: {{:apply, function, a}, a_length + 1},
+      else: {{:apply, function, {:matrix, run(a)}}, 2}
+  end
+
+  defp bound(leaf), do: {leaf, 1}
+
+  # Builds program in postfix form, in reverse. Values of subexpressions are pushed on a stack,
+  # so the right operand of a binary operation is computed one level deeper, than the left one.
+  defp compile({:matrix, data}, _depth, {program, operands}),
+    do: {[{:load, length(operands)} | program], [data | operands]}
+
+  defp compile(number, _depth, {program, operands}) when is_number(number),
+    do: {[{:scalar, number} | program], operands}
+
+  defp compile({:neg, a}, depth, acc) do
+    {program, operands} = compile(a, depth, acc)
+    {[:neg | program], operands}
+  end
+
+  defp compile({:apply, function, a}, depth, acc) do
+    {program, operands} = compile(a, depth, acc)
+    {[{:apply, function} | program], operands}
+  end
+
+  defp compile({_operation, _a, _b} = expression, depth, acc) when depth + 1 >= @max_depth,
+    do: compile({:matrix, run(expression)}, depth, acc)
+
+  defp compile({operation, a, b}, depth, acc) do
+    acc = compile(a, depth, acc)
+    {program, operands} = compile(b, depth + 1, acc)
+    {[operation | program], operands}
+  end
+
+  defimpl Inspect do
+    @doc false
+    def inspect(%Matrex.Lazy{rows: rows, columns: columns}, _opts),
+      do: "#Matrex.Lazy[#{rows}×#{columns}]"
+  end
+end
@@ -0,0 +1,145 @@
+defmodule Matrex.Mutable do
+  @moduledoc """
+  Matrix in a native buffer, which operations overwrite in place.
+
+  Every `Matrex` function allocates a new binary for its result. Iterative algorithms,
+  which compute matrices of the same size over and over, can instead allocate
+  destination matrices once and keep writing into them.
+
+  Operands of the functions below may be either `Matrex` or `Matrex.Mutable` matrices.
+  Writes are not synchronized, so a mutable matrix shared between processes
+  must not be written by one of them, while others use it.
+
+  ## Example
+
+      iex> destination = Matrex.Mutable.zeros(2, 2)
+      iex> Matrex.Mutable.add!(destination, Matrex.new("1 2; 3 4"), Matrex.new("4 3; 2 1"))
+      iex> Matrex.Mutable.multiply!(destination, destination, Matrex.new("1 2; 3 4"))
+      iex> destination |> Matrex.Mutable.to_matrex() |> Matrex.to_list()
+      [5.0, 10.0, 15.0, 20.0]
+
+  """
+
+  alias Matrex.NIFs
+
+  @enforce_keys [:ref]
+  defstruct [:ref]
+  @type t :: %Matrex.Mutable{ref: reference}
+  @type operand :: t | Matrex.t()
+
+  @doc """
+  Creates mutable matrix with a copy of the given matrix data.
+  """
+  @spec new(Matrex.t()) :: t
+  def new(%Matrex{data: data}), do: %Matrex.Mutable{ref: NIFs.mutable_new(data)}
+
+  @doc """
+  Creates mutable matrix of the given size filled with zeros.
+  """
+  @spec zeros(Matrex.index(), Matrex.index()) :: t
+  def zeros(rows, cols) when is_integer(rows) and is_integer(cols),
+    do: new(Matrex.zeros(rows, cols))
+
+  @doc """
+  Copies current contents of mutable matrix into an immutable `Matrex`.
+  """
+  @spec to_matrex(t) :: Matrex.t()
+  def to_matrex(%Matrex.Mutable{ref: ref}), do: %Matrex{data: NIFs.mutable_to_binary(ref)}
+
+  @doc """
+  Returns size of mutable matrix as `{rows, columns}` tuple.
+  """
+  @spec size(t) :: {Matrex.index(), Matrex.index()}
+  def size(%Matrex.Mutable{ref: ref}), do: NIFs.mutable_size(ref)
+
+  @doc """
+  Writes `alpha * first + beta * second` into `destination`. NIF.
+
+  All three matrices must be of the same size. Destination may be one of the operands.
+  Raises `ErlangError` if matrices' sizes do not match.
+  """
+  @spec add!(t, operand, operand, number, number) :: t
+  def add!(%Matrex.Mutable{ref: ref} = destination, first, second, alpha \\ 1.0, beta \\ 1.0)
+      when is_number(alpha) and is_number(beta) do
+    :ok = NIFs.mutable_add(ref, data(first), data(second), alpha, beta)
+    destination
+  end
+
+  @doc """
+  Writes elementwise product of `first` and `second` into `destination`. NIF.
+
+  All three matrices must be of the same size. Destination may be one of the operands.
+  Raises `ErlangError` if matrices' sizes do not match.
+  """
+  @spec multiply!(t, operand, operand) :: t
+  def multiply!(%Matrex.Mutable{ref: ref} = destination, first, second) do
+    :ok = NIFs.mutable_multiply(ref, data(first), data(second))
+    destination
+  end
+
+  @doc """
+  Writes matrix product of `first` and `second`, multiplied by `alpha`, into `destination`. NIF.
+
+  Destination must be of the size of the product and must not be one of the operands.
+  Raises `ErlangError` otherwise.
+  """
+  @spec dot!(t, operand, operand, number) :: t
+  def dot!(%Matrex.Mutable{ref: ref} = destination, first, second, alpha \\ 1.0)
+      when is_number(alpha) do
+    :ok = NIFs.mutable_dot(ref, data(first), data(second), alpha)
+    destination
+  end
+
+  @doc """
+  Applies math function to each element of mutable matrix in place. NIF.
+
+  Accepts the same functions as `Matrex.apply/2` does, e.g. `:exp` or `:sigmoid`.
+  """
+  @spec apply!(t, atom) :: t
+  def apply!(%Matrex.Mutable{ref: ref} = destination, function) when is_atom(function) do
+    :ok = NIFs.mutable_apply(ref, ref, function)
+    destination
+  end
+
+  @doc """
+  Writes the result of math function, applied to each element of `matrix`, into `destination`. NIF.
+  """
+  @spec apply!(t, operand, atom) :: t
+  def apply!(%Matrex.Mutable{ref: ref} = destination, matrix, function) when is_atom(function) do
+    :ok = NIFs.mutable_apply(ref, data(matrix), function)
+    destination
+  end
+
+  @doc """
+  Transposes square mutable matrix in place. NIF.
+
+  Raises `ErlangError` if the matrix is not square.
+  """
+  @spec transpose!(t) :: t
+  def transpose!(%Matrex.Mutable{ref: ref} = destination) do
+    :ok = NIFs.mutable_transpose(ref, ref)
+    destination
+  end
+
+  @doc """
+  Writes transposition of `matrix` into `destination`. NIF.
+
+  Raises `ErlangError` if destination size is not the transposed size of the matrix.
+  """
+  @spec transpose!(t, operand) :: t
+  def transpose!(%Matrex.Mutable{ref: ref} = destination, matrix) do
+    :ok = NIFs.mutable_transpose(ref, data(matrix))
+    destination
+  end
+
+  defp data(%Matrex{data: data}), do: data
+  defp data(%Matrex.Mutable{ref: ref}), do: ref
+
+  defimpl Inspect do
+    @doc false
+    def inspect(%Matrex.Mutable{} = mutable, _opts) do
+      {rows, columns} = Matrex.Mutable.size(mutable)
+      "#Matrex.Mutable[#{rows}×#{columns}]"
+    end
+  end
+end
@@ -19,7 +19,14 @@ defmodule Matrex.NIFs do
           path
       end
 
-    case :erlang.load_nif(:filename.join(priv_dir, "matrix_nifs"), 0) do
+    load_info = %{
+      dirty_threshold: Application.get_env(:matrex, :dirty_threshold, 250_000),
+      workers: Application.get_env(:matrex, :workers, 0),
+      dot_workers: Application.get_env(:matrex, :dot_workers, 0),
+      simd: Application.get_env(:matrex, :simd, :auto)
+    }
+
+    case :erlang.load_nif(:filename.join(priv_dir, "matrix_nifs"), load_info) do
       :ok ->
         :ok
 
@@ -66,6 +73,11 @@ defmodule Matrex.NIFs do
   @spec argmax(binary) :: non_neg_integer
   def argmax(_matrix), do: :erlang.nif_error(:nif_library_not_loaded)
 
+  @spec chunk_to_list(binary, non_neg_integer, non_neg_integer) :: [float]
+  def chunk_to_list(matrix, offset, length)
+      when is_binary(matrix) and is_integer(offset) and is_integer(length),
+      do: :erlang.nif_error(:nif_library_not_loaded)
+
   @spec column_to_list(binary, non_neg_integer) :: [float]
   def column_to_list(
         <<
@@ -83,6 +95,27 @@ defmodule Matrex.NIFs do
     end)
   end
 
+  @spec csv_finish(reference) :: binary | {:error, String.t()}
+  def csv_finish(reader) when is_reference(reader),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec csv_read(reference, binary) :: :ok | {:error, String.t()}
+  def csv_read(reader, chunk) when is_reference(reader) and is_binary(chunk),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec csv_reader_new() :: reference
+  def csv_reader_new(), do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec csv_write(binary, non_neg_integer, non_neg_integer) :: binary
+  def csv_write(matrix, from_row, rows)
+      when is_binary(matrix) and is_integer(from_row) and is_integer(rows),
+      do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec concat([binary], :columns | :rows) :: binary
+  def concat(list, axis)
+      when is_list(list) and axis in [:columns, :rows],
+      do: :erlang.nif_error(:nif_library_not_loaded)
+
   @spec concat_columns(binary, binary) :: binary
   def concat_columns(first, second)
       when is_binary(first) and is_binary(second),
@@ -143,6 +176,11 @@ defmodule Matrex.NIFs do
       when is_binary(matrix) and is_binary(beta),
       do: :erlang.nif_error(:nif_library_not_loaded)
 
+  @spec eval_expression(list, [binary]) :: binary
+  def eval_expression(program, operands)
+      when is_list(program) and is_list(operands),
+      do: :erlang.nif_error(:nif_library_not_loaded)
+
   @spec eye(pos_integer, number) :: binary
   def eye(size, value)
       when is_integer(size) and is_number(value),
@@ -178,11 +216,21 @@ defmodule Matrex.NIFs do
   defp do_find(<<_elem::binary-4, rest::binary>>, <<value::binary-4>>, index, columns),
     do: do_find(rest, value, index + 1, columns)
 
+  @spec from_list(list, non_neg_integer, non_neg_integer) :: binary
+  def from_list(list, rows, columns)
+      when is_list(list) and is_integer(rows) and is_integer(columns),
+      do: :erlang.nif_error(:nif_library_not_loaded)
+
   @spec from_range(pos_integer, pos_integer, pos_integer, pos_integer) :: binary
   def from_range(from, to, rows, cols)
       when is_integer(from) and is_integer(to) and is_integer(rows) and is_integer(cols),
       do: :erlang.nif_error(:nif_library_not_loaded)
 
+  @spec idx_decode(binary, boolean, boolean) :: binary
+  def idx_decode(data, to_float, normalize)
+      when is_binary(data) and is_boolean(to_float) and is_boolean(normalize),
+      do: :erlang.nif_error(:nif_library_not_loaded)
+
   @spec max(binary) :: float
   def max(_matrix), do: :erlang.nif_error(:nif_library_not_loaded)
 
@@ -195,6 +243,10 @@ defmodule Matrex.NIFs do
   @spec min_finite(binary) :: float
   def min_finite(_matrix), do: :erlang.nif_error(:nif_library_not_loaded)
 
+  @spec mmap_file(binary, :read_only | :copy_on_write) :: binary | reference
+  def mmap_file(path, mode) when is_binary(path) and mode in [:read_only, :copy_on_write],
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
   @spec multiply(binary, binary) :: binary
   def multiply(first, second)
       when is_binary(first) and is_binary(second),
@@ -205,6 +257,48 @@ defmodule Matrex.NIFs do
       when is_binary(matrix) and is_number(scalar),
       do: :erlang.nif_error(:nif_library_not_loaded)
 
+  # Mutable matrix NIFs accept either binaries or mutable matrix references as operands.
+
+  @spec mutable_add(reference, binary | reference, binary | reference, number, number) :: :ok
+  def mutable_add(destination, _first, _second, alpha, beta)
+      when is_reference(destination) and is_number(alpha) and is_number(beta),
+      do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec mutable_apply(reference, binary | reference, atom) :: :ok
+  def mutable_apply(destination, _matrix, function)
+      when is_reference(destination) and is_atom(function),
+      do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec mutable_dot(reference, binary | reference, binary | reference, number) :: :ok
+  def mutable_dot(destination, _first, _second, alpha)
+      when is_reference(destination) and is_number(alpha),
+      do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec mutable_multiply(reference, binary | reference, binary | reference) :: :ok
+  def mutable_multiply(destination, _first, _second)
+      when is_reference(destination),
+      do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec mutable_new(binary) :: reference
+  def mutable_new(matrix) when is_binary(matrix), do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec mutable_size(reference) :: {non_neg_integer, non_neg_integer}
+  def mutable_size(matrix) when is_reference(matrix),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec mutable_to_binary(reference) :: binary
+  def mutable_to_binary(matrix) when is_reference(matrix),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec mutable_transpose(reference, binary | reference) :: :ok
+  def mutable_transpose(destination, _matrix) when is_reference(destination),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec mutable_write_list(reference, non_neg_integer, list) :: :ok
+  def mutable_write_list(matrix, offset, list)
+      when is_reference(matrix) and is_integer(offset) and is_list(list),
+      do: :erlang.nif_error(:nif_library_not_loaded)
+
   @spec neg(binary) :: binary
   def neg(
         <<
@@ -234,11 +328,19 @@ defmodule Matrex.NIFs do
     Matrex.apply(%Matrex{data: matrex}, fn x -> (x - mn) / range end).data
   end
 
-  @spec random(non_neg_integer, non_neg_integer) :: binary
-  def random(rows, cols)
-      when is_integer(rows) and is_integer(cols),
+  @spec random(non_neg_integer, non_neg_integer, tuple, non_neg_integer | nil) :: binary
+  def random(rows, cols, distribution, seed)
+      when is_integer(rows) and is_integer(cols) and is_tuple(distribution),
       do: :erlang.nif_error(:nif_library_not_loaded)
 
+  @spec reduce_columns(binary, :sum | :mean | :max | :min | :argmax) :: binary
+  def reduce_columns(matrix, reduction) when is_binary(matrix) and is_atom(reduction),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec reduce_rows(binary, :sum | :mean | :max | :min | :argmax) :: binary
+  def reduce_rows(matrix, reduction) when is_binary(matrix) and is_atom(reduction),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
   @spec resize(binary, number) :: binary
   def resize(matrex, scale) when is_binary(matrex) and is_number(scale),
     do: :erlang.nif_error(:nif_library_not_loaded)
@@ -278,6 +380,18 @@ defmodule Matrex.NIFs do
       binary_part(data, (pos + 1) * 4, (rows * cols - pos - 1) * 4)::binary>>
   end
 
+  @spec set_dirty_threshold(non_neg_integer) :: :ok
+  def set_dirty_threshold(threshold) when is_integer(threshold) and threshold >= 0,
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec set_dot_workers(non_neg_integer) :: :ok
+  def set_dot_workers(workers) when is_integer(workers) and workers >= 0,
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec set_simd(:auto | :generic | :sse2 | :avx2 | :avx512) :: :ok | :unsupported
+  def set_simd(isa) when is_atom(isa),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
   @spec set_column(binary, non_neg_integer, binary) :: binary
   def set_column(matrex, column, column_matrex)
       when is_binary(matrex) and is_integer(column) and is_binary(column_matrex),
@@ -289,6 +403,19 @@ defmodule Matrex.NIFs do
              is_integer(col_from) and is_integer(col_to),
       do: :erlang.nif_error(:nif_library_not_loaded)
 
+  @spec stream_finish(reference) :: binary
+  def stream_finish(stream) when is_reference(stream),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec stream_new(:mtx | :idx, boolean, boolean) :: reference
+  def stream_new(format, to_float, normalize)
+      when format in [:mtx, :idx] and is_boolean(to_float) and is_boolean(normalize),
+      do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec stream_write(reference, binary) :: :ok
+  def stream_write(stream, chunk) when is_reference(stream) and is_binary(chunk),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
   @spec subtract(binary, binary) :: binary
   def subtract(first, second)
       when is_binary(first) and is_binary(second),
@@ -318,6 +445,9 @@ defmodule Matrex.NIFs do
   @spec sum(binary) :: float
   def sum(_matrix), do: :erlang.nif_error(:nif_library_not_loaded)
 
+  @spec sum(binary, :pairwise | :kahan) :: float
+  def sum(_matrix, mode) when is_atom(mode), do: :erlang.nif_error(:nif_library_not_loaded)
+
   @spec to_list(binary) :: list(float)
   def to_list(matrix) when is_binary(matrix), do: :erlang.nif_error(:nif_library_not_loaded)
 
@@ -328,6 +458,83 @@ defmodule Matrex.NIFs do
   @spec transpose(binary) :: binary
   def transpose(matrix) when is_binary(matrix), do: :erlang.nif_error(:nif_library_not_loaded)
 
+  @spec typed_apply(binary, atom) :: binary
+  def typed_apply(matrix, function) when is_binary(matrix) and is_atom(function),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec typed_cholesky(binary) :: binary
+  def typed_cholesky(matrix) when is_binary(matrix),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec typed_convert(binary, atom) :: binary
+  def typed_convert(matrix, type) when is_binary(matrix) and is_atom(type),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec typed_dot(binary, binary, number) :: binary
+  def typed_dot(first, second, alpha)
+      when is_binary(first) and is_binary(second) and is_number(alpha),
+      do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec typed_eye(non_neg_integer, atom, number) :: binary
+  def typed_eye(size, type, value) when is_integer(size) and is_atom(type) and is_number(value),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec typed_forward_substitute(binary, binary) :: binary
+  def typed_forward_substitute(matrix, beta) when is_binary(matrix) and is_binary(beta),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec typed_from_matrex(binary, atom) :: binary
+  def typed_from_matrex(matrix, type) when is_binary(matrix) and is_atom(type),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec typed_new(non_neg_integer, non_neg_integer, atom, number) :: binary
+  def typed_new(rows, cols, type, value)
+      when is_integer(rows) and is_integer(cols) and is_atom(type) and is_number(value),
+      do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec typed_operate(binary | number, binary | number, atom) :: binary
+  def typed_operate(_first, _second, operation) when is_atom(operation),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec typed_quantized_dot(binary, binary, binary | number | nil, binary | number | nil) ::
+          binary
+  def typed_quantized_dot(first, second, _first_scales, _second_scales)
+      when is_binary(first) and is_binary(second),
+      do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec typed_reduce(binary, atom) :: number | :nan | :inf | :neg_inf
+  def typed_reduce(matrix, reduction) when is_binary(matrix) and is_atom(reduction),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec typed_to_list(binary) :: list(number | :nan | :inf | :neg_inf)
+  def typed_to_list(matrix) when is_binary(matrix),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec typed_to_matrex(binary) :: binary
+  def typed_to_matrex(matrix) when is_binary(matrix),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec typed_transpose(binary) :: binary
+  def typed_transpose(matrix) when is_binary(matrix),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  # View NIFs accept either whole matrix binaries or {matrix, offset, rows, columns, stride} tuples.
+  @type view :: binary | {binary, non_neg_integer, pos_integer, pos_integer, pos_integer}
+
+  @spec view_add(view, view, number, number) :: binary
+  def view_add(_first, _second, alpha, beta) when is_number(alpha) and is_number(beta),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec view_dot(view, view, number) :: binary
+  def view_dot(_first, _second, alpha) when is_number(alpha),
+    do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec view_sum(view) :: number | :nan | :inf | :neg_inf
+  def view_sum(_view), do: :erlang.nif_error(:nif_library_not_loaded)
+
+  @spec view_to_binary(view) :: binary
+  def view_to_binary(_view), do: :erlang.nif_error(:nif_library_not_loaded)
+
   @spec zeros(integer, integer) :: binary
   def zeros(rows, cols) when is_integer(rows) and is_integer(cols) do
     :erlang.nif_error(:nif_library_not_loaded)
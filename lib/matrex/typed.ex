@@ -0,0 +1,327 @@
+defmodule Matrex.Typed do
+  @moduledoc """
+  Matrix of elements of the given type: `:float32`, `:float64`, `:float16`, `:bfloat16`,
+  `:int8`, `:uint8` or `:int32`.
+
+  `Matrex` stores single precision floats. Numerically sensitive computations,
+  like Cholesky decomposition of ill-conditioned matrices, may need double precision,
+  which `:float64` typed matrices provide. All element types share the same native kernels,
+  generated from one source for each of them.
+
+  `:float16` (IEEE 754 half precision) and `:bfloat16` (upper half of single precision float)
+  elements take half the memory of `Matrex` ones. Kernels widen them to float a block at a time,
+  compute in single precision and round the results to nearest even.
+
+  Integer elements are computed exactly in float or double precision, the results are rounded
+  and saturated to the range of the type. Quantized models and raw datasets, e.g. MNIST images,
+  loaded with `Matrex.load/1` from `.idx` files, stay compact. `quantized_dot/3` multiplies
+  `:int8` matrices with integer SIMD instructions.
+
+  Element type is kept in the header of matrix binary, so typed matrices can be saved to
+  and loaded from `.mtx` files with `save/2` and `Matrex.load/1`.
+
+  ## Example
+
+      iex> Matrex.new([[100_000_001]]) |> Matrex.to_list()
+      [1.0e8]
+      iex> Matrex.Typed.new([[100_000_001]], :float64) |> Matrex.Typed.to_list()
+      [100000001.0]
+      iex> Matrex.Typed.new([[4, 2], [2, 3]]) |> Matrex.Typed.cholesky() |> Matrex.Typed.to_list()
+      [2.0, 0.0, 1.0, 1.4142135623730951]
+      iex> Matrex.Typed.new([[0.1, 1000]], :float16) |> Matrex.Typed.to_list()
+      [0.0999755859375, 1000.0]
+      iex> Matrex.Typed.new([[0.1, 1000]], :bfloat16) |> Matrex.Typed.to_list()
+      [0.10009765625, 1000.0]
+
+  """
+
+  alias Matrex.NIFs
+
+  @enforce_keys [:data]
+  defstruct [:data]
+
+  # In the order of native type codes.
+  @types [:float32, :float64, :float16, :bfloat16, :int8, :uint8, :int32]
+
+  @type type :: :float32 | :float64 | :float16 | :bfloat16 | :int8 | :uint8 | :int32
+  @type t :: %Matrex.Typed{data: binary}
+  @type operand :: t | number
+
+  @doc """
+  Creates typed matrix from list of lists of numbers or from `Matrex`, converting its elements.
+
+  Lists may contain `:nan`, `:inf` and `:neg_inf` atoms, as in `Matrex.new/1`.
+  """
+  @spec new([[Matrex.element()]] | Matrex.t(), type) :: t
+  def new(matrix, type \\ :float64)
+
+  def new(%Matrex{data: data}, type) when type in @types,
+    do: %Matrex.Typed{data: NIFs.typed_from_matrex(data, type)}
+
+  def new([first_row | _] = list_of_lists, type) when is_list(first_row) and type in @types do
+    rows = length(list_of_lists)
+    columns = length(first_row)
+
+    data =
+      Enum.reduce(list_of_lists, header(rows, columns, :float64), fn row, data ->
+        Enum.reduce(row, data, &<<&2::binary, element_to_binary(&1)::binary>>)
+      end)
+
+    convert(%Matrex.Typed{data: data}, type)
+  end
+
+  @doc """
+  Creates typed matrix of the given size, filled with the value.
+  """
+  @spec fill(Matrex.index(), Matrex.index(), number, type) :: t
+  def fill(rows, columns, value, type \\ :float64)
+      when is_integer(rows) and is_integer(columns) and is_number(value) and type in @types,
+      do: %Matrex.Typed{data: NIFs.typed_new(rows, columns, type, value)}
+
+  @doc """
+  Creates typed matrix of the given size, filled with zeros.
+  """
+  @spec zeros(Matrex.index(), Matrex.index(), type) :: t
+  def zeros(rows, columns, type \\ :float64), do: fill(rows, columns, 0, type)
+
+  @doc """
+  Creates typed matrix of the given size, filled with ones.
+  """
+  @spec ones(Matrex.index(), Matrex.index(), type) :: t
+  def ones(rows, columns, type \\ :float64), do: fill(rows, columns, 1, type)
+
+  @doc """
+  Creates typed identity matrix of the given size.
+  """
+  @spec eye(Matrex.index(), type) :: t
+  def eye(size, type \\ :float64) when is_integer(size) and type in @types,
+    do: %Matrex.Typed{data: NIFs.typed_eye(size, type, 1)}
+
+  @doc """
+  Converts elements to the given type. NIF.
+  """
+  @spec convert(t, type) :: t
+  def convert(%Matrex.Typed{data: data}, type) when type in @types,
+    do: %Matrex.Typed{data: NIFs.typed_convert(data, type)}
+
+  @doc """
+  Converts elements to single precision `Matrex`. NIF.
+  """
+  @spec to_matrex(t) :: Matrex.t()
+  def to_matrex(%Matrex.Typed{data: data}), do: %Matrex{data: NIFs.typed_to_matrex(data)}
+
+  @doc """
+  Returns element type of typed matrix.
+  """
+  @spec type(t) :: type
+  def type(%Matrex.Typed{data: <<_size::binary-8, code::unsigned-integer-little-32, _::binary>>}),
+    do: Enum.at(@types, code)
+
+  @doc """
+  Returns size of typed matrix as `{rows, columns}` tuple.
+  """
+  @spec size(t) :: {Matrex.index(), Matrex.index()}
+  def size(%Matrex.Typed{
+        data:
+          <<rows::unsigned-integer-little-32, columns::unsigned-integer-little-32, _::binary>>
+      }),
+      do: {rows, columns}
+
+  @doc """
+  Returns all elements as a flat list of floats. NIF.
+  """
+  @spec to_list(t) :: [Matrex.element()]
+  def to_list(%Matrex.Typed{data: data}), do: NIFs.typed_to_list(data)
+
+  @doc """
+  Returns list of lists of matrix rows.
+  """
+  @spec to_list_of_lists(t) :: [[Matrex.element()]]
+  def to_list_of_lists(%Matrex.Typed{} = matrix) do
+    {_rows, columns} = size(matrix)
+    matrix |> to_list() |> Enum.chunk_every(columns)
+  end
+
+  @doc """
+  Elementwise sum of two typed matrices of the same type and size or of a matrix and a scalar.
+  NIF.
+
+  Raises `ErlangError`, if types or sizes of matrices do not match.
+  """
+  @spec add(operand, operand) :: t
+  def add(first, second), do: operate(first, second, :add)
+
+  @doc """
+  Elementwise difference of two typed matrices or of a matrix and a scalar. NIF.
+  """
+  @spec subtract(operand, operand) :: t
+  def subtract(first, second), do: operate(first, second, :subtract)
+
+  @doc """
+  Elementwise product of two typed matrices or of a matrix and a scalar. NIF.
+  """
+  @spec multiply(operand, operand) :: t
+  def multiply(first, second), do: operate(first, second, :multiply)
+
+  @doc """
+  Elementwise division of two typed matrices or of a matrix and a scalar. NIF.
+  """
+  @spec divide(operand, operand) :: t
+  def divide(first, second), do: operate(first, second, :divide)
+
+  @doc """
+  Matrix product of two typed matrices of the same type, multiplied by `alpha`.
+  NIF, via `cblas_sgemm()` or `cblas_dgemm()`.
+  """
+  @spec dot(t, t, number) :: t
+  def dot(%Matrex.Typed{data: first}, %Matrex.Typed{data: second}, alpha \\ 1.0)
+      when is_number(alpha),
+      do: %Matrex.Typed{data: NIFs.typed_dot(first, second, alpha)}
+
+  @doc """
+  Product of `:int8` matrices with exact `:int32` sums. NIF.
+
+  With `scales: {first_scales, second_scales}` option the sums are dequantized into `:float32`
+  matrix: each of them is multiplied by the scale of its row of the first matrix and by the scale
+  of its column of the second one. Scales are either numbers, one for the whole matrix,
+  or `Matrex` vectors with a scale for each row or column.
+
+  Sums don't overflow for inner dimension up to 131071, larger one raises `ArgumentError`.
+
+  ## Example
+
+      iex> a = Matrex.Typed.new([[1, -2], [3, 4]], :int8)
+      iex> b = Matrex.Typed.new([[100, 0], [50, -1]], :int8)
+      iex> a |> Matrex.Typed.quantized_dot(b) |> Matrex.Typed.to_list()
+      [0, 2, 500, -4]
+      iex> scales = {0.5, Matrex.new([[1, 10]])}
+      iex> a |> Matrex.Typed.quantized_dot(b, scales: scales) |> Matrex.Typed.to_list()
+      [0.0, 10.0, 250.0, -20.0]
+
+  """
+  @spec quantized_dot(t, t, keyword) :: t
+  def quantized_dot(%Matrex.Typed{data: first}, %Matrex.Typed{data: second}, options \\ []) do
+    case Keyword.get(options, :scales) do
+      nil ->
+        %Matrex.Typed{data: NIFs.typed_quantized_dot(first, second, nil, nil)}
+
+      {first_scales, second_scales} ->
+        %Matrex.Typed{
+          data:
+            NIFs.typed_quantized_dot(first, second, scales(first_scales), scales(second_scales))
+        }
+    end
+  end
+
+  @doc """
+  Transposes typed matrix. NIF.
+  """
+  @spec transpose(t) :: t
+  def transpose(%Matrex.Typed{data: data}), do: %Matrex.Typed{data: NIFs.typed_transpose(data)}
+
+  @doc """
+  Applies math function, one of those `Matrex.apply/2` accepts as atoms, to each element. NIF.
+  """
+  @spec apply(t, atom) :: t
+  def apply(%Matrex.Typed{data: data}, function) when is_atom(function),
+    do: %Matrex.Typed{data: NIFs.typed_apply(data, function)}
+
+  @doc """
+  Sums all elements in double precision. NIF.
+
+  Sums, maximums and minimums of integer matrices and their elements in `to_list/1` are integers.
+  """
+  @spec sum(t) :: Matrex.element()
+  def sum(%Matrex.Typed{data: data}), do: NIFs.typed_reduce(data, :sum)
+
+  @doc """
+  Returns maximum element. NIF.
+  """
+  @spec max(t) :: Matrex.element()
+  def max(%Matrex.Typed{data: data}), do: NIFs.typed_reduce(data, :max)
+
+  @doc """
+  Returns minimum element. NIF.
+  """
+  @spec min(t) :: Matrex.element()
+  def min(%Matrex.Typed{data: data}), do: NIFs.typed_reduce(data, :min)
+
+  @doc """
+  Cholesky decomposition of symmetric positive definite matrix. NIF. See `Matrex.cholesky/1`.
+  """
+  @spec cholesky(t) :: t
+  def cholesky(%Matrex.Typed{data: data}), do: %Matrex.Typed{data: NIFs.typed_cholesky(data)}
+
+  @doc """
+  Solves `L x = b` for lower triangular `L` by forward substitution. NIF.
+  See `Matrex.forward_substitute/2`.
+  """
+  @spec forward_substitute(t, t) :: t
+  def forward_substitute(%Matrex.Typed{data: matrix}, %Matrex.Typed{data: beta}),
+    do: %Matrex.Typed{data: NIFs.typed_forward_substitute(matrix, beta)}
+
+  @doc """
+  Saves typed matrix into binary `.mtx` file, which `Matrex.load/1` reads back.
+  """
+  @spec save(t, binary) :: :ok
+  def save(%Matrex.Typed{data: data}, file_name) when is_binary(file_name) do
+    if :filename.extension(file_name) == ".mtx",
+      do: File.write!(file_name, data),
+      else: raise("Unknown file format: #{file_name}")
+  end
+
+  @doc false
+  # Tells typed matrix binary from the float one by its header.
+  @spec typed?(binary) :: boolean
+  def typed?(
+        <<rows::unsigned-integer-little-32, columns::unsigned-integer-little-32,
+          code::unsigned-integer-little-32, "MTXT", body::binary>>
+      )
+      when code < length(@types),
+      do: byte_size(body) == rows * columns * element_size(Enum.at(@types, code))
+
+  def typed?(_data), do: false
+
+  @doc false
+  # Header of typed matrix binary, which elements follow.
+  @spec header(Matrex.index(), Matrex.index(), type) :: binary
+  def header(rows, columns, type) do
+    code = Enum.find_index(@types, &(&1 == type))
+
+    <<rows::unsigned-integer-little-32, columns::unsigned-integer-little-32,
+      code::unsigned-integer-little-32, "MTXT">>
+  end
+
+  defp operate(%Matrex.Typed{data: first}, %Matrex.Typed{data: second}, operation),
+    do: %Matrex.Typed{data: NIFs.typed_operate(first, second, operation)}
+
+  defp operate(%Matrex.Typed{data: first}, second, operation) when is_number(second),
+    do: %Matrex.Typed{data: NIFs.typed_operate(first, second, operation)}
+
+  defp operate(first, %Matrex.Typed{data: second}, operation) when is_number(first),
+    do: %Matrex.Typed{data: NIFs.typed_operate(first, second, operation)}
+
+  defp element_size(:float32), do: 4
+  defp element_size(:float64), do: 8
+  defp element_size(:float16), do: 2
+  defp element_size(:bfloat16), do: 2
+  defp element_size(:int8), do: 1
+  defp element_size(:uint8), do: 1
+  defp element_size(:int32), do: 4
+
+  defp scales(scale) when is_number(scale), do: scale
+  defp scales(%Matrex{data: data}), do: data
+
+  defp element_to_binary(number) when is_number(number), do: <<number::float-little-64>>
+  defp element_to_binary(:nan), do: <<0, 0, 0, 0, 0, 0, 0xF8, 0x7F>>
+  defp element_to_binary(:inf), do: <<0, 0, 0, 0, 0, 0, 0xF0, 0x7F>>
+  defp element_to_binary(:neg_inf), do: <<0, 0, 0, 0, 0, 0, 0xF0, 0xFF>>
+
+  defimpl Inspect do
+    @doc false
+    def inspect(%Matrex.Typed{} = matrix, _opts) do
+      {rows, columns} = Matrex.Typed.size(matrix)
+      "#Matrex.Typed<#{Matrex.Typed.type(matrix)}>[#{rows}×#{columns}]"
+    end
+  end
+end
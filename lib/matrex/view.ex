@@ -0,0 +1,152 @@
+defmodule Matrex.View do
+  @moduledoc """
+  Rectangular part of a matrix, which refers to the matrix data instead of copying it.
+
+  Taking a view costs the same regardless of its size, so it's the cheap way to slice
+  mini-batches out of a large training set. `dot/3`, `add/4` and `sum/1` work on views directly,
+  `to_matrex/1` copies view contents into a new matrix.
+
+  A view keeps the whole matrix it refers to in memory.
+
+  ## Example
+
+      iex> m = Matrex.new("1 2 3; 4 5 6; 7 8 9")
+      iex> batch = Matrex.View.rows(m, 2..3)
+      iex> Matrex.View.sum(batch)
+      39.0
+      iex> Matrex.View.dot(batch, Matrex.View.column(m, 1)) |> Matrex.to_list()
+      [66.0, 102.0]
+
+  """
+
+  alias Matrex.NIFs
+
+  @enforce_keys [:matrix, :offset, :rows, :columns, :stride]
+  defstruct [:matrix, :offset, :rows, :columns, :stride]
+
+  @type t :: %Matrex.View{
+          matrix: binary,
+          offset: non_neg_integer,
+          rows: pos_integer,
+          columns: pos_integer,
+          stride: pos_integer
+        }
+  @type operand :: t | Matrex.t()
+
+  @doc """
+  View of the whole matrix.
+  """
+  @spec new(operand) :: t
+  def new(
+        %Matrex{
+          data:
+            <<rows::unsigned-integer-little-32, columns::unsigned-integer-little-32,
+              _rest::binary>> = data
+        }
+      ),
+      do: %Matrex.View{matrix: data, offset: 0, rows: rows, columns: columns, stride: columns}
+
+  def new(%Matrex.View{} = view), do: view
+
+  @doc """
+  View of the part of matrix or view, given by one-based ranges of rows and columns.
+  """
+  @spec submatrix(operand, Range.t(), Range.t()) :: t
+  def submatrix(%Matrex{} = matrex, rows, cols), do: matrex |> new() |> submatrix(rows, cols)
+
+  def submatrix(
+        %Matrex.View{rows: rows, columns: cols, offset: offset, stride: stride} = view,
+        row_from..row_to,
+        col_from..col_to
+      )
+      when row_from in 1..rows and row_to in row_from..rows and col_from in 1..cols and
+             col_to in col_from..cols,
+      do: %Matrex.View{
+        view
+        | offset: offset + (row_from - 1) * stride + col_from - 1,
+          rows: row_to - row_from + 1,
+          columns: col_to - col_from + 1
+      }
+
+  def submatrix(%Matrex.View{rows: rows, columns: cols}, row_range, col_range) do
+    raise(
+      RuntimeError,
+      "View position out of range or malformed: position is " <>
+        "(#{Kernel.inspect(row_range)}, #{Kernel.inspect(col_range)}), source size is " <>
+        "(#{Kernel.inspect(1..rows)}, #{Kernel.inspect(1..cols)})"
+    )
+  end
+
+  @doc """
+  View of the range of rows, e.g. a mini-batch of a training set.
+  """
+  @spec rows(operand, Range.t()) :: t
+  def rows(matrix, row_range) do
+    %Matrex.View{columns: cols} = view = new(matrix)
+    submatrix(view, row_range, 1..cols)
+  end
+
+  @doc """
+  View of one row as a 1-row matrix.
+  """
+  @spec row(operand, Matrex.index()) :: t
+  def row(matrix, row) when is_integer(row), do: rows(matrix, row..row)
+
+  @doc """
+  View of one column as a 1-column matrix.
+  """
+  @spec column(operand, Matrex.index()) :: t
+  def column(matrix, col) when is_integer(col) do
+    %Matrex.View{rows: rows} = view = new(matrix)
+    submatrix(view, 1..rows, col..col)
+  end
+
+  @doc """
+  Returns size of view as `{rows, columns}` tuple.
+  """
+  @spec size(t) :: {Matrex.index(), Matrex.index()}
+  def size(%Matrex.View{rows: rows, columns: cols}), do: {rows, cols}
+
+  @doc """
+  Copies view contents into a new matrix. NIF.
+  """
+  @spec to_matrex(operand) :: Matrex.t()
+  def to_matrex(%Matrex{} = matrex), do: matrex
+  def to_matrex(%Matrex.View{} = view), do: %Matrex{data: NIFs.view_to_binary(term(view))}
+
+  @doc """
+  Sum of all elements of matrix or view. NIF.
+  """
+  @spec sum(operand) :: Matrex.element()
+  def sum(matrix), do: NIFs.view_sum(term(matrix))
+
+  @doc """
+  Adds two matrices or views, optionally scaling them: C = αA + βB. NIF.
+
+  Raises `ErlangError` if sizes do not match.
+  """
+  @spec add(operand, operand, number, number) :: Matrex.t()
+  def add(first, second, alpha \\ 1.0, beta \\ 1.0) when is_number(alpha) and is_number(beta),
+    do: %Matrex{data: NIFs.view_add(term(first), term(second), alpha, beta)}
+
+  @doc """
+  Matrix product of two matrices or views, multiplied by `alpha`. NIF.
+
+  Raises `ErlangError` if sizes do not match.
+  """
+  @spec dot(operand, operand, number) :: Matrex.t()
+  def dot(first, second, alpha \\ 1.0) when is_number(alpha),
+    do: %Matrex{data: NIFs.view_dot(term(first), term(second), alpha)}
+
+  # NIFs take whole matrices as binaries and views as tuples.
+  defp term(%Matrex{data: data}), do: data
+
+  defp term(%Matrex.View{matrix: matrix, offset: offset, rows: rows, columns: cols, stride: stride}),
+    do: {matrix, offset, rows, cols, stride}
+
+  defimpl Inspect do
+    @doc false
+    def inspect(%Matrex.View{rows: rows, columns: columns}, _opts),
+      do: "#Matrex.View[#{rows}×#{columns}]"
+  end
+end
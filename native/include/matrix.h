@@ -38,6 +38,19 @@ matrix_new(uint32_t rows, uint32_t columns);
 int32_t
 matrix_equal(Matrix first, Matrix second);
 
+// Elementwise operations accept matrices of different sizes, if each of their dimensions is either
+// equal or 1. Operand of size 1 in a dimension is repeated along it without being copied, e.g. a 1×n row
+// is added to each row of an m×n matrix. Repeating an empty dimension gives an empty result, e.g. 0×n matrix
+// with 1×n row is 0×n. Rows of the result are computed in strips of BROADCAST_STRIP elements.
+#define BROADCAST_STRIP 1024
+
+int
+matrix_broadcastable(const Matrix first, const Matrix second);
+
+// Length of the result of elementwise operation on broadcastable matrices, header included.
+uint64_t
+matrix_broadcast_length(const Matrix first, const Matrix second);
+
 void
 matrix_add(const Matrix first, const Matrix second, const float alpha, const float beta, Matrix result);
 
@@ -47,16 +60,32 @@ matrix_add_scalar(const Matrix first, const float scalar, Matrix result);
 int
 matrix_apply(const Matrix matrix, char* function_name, Matrix result);
 
+// Minimum number of elements per thread pool chunk in matrix_apply_parallel().
+#define APPLY_PARALLEL_GRAIN 16384
+
+int
+matrix_apply_parallel(const Matrix matrix, char* function_name, Matrix result);
+
 typedef float (*math_func_ptr_t)(float);
 
 math_func_ptr_t math_func_from_name(const char* name);
 
+// Reductions split data into blocks of at least REDUCE_BLOCK elements, at most REDUCE_MAX_BLOCKS of them,
+// which are reduced by thread pool workers.
+#define REDUCE_BLOCK 16384
+#define REDUCE_MAX_BLOCKS 1024
+
 int32_t
 matrix_argmax(const Matrix matrix);
 
 void
 matrix_concat_columns(const Matrix first, const Matrix second, Matrix result);
 
+// Concatenates `count` matrices along rows, when `along_rows` is non-zero, or along columns.
+// Sizes must already fit: the same number of columns along rows, of rows along columns.
+void
+matrix_concat(const Matrix *matrices, const uint32_t count, const int along_rows, Matrix result);
+
 void
 matrix_pow(const float scalar, const Matrix matrex, Matrix result);
 
@@ -120,8 +149,19 @@ matrix_neg(const Matrix matrix, Matrix result);
 void
 matrix_normalize(const Matrix matrix, Matrix result);
 
-void
-matrix_random(Matrix matrix);
+// Axis reductions: "sum", "mean", "max", "min" and "argmax" (one-based). Columns are reduced
+// in strips of AXIS_STRIP columns, accumulated row by row, so the matrix is read in memory order.
+// Rows or strips are split between thread pool workers in chunks of at least AXIS_PARALLEL_GRAIN elements.
+#define AXIS_STRIP 256
+#define AXIS_PARALLEL_GRAIN 65536
+
+// Reduces each row, writing results into rows×1 column.
+int
+matrix_reduce_rows(const Matrix matrix, const char* reduction_name, Matrix result);
+
+// Reduces each column, writing results into 1×columns row.
+int
+matrix_reduce_columns(const Matrix matrix, const char* reduction_name, Matrix result);
 
 void
 matrix_resize(const Matrix matrix, const int32_t new_rows, const int32_t new_cols, Matrix result);
@@ -145,9 +185,21 @@ matrix_subtract_from_scalar(const float scalar, const Matrix matrix, Matrix resu
 double
 matrix_sum(const Matrix matrix);
 
+double
+matrix_sum_kahan(const Matrix matrix);
+
+// Matrices are transposed in tiles of TRANSPOSE_TILE × TRANSPOSE_TILE elements,
+// split between thread pool workers in chunks of at least TRANSPOSE_PARALLEL_GRAIN elements.
+#define TRANSPOSE_TILE 64
+#define TRANSPOSE_PARALLEL_GRAIN 65536
+
 void
 matrix_transpose(const Matrix matrix, Matrix result);
 
+// Transposes square matrix in place.
+void
+matrix_transpose_in_place(Matrix matrix);
+
 void
 matrix_zeros(Matrix matrix);
 
@@ -0,0 +1,69 @@
+#ifndef INCLUDED_MATRIX_CSV_H
+#define INCLUDED_MATRIX_CSV_H
+
+#include <stdint.h>
+
+#include "matrix.h"
+
+// Longest element text, which reader accepts, and the longest one, which writer writes,
+// e.g. "-1.17549435e-38", the separator after it included.
+#define CSV_TOKEN_MAX 128
+#define CSV_ELEMENT_MAX 16
+
+typedef enum {
+  CSV_OK,
+  CSV_INVALID_ELEMENT,
+  CSV_RAGGED_ROWS,
+  CSV_TOO_LARGE,
+  CSV_OUT_OF_MEMORY,
+  CSV_EMPTY
+} csv_error_t;
+
+// Streaming reader of matrix text: rows are separated by newlines or semicolons,
+// elements by commas or whitespace, empty rows and elements are skipped, as Matrex.new/1 did.
+// Text may be fed in chunks of any size, an element split between chunks included.
+typedef struct {
+  float       *values;          // matrix being read, header included
+  uint64_t     capacity;        // in floats
+  uint64_t     length;          // in floats, header included
+  uint32_t     rows;
+  uint32_t     cols;
+  uint32_t     row_cols;        // elements of the current row read so far
+  uint32_t     token_length;    // length of the element, which continues in the next chunk
+  char         token[CSV_TOKEN_MAX + 1];
+  csv_error_t  error;
+} CsvReader;
+
+void
+matrix_csv_reader_init(CsvReader *reader);
+
+// Reads the next chunk of text. Returns 0 and sets reader->error, when it's malformed.
+// Then reader->token holds the invalid element.
+int
+matrix_csv_read(CsvReader *reader, const char *text, const uint64_t size);
+
+// Reads the element left from the last chunk and returns the matrix, which stays owned by the reader,
+// or NULL, setting reader->error, if there was an error or no elements.
+Matrix
+matrix_csv_finish(CsvReader *reader);
+
+void
+matrix_csv_reader_free(CsvReader *reader);
+
+// Parses element text: a decimal number or NaN, Inf, +Inf, -Inf, NegInf, rounding it
+// to double and then to float, as Float.parse/1 followed by conversion to float32 does.
+// Returns 0, if it's not a number.
+int
+matrix_csv_parse_float(const char *text, const uint32_t length, float *value);
+
+// Writes the shortest text, which parses back into the same float, e.g. "0.1" for 0.1f, into `out`
+// with room for CSV_ELEMENT_MAX characters. Returns its length, which is less than that.
+uint32_t
+matrix_csv_format_float(const float value, char *out);
+
+// Writes `rows` rows starting from `from_row` as comma separated lines into `out`, which must have room
+// for rows*(cols*CSV_ELEMENT_MAX + 1) characters. Returns the number of characters written.
+uint64_t
+matrix_csv_write(const Matrix matrix, const uint32_t from_row, const uint32_t rows, char *out);
+
+#endif
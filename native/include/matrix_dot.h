@@ -3,23 +3,24 @@
 
 #include "matrix.h"
 
-void
+// Matrix products, which return 0, when out of memory.
+int
 matrix_dot(const float alpha, const Matrix first, const Matrix second, Matrix result);
 
-void
+int
 matrix_dot_and_add(
   const float alpha, const Matrix first, const Matrix second, const Matrix third, Matrix result
 );
 
-void
+int
 matrix_dot_and_apply(
   const float alpha, const Matrix first, const Matrix second, const char *function_name, Matrix result
 );
 
-void
+int
 matrix_dot_nt(const float alpha, const Matrix first, const Matrix second, Matrix result);
 
-void
+int
 matrix_dot_tn(const float alpha, const Matrix first, const Matrix second, Matrix result);
 
 #endif
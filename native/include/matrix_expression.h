@@ -0,0 +1,47 @@
+#ifndef INCLUDED_MATRIX_EXPRESSION_H
+#define INCLUDED_MATRIX_EXPRESSION_H
+
+#include <stdint.h>
+
+#include "matrix.h"
+#include "matrix_simd.h"
+
+// Elementwise expressions are evaluated in blocks of EXPRESSION_BLOCK elements, small enough for
+// the intermediate results of all instructions to stay in L1 cache. So operands are read and the result
+// is written once, however long the expression is. Blocks are split between thread pool workers
+// in chunks of at least EXPRESSION_PARALLEL_GRAIN elements.
+#define EXPRESSION_BLOCK 256
+#define EXPRESSION_PARALLEL_GRAIN 16384
+
+// Limits of the program length and of the depth of its value stack.
+#define EXPRESSION_MAX_LENGTH 256
+#define EXPRESSION_MAX_DEPTH 16
+
+typedef enum {
+  EXPRESSION_LOAD,      // pushes operand matrix
+  EXPRESSION_SCALAR,    // pushes scalar
+  EXPRESSION_ADD,       // pops two values, pushes result
+  EXPRESSION_SUBTRACT,
+  EXPRESSION_MULTIPLY,
+  EXPRESSION_DIVIDE,
+  EXPRESSION_NEG,       // replaces the top value with result
+  EXPRESSION_APPLY
+} expression_opcode_t;
+
+typedef struct {
+  expression_opcode_t opcode;
+  uint32_t            operand;    // operand index for EXPRESSION_LOAD
+  float               scalar;     // value for EXPRESSION_SCALAR
+  math_func_ptr_t     func;       // function for EXPRESSION_APPLY
+  simd_unary_t        simd_func;  // and its vectorized version or NULL
+} expression_instruction_t;
+
+// Evaluates program in postfix form over operands of the same size and writes the result,
+// which must be a matrix value, into `result`. Returns 0, if the program is malformed.
+int
+matrix_expression_eval(
+  const expression_instruction_t *program, const uint32_t length,
+  const Matrix *operands, const uint32_t operands_count, Matrix result
+);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef INCLUDED_MATRIX_GEMM_H
+#define INCLUDED_MATRIX_GEMM_H
+
+#include <stdint.h>
+
+// Built-in replacement for cblas_sgemm() with beta = 0, used when Matrex is built without BLAS.
+// Computes result = alpha * op(first) * op(second), where op() optionally transposes its argument.
+// Strides are lengths of the rows of the matrices, as they are stored in memory.
+// Returns 0, when packing buffers can't be allocated.
+int
+matrix_gemm(
+  const int transpose_first, const int transpose_second,
+  const uint64_t rows, const uint64_t cols, const uint64_t inner,
+  const float alpha,
+  const float *first, const uint64_t first_stride,
+  const float *second, const uint64_t second_stride,
+  float *result, const uint64_t result_stride
+);
+
+void
+matrix_gemm_set_max_workers(const uint32_t workers);
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef INCLUDED_MATRIX_IDX_H
+#define INCLUDED_MATRIX_IDX_H
+
+#include <stdint.h>
+
+#include "matrix.h"
+#include "matrix_typed.h"
+
+// Element types of IDX format, the third byte of its magic number. Elements are big endian.
+typedef enum {
+  IDX_UNSIGNED_BYTE = 0x08,
+  IDX_SIGNED_BYTE   = 0x09,
+  IDX_SHORT         = 0x0B,
+  IDX_INTEGER       = 0x0C,
+  IDX_FLOAT         = 0x0D,
+  IDX_DOUBLE        = 0x0E
+} idx_type_t;
+
+// IDX data as a matrix: rows are along the first dimension, all the others make columns.
+typedef struct {
+  uint32_t       rows;
+  uint32_t       cols;
+  idx_type_t     type;
+  const uint8_t *elements;
+} IdxData;
+
+// Size of IDX header by its first four bytes.
+uint64_t
+matrix_idx_header_size(const uint8_t *data);
+
+// Reads the header only, the elements may not be there yet.
+int
+matrix_idx_parse_header(const uint8_t *data, const uint64_t size, IdxData *idx);
+
+// Reads the header of `size` bytes long IDX data. Returns 0, if it's malformed
+// or there are fewer elements than its dimensions need.
+int
+matrix_idx_parse(const uint8_t *data, const uint64_t size, IdxData *idx);
+
+// Element size in bytes or 0 for unknown type.
+uint32_t
+matrix_idx_type_size(const idx_type_t type);
+
+int
+matrix_idx_is_integer(const idx_type_t type);
+
+// Typed matrix type, which keeps integer elements: uint8, int8 or int32 for wider ones.
+matrix_type_t
+matrix_idx_integer_type(const idx_type_t type);
+
+// Converts elements into float matrix, with its header, mapping them from [min, max] onto [0, 1],
+// when `normalize` is set, with the same result as matrix_normalize() of the converted matrix.
+void
+matrix_idx_to_float(const IdxData *idx, const int normalize, Matrix result);
+
+// Copies integer elements into typed matrix data: bytes as they are, shorts and integers as int32.
+void
+matrix_idx_to_integers(const IdxData *idx, void *result);
+
+// Converts `count` elements, e.g. a chunk of streamed data, into floats, when `float_result` is set
+// or elements are floats, or into integers, as matrix_idx_to_integers() does, otherwise.
+void
+matrix_idx_convert(
+  const idx_type_t type, const uint8_t *elements, const uint64_t count, const int float_result, void *out
+);
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef INCLUDED_MATRIX_QUANTIZED_H
+#define INCLUDED_MATRIX_QUANTIZED_H
+
+#include <stdint.h>
+
+// Minimum number of multiply-adds per thread pool chunk of quantized matrix product.
+#define QUANTIZED_PARALLEL_WORK (128*128*128)
+
+// Products of int8 elements are at most 2^14, so int32 sums of less than 2^17 of them don't overflow.
+#define QUANTIZED_MAX_INNER ((1 << 17) - 1)
+
+// Product of rows × inner and inner × cols int8 matrices, summed in int32, which doesn't overflow
+// for inner dimension up to QUANTIZED_MAX_INNER. Sums are stored into `sums`, unless `scaled` is given. Then they are
+// multiplied by first_scales[row*first_scales_step]*second_scales[col*second_scales_step] and stored
+// into `scaled` as floats. Step 0 means one scale for the whole matrix. Returns 0, when out of memory.
+int
+matrix_quantized_dot(
+  const int8_t *first, const int8_t *second, const uint64_t rows, const uint64_t inner, const uint64_t cols,
+  const float *first_scales, const uint64_t first_scales_step,
+  const float *second_scales, const uint64_t second_scales_step,
+  int32_t *sums, float *scaled
+);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef INCLUDED_MATRIX_RANDOM_H
+#define INCLUDED_MATRIX_RANDOM_H
+
+#include <stdint.h>
+
+#include "matrix.h"
+
+typedef enum {
+  RANDOM_UNIFORM,           // in [first, second)
+  RANDOM_NORMAL,            // with mean `first` and standard deviation `second`
+  RANDOM_TRUNCATED_NORMAL,  // the same, resampled until within two standard deviations of the mean
+  RANDOM_BERNOULLI          // 1 with probability `first`, 0 otherwise
+} random_distribution_t;
+
+typedef struct {
+  random_distribution_t type;
+  float                 first;
+  float                 second;
+} RandomDistribution;
+
+// Sets the state, from which seeds of calls without explicit one are derived.
+void
+matrix_random_init(const uint64_t entropy);
+
+// Returns a new seed on every call. Calls from different threads don't wait for each other.
+uint64_t
+matrix_random_seed(void);
+
+// Fills the matrix, which rows and columns are set, with elements of the distribution.
+// Element i is made of Philox4x32-10 block i/4 keyed by the seed, so the result depends
+// only on the seed, and big matrices are filled by thread pool workers in parallel.
+void
+matrix_random(Matrix matrix, const RandomDistribution *distribution, const uint64_t seed);
+
+#endif
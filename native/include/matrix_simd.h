@@ -0,0 +1,71 @@
+#ifndef INCLUDED_MATRIX_SIMD_H
+#define INCLUDED_MATRIX_SIMD_H
+
+#include <stdint.h>
+
+// Kernels work on raw float arrays of `size` elements, i.e. on matrix data past the header.
+typedef void (*simd_binary_t)(
+  const float *first, const float *second, const float alpha, const float beta, float *result, const uint64_t size
+);
+typedef void (*simd_unary_t)(const float *matrix, const float scalar, float *result, const uint64_t size);
+typedef double (*simd_sum_t)(const float *matrix, const uint64_t size);
+typedef double (*simd_sum_kahan_t)(const float *matrix, const uint64_t size, double *compensation);
+typedef float (*simd_extremum_t)(const float *matrix, const float initial, const uint64_t size);
+typedef uint64_t (*simd_argmax_t)(const float *matrix, const float initial, const uint64_t size, float *max);
+typedef uint64_t (*simd_find_t)(const float *matrix, const float value, const uint64_t size);
+typedef void (*simd_philox_t)(
+  const uint64_t first_block, const uint32_t stream, const uint64_t seed, uint32_t *out, const uint64_t blocks
+);
+
+// Philox4x32-10 multipliers and key increments.
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+
+typedef struct {
+  const char    *isa;
+  simd_binary_t  add;
+  simd_binary_t  subtract;
+  simd_binary_t  multiply;
+  simd_binary_t  divide;
+  simd_unary_t   add_scalar;
+  simd_unary_t   subtract_from_scalar;
+  simd_unary_t   multiply_with_scalar;
+  simd_unary_t   divide_scalar;
+  simd_unary_t   divide_by_scalar;
+  simd_unary_t   neg;
+  // Math functions ignore the scalar.
+  simd_unary_t   exp;
+  simd_unary_t   log;
+  simd_unary_t   sigmoid;
+  simd_unary_t   tanh;
+  simd_unary_t   erf;
+  simd_unary_t   sqrt;
+  // Reductions. Extremes start from the initial value, the finite ones return infinity
+  // of the opposite sign, when there are no finite elements. See the template for details.
+  simd_sum_t       sum;
+  simd_sum_kahan_t sum_kahan;
+  simd_extremum_t  max;
+  simd_extremum_t  min;
+  simd_extremum_t  max_finite;
+  simd_extremum_t  min_finite;
+  simd_argmax_t    argmax;
+  simd_find_t      find;
+  // Counter-based random bits, the same for every instruction set, see the template.
+  simd_philox_t    philox;
+} simd_kernels_t;
+
+// Kernels for the instruction set, selected by matrix_simd_select(). Generic ones until then.
+extern const simd_kernels_t *matrix_simd;
+
+// Selects kernels by instruction set name: "generic", "sse2", "avx2", "avx512" or "auto",
+// which means the best one this CPU supports. Returns 0, if the CPU does not support the one asked for.
+int
+matrix_simd_select(const char *isa);
+
+// Vectorized math function of the selected instruction set by its name or NULL, if there is none.
+simd_unary_t
+matrix_simd_math(const char *name);
+
+#endif
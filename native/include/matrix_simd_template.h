@@ -0,0 +1,512 @@
+// Elementwise and reduction kernels template, included by matrix_simd.c once per instruction set.
+// Expects SIMD_ISA (name suffix), SIMD_WIDTH (floats per vector), SIMD_TARGET (function attribute)
+// and SIMD_SQRT(vector) to be defined. No include guard on purpose.
+
+#define SIMD_FN(name) SIMD_CONCAT(name, SIMD_ISA)
+#define SIMD_VECTOR SIMD_FN(vector_t)
+
+#define SIMD_INT_VECTOR SIMD_FN(int_vector_t)
+
+typedef float SIMD_VECTOR __attribute__((vector_size(SIMD_WIDTH * 4), aligned(4), may_alias));
+typedef int32_t SIMD_INT_VECTOR __attribute__((vector_size(SIMD_WIDTH * 4)));
+
+#define SIMD_SPLAT(value) ((SIMD_VECTOR){0} + (value))
+
+// Lanes of `a`, where the mask (result of a vector comparison) is set, and lanes of `b` elsewhere.
+#define SIMD_SELECT(mask, a, b) \
+  ((SIMD_VECTOR)(((mask) & (SIMD_INT_VECTOR)(a)) | (~(mask) & (SIMD_INT_VECTOR)(b))))
+
+// Expression is written once for both vectors and the scalar tail,
+// `a` and `b` being elements of the first and second matrix.
+#define SIMD_BINARY_KERNEL(name, expression)                                                       \
+  SIMD_TARGET static void                                                                          \
+  SIMD_FN(name)(const float *first, const float *second, const float alpha, const float beta,      \
+                float *result, const uint64_t size) {                                              \
+    uint64_t index = 0;                                                                            \
+    (void)(alpha);                                                                                 \
+    (void)(beta);                                                                                  \
+    for (; index + SIMD_WIDTH <= size; index += SIMD_WIDTH) {                                      \
+      const SIMD_VECTOR a = *(const SIMD_VECTOR *)(first + index);                                 \
+      const SIMD_VECTOR b = *(const SIMD_VECTOR *)(second + index);                                \
+      *(SIMD_VECTOR *)(result + index) = (expression);                                             \
+    }                                                                                              \
+    for (; index < size; index += 1) {                                                             \
+      const float a = first[index], b = second[index];                                             \
+      result[index] = (expression);                                                                \
+    }                                                                                              \
+  }
+
+#define SIMD_UNARY_KERNEL(name, expression)                                                        \
+  SIMD_TARGET static void                                                                          \
+  SIMD_FN(name)(const float *matrix, const float scalar, float *result, const uint64_t size) {     \
+    uint64_t index = 0;                                                                            \
+    (void)(scalar);                                                                                \
+    for (; index + SIMD_WIDTH <= size; index += SIMD_WIDTH) {                                      \
+      const SIMD_VECTOR a = *(const SIMD_VECTOR *)(matrix + index);                                \
+      *(SIMD_VECTOR *)(result + index) = (expression);                                             \
+    }                                                                                              \
+    for (; index < size; index += 1) {                                                             \
+      const float a = matrix[index];                                                               \
+      result[index] = (expression);                                                                \
+    }                                                                                              \
+  }
+
+/*
+
+Math functions, using Cephes single precision polynomials. Maximum errors, measured against
+double precision libm over all float arguments (every 13th one for SSE2), are:
+
+  exp      1.1 ULP
+  log      0.9 ULP
+  sigmoid  2.9 ULP
+  tanh     1.4 ULP
+  erf      2.6 ULP
+  sqrt     0.5 ULP, i.e. correctly rounded
+
+*/
+
+// Float value of integer lanes, not greater than 2^22 by absolute value.
+#define SIMD_TO_FLOAT(integers) ((SIMD_VECTOR)((integers) + SIMD_MAGIC_BITS) - SIMD_MAGIC)
+#define SIMD_MAGIC 12582912.0f  // 1.5 * 2^23, adding it rounds to an integer
+#define SIMD_MAGIC_BITS 0x4b400000
+
+SIMD_TARGET static inline SIMD_VECTOR
+SIMD_FN(exp_vector)(const SIMD_VECTOR x) {
+  // Out of this range results are 0 or infinity anyway. NaNs pass through.
+  const SIMD_VECTOR clamped = SIMD_SELECT(x > 89.0f, SIMD_SPLAT(89.0f), SIMD_SELECT(x < -104.0f, SIMD_SPLAT(-104.0f), x));
+  const SIMD_VECTOR shifted = clamped * 1.44269504088896341f + SIMD_MAGIC;
+  const SIMD_VECTOR n = shifted - SIMD_MAGIC;
+  const SIMD_INT_VECTOR power = (SIMD_INT_VECTOR)shifted - SIMD_MAGIC_BITS;
+
+  // r = x - n*ln(2) with ln(2) split in two for precision.
+  SIMD_VECTOR r = clamped - n * 0.693359375f;
+  r = r - n * -2.12194440e-4f;
+
+  SIMD_VECTOR p = r * 1.9875691500E-4f + 1.3981999507E-3f;
+  p = p * r + 8.3334519073E-3f;
+  p = p * r + 4.1665795894E-2f;
+  p = p * r + 1.6666665459E-1f;
+  p = p * r + 5.0000001201E-1f;
+  p = p * r * r + r + 1.0f;
+
+  // Scaling by 2^n in two steps covers both overflow and denormal results.
+  const SIMD_INT_VECTOR half = power >> 1;
+
+  return p * (SIMD_VECTOR)((half + 127) << 23) * (SIMD_VECTOR)((power - half + 127) << 23);
+}
+
+SIMD_TARGET static inline SIMD_VECTOR
+SIMD_FN(log_vector)(const SIMD_VECTOR x) {
+  const SIMD_INT_VECTOR denormal = x < 1.17549435e-38f;
+  const SIMD_VECTOR normal = SIMD_SELECT(denormal, x * 8388608.0f, x);
+  const SIMD_INT_VECTOR bits = (SIMD_INT_VECTOR)normal;
+
+  // x = m * 2^e, sqrt(0.5) <= m < sqrt(2)
+  SIMD_INT_VECTOR exponent = ((bits >> 23) & 0xff) - 126 + (denormal & -23);
+  SIMD_VECTOR m = (SIMD_VECTOR)((bits & 0x007fffff) | 0x3f000000);
+  const SIMD_INT_VECTOR small = m < 0.707106781186547524f;
+
+  exponent += small;
+  m = SIMD_SELECT(small, m + m, m) - 1.0f;
+
+  const SIMD_VECTOR e = SIMD_TO_FLOAT(exponent);
+  const SIMD_VECTOR z = m * m;
+
+  SIMD_VECTOR y = m * 7.0376836292E-2f - 1.1514610310E-1f;
+  y = y * m + 1.1676998740E-1f;
+  y = y * m - 1.2420140846E-1f;
+  y = y * m + 1.4249322787E-1f;
+  y = y * m - 1.6668057665E-1f;
+  y = y * m + 2.0000714765E-1f;
+  y = y * m - 2.4999993993E-1f;
+  y = y * m + 3.3333331174E-1f;
+  y = y * m * z;
+
+  y = y + e * -2.12194440e-4f;
+  y = y - 0.5f * z;
+  y = m + y + e * 0.693359375f;
+
+  y = SIMD_SELECT(x == 0.0f, SIMD_SPLAT(-INFINITY), y);
+  y = SIMD_SELECT(x == INFINITY, x, y);
+  return SIMD_SELECT(x < 0.0f, SIMD_SPLAT(NAN), SIMD_SELECT(x != x, x, y));
+}
+
+SIMD_TARGET static inline SIMD_VECTOR
+SIMD_FN(sigmoid_vector)(const SIMD_VECTOR x) {
+  // exp(-|x|) never overflows, so tiny results for big negative x are not lost.
+  const SIMD_VECTOR e = SIMD_FN(exp_vector)((SIMD_VECTOR)((SIMD_INT_VECTOR)x | (int32_t)0x80000000));
+  const SIMD_VECTOR s = 1.0f / (1.0f + e);
+
+  return SIMD_SELECT(x < 0.0f, e * s, s);
+}
+
+SIMD_TARGET static inline SIMD_VECTOR
+SIMD_FN(tanh_vector)(const SIMD_VECTOR x) {
+  const SIMD_INT_VECTOR sign = (SIMD_INT_VECTOR)x & (int32_t)0x80000000;
+  const SIMD_VECTOR a = (SIMD_VECTOR)((SIMD_INT_VECTOR)x & 0x7fffffff);
+  const SIMD_VECTOR z = x * x;
+
+  SIMD_VECTOR small = z * -5.70498872745E-3f + 2.06390887954E-2f;
+  small = small * z - 5.37397155531E-2f;
+  small = small * z + 1.33314422036E-1f;
+  small = small * z - 3.33332819422E-1f;
+  small = small * z * x + x;
+
+  const SIMD_VECTOR large = 1.0f - 2.0f / (SIMD_FN(exp_vector)(a + a) + 1.0f);
+
+  return SIMD_SELECT(a < 0.625f, small, (SIMD_VECTOR)((SIMD_INT_VECTOR)large | sign));
+}
+
+SIMD_TARGET static inline SIMD_VECTOR
+SIMD_FN(erf_vector)(const SIMD_VECTOR x) {
+  const SIMD_INT_VECTOR sign = (SIMD_INT_VECTOR)x & (int32_t)0x80000000;
+  const SIMD_VECTOR a = (SIMD_VECTOR)((SIMD_INT_VECTOR)x & 0x7fffffff);
+  const SIMD_VECTOR z = x * x;
+
+  SIMD_VECTOR small = z * 7.853861353153693E-5f - 8.010193625184903E-4f;
+  small = small * z + 5.188327685732524E-3f;
+  small = small * z - 2.685381193529856E-2f;
+  small = small * z + 1.128358514861418E-1f;
+  small = small * z - 3.761262582423300E-1f;
+  small = small * z + 1.128379165726710E+0f;
+  small = small * x;
+
+  // erf(x) = 1 - erfc(x), erfc(x) = exp(-x^2)/x * P(1/x^2), with different P below and above 2.
+  const SIMD_INT_VECTOR near = a < 2.0f;
+  const SIMD_VECTOR q = 1.0f / a;
+  const SIMD_VECTOR y = q * q;
+
+#define SIMD_ERFC_TERM(p, below, above) ((p) * y + SIMD_SELECT(near, SIMD_SPLAT(below), SIMD_SPLAT(above)))
+  SIMD_VECTOR p = SIMD_SELECT(near, SIMD_SPLAT(2.326819970068386E-2f), SIMD_SPLAT(0.0f));
+  p = SIMD_ERFC_TERM(p, -1.387039388740657E-1f, -1.047766399936249E+1f);
+  p = SIMD_ERFC_TERM(p,  3.687424674597105E-1f,  1.297719955372516E+1f);
+  p = SIMD_ERFC_TERM(p, -5.824733027278666E-1f, -7.495518717768503E+0f);
+  p = SIMD_ERFC_TERM(p,  6.210004621745983E-1f,  2.921019019210786E+0f);
+  p = SIMD_ERFC_TERM(p, -4.944515323274145E-1f, -1.015265279202700E+0f);
+  p = SIMD_ERFC_TERM(p,  3.404879937665872E-1f,  4.218463358204948E-1f);
+  p = SIMD_ERFC_TERM(p, -2.741127028184656E-1f, -2.820767439740514E-1f);
+  p = SIMD_ERFC_TERM(p,  5.638259427386472E-1f,  5.641895067754075E-1f);
+#undef SIMD_ERFC_TERM
+
+  const SIMD_VECTOR large = 1.0f - SIMD_FN(exp_vector)(-z) * q * p;
+
+  return SIMD_SELECT(a < 1.0f, small, (SIMD_VECTOR)((SIMD_INT_VECTOR)large | sign));
+}
+
+SIMD_TARGET static inline SIMD_VECTOR
+SIMD_FN(sqrt_vector)(const SIMD_VECTOR x) {
+  return SIMD_SQRT(x);
+}
+
+#define SIMD_MATH_KERNEL(name)                                                                     \
+  SIMD_TARGET static void                                                                          \
+  SIMD_FN(name)(const float *matrix, const float scalar, float *result, const uint64_t size) {     \
+    uint64_t index = 0;                                                                            \
+    (void)(scalar);                                                                                \
+    for (; index + SIMD_WIDTH <= size; index += SIMD_WIDTH) {                                      \
+      *(SIMD_VECTOR *)(result + index) = SIMD_FN(name##_vector)(*(const SIMD_VECTOR *)(matrix + index)); \
+    }                                                                                              \
+    if (index < size) {                                                                            \
+      SIMD_VECTOR tail = {0};                                                                      \
+      memcpy(&tail, matrix + index, (size - index) * sizeof(float));                               \
+      tail = SIMD_FN(name##_vector)(tail);                                                         \
+      memcpy(result + index, &tail, (size - index) * sizeof(float));                               \
+    }                                                                                              \
+  }
+
+SIMD_MATH_KERNEL(exp)
+SIMD_MATH_KERNEL(log)
+SIMD_MATH_KERNEL(sigmoid)
+SIMD_MATH_KERNEL(tanh)
+SIMD_MATH_KERNEL(erf)
+SIMD_MATH_KERNEL(sqrt)
+
+/*
+
+Reductions. Sums are accumulated in double precision lanes, extremes and their indices
+in float and int32 lanes, which are combined at the end. All of them return the same result
+as a sequential loop would, except for rounding of the sums.
+
+*/
+
+// Float vectors are converted to double ones of the same size, i.e. with half as many lanes.
+#define SIMD_DOUBLE_WIDTH (SIMD_WIDTH > 1 ? SIMD_WIDTH / 2 : 1)
+#define SIMD_HALF_VECTOR SIMD_FN(half_vector_t)
+#define SIMD_DOUBLE_VECTOR SIMD_FN(double_vector_t)
+#define SIMD_LONG_VECTOR SIMD_FN(long_vector_t)
+
+typedef float SIMD_HALF_VECTOR __attribute__((vector_size(SIMD_DOUBLE_WIDTH * 4), aligned(4), may_alias));
+typedef double SIMD_DOUBLE_VECTOR __attribute__((vector_size(SIMD_DOUBLE_WIDTH * 8)));
+typedef int64_t SIMD_LONG_VECTOR __attribute__((vector_size(SIMD_DOUBLE_WIDTH * 8)));
+
+#define SIMD_LOAD_DOUBLE(address) __builtin_convertvector(*(const SIMD_HALF_VECTOR *)(address), SIMD_DOUBLE_VECTOR)
+#define SIMD_DOUBLE_ABS(vector) ((SIMD_DOUBLE_VECTOR)((SIMD_LONG_VECTOR)(vector) & INT64_MAX))
+#define SIMD_DOUBLE_SELECT(mask, a, b) \
+  ((SIMD_DOUBLE_VECTOR)(((mask) & (SIMD_LONG_VECTOR)(a)) | (~(mask) & (SIMD_LONG_VECTOR)(b))))
+
+SIMD_TARGET static double
+SIMD_FN(sum)(const float *matrix, const uint64_t size) {
+  SIMD_DOUBLE_VECTOR sums[4] = {{0}};
+  double   sum = 0.0;
+  uint64_t index = 0;
+
+  for (; index + 4*SIMD_DOUBLE_WIDTH <= size; index += 4*SIMD_DOUBLE_WIDTH) {
+    for (int part = 0; part < 4; part += 1) {
+      sums[part] += SIMD_LOAD_DOUBLE(matrix + index + part*SIMD_DOUBLE_WIDTH);
+    }
+  }
+
+  sums[0] += sums[1];
+  sums[2] += sums[3];
+  sums[0] += sums[2];
+
+  for (int lane = 0; lane < SIMD_DOUBLE_WIDTH; lane += 1) sum += sums[0][lane];
+  for (; index < size; index += 1) sum += matrix[index];
+
+  return sum;
+}
+
+// Neumaier's variant of Kahan summation: lost low order bits of each addition are accumulated
+// separately and added back at the end.
+#define SIMD_NEUMAIER_STEP(sum, compensation, value, abs, select) do {                            \
+    const __typeof__(sum) total = (sum) + (value);                                                 \
+    (compensation) += select(abs(sum) >= abs(value), ((sum) - total) + (value), ((value) - total) + (sum)); \
+    (sum) = total;                                                                                 \
+  } while (0)
+
+#define SIMD_SCALAR_SELECT(condition, a, b) ((condition) ? (a) : (b))
+
+// Returns the sum and stores the compensation apart, since adding it to the sum could lose it again.
+SIMD_TARGET static double
+SIMD_FN(sum_kahan)(const float *matrix, const uint64_t size, double *compensation_out) {
+  SIMD_DOUBLE_VECTOR sums[2] = {{0}}, compensations[2] = {{0}};
+  double   sum = 0.0, compensation = 0.0;
+  uint64_t index = 0;
+
+  for (; index + 2*SIMD_DOUBLE_WIDTH <= size; index += 2*SIMD_DOUBLE_WIDTH) {
+    for (int part = 0; part < 2; part += 1) {
+      const SIMD_DOUBLE_VECTOR values = SIMD_LOAD_DOUBLE(matrix + index + part*SIMD_DOUBLE_WIDTH);
+      SIMD_NEUMAIER_STEP(sums[part], compensations[part], values, SIMD_DOUBLE_ABS, SIMD_DOUBLE_SELECT);
+    }
+  }
+
+  for (int part = 0; part < 2; part += 1) {
+    for (int lane = 0; lane < SIMD_DOUBLE_WIDTH; lane += 1) {
+      SIMD_NEUMAIER_STEP(sum, compensation, sums[part][lane], fabs, SIMD_SCALAR_SELECT);
+      compensation += compensations[part][lane];
+    }
+  }
+
+  for (; index < size; index += 1) {
+    SIMD_NEUMAIER_STEP(sum, compensation, (double)matrix[index], fabs, SIMD_SCALAR_SELECT);
+  }
+
+  *compensation_out = compensation;
+  return sum;
+}
+
+// Finds the extreme element, for which the condition on candidate `a` and current extreme `m` holds,
+// starting from `initial`. NaN initial value makes the result NaN, as comparisons with it are false.
+#define SIMD_EXTREMUM_KERNEL(name, condition)                                                      \
+  SIMD_TARGET static float                                                                         \
+  SIMD_FN(name)(const float *matrix, const float initial, const uint64_t size) {                  \
+    SIMD_VECTOR extremes = SIMD_SPLAT(initial);                                                    \
+    float    m;                                                                                    \
+    uint64_t index = 0;                                                                            \
+    /* Selecting single lanes by masks is slower than branches of the scalar loop. */              \
+    for (; SIMD_WIDTH > 1 && index + SIMD_WIDTH <= size; index += SIMD_WIDTH) {                    \
+      const SIMD_VECTOR a = *(const SIMD_VECTOR *)(matrix + index);                                \
+      const SIMD_VECTOR m = extremes;                                                              \
+      extremes = SIMD_SELECT((condition), a, m);                                                   \
+    }                                                                                              \
+    m = extremes[0];                                                                               \
+    for (int lane = 1; lane < SIMD_WIDTH; lane += 1) {                                             \
+      const float a = extremes[lane];                                                              \
+      if (condition) m = a;                                                                        \
+    }                                                                                              \
+    for (; index < size; index += 1) {                                                             \
+      const float a = matrix[index];                                                               \
+      if (condition) m = a;                                                                        \
+    }                                                                                              \
+    return m;                                                                                      \
+  }
+
+// Finite elements are the ones, for which a - a is 0, and not NaN.
+SIMD_EXTREMUM_KERNEL(max, m < a)
+SIMD_EXTREMUM_KERNEL(min, m > a)
+SIMD_EXTREMUM_KERNEL(max_finite, (a - a == 0) & (m < a))
+SIMD_EXTREMUM_KERNEL(min_finite, (a - a == 0) & (m > a))
+
+// Index of the first greatest element, starting from `initial` value at index 0,
+// and the element itself. Size must be less than 2^31.
+SIMD_TARGET static uint64_t
+SIMD_FN(argmax)(const float *matrix, const float initial, const uint64_t size, float *max) {
+  SIMD_VECTOR     maxima = SIMD_SPLAT(initial);
+  SIMD_INT_VECTOR indices = {0}, lanes;
+  uint64_t        index = 0, argmax;
+
+  for (int lane = 0; lane < SIMD_WIDTH; lane += 1) lanes[lane] = lane;
+
+  for (; SIMD_WIDTH > 1 && index + SIMD_WIDTH <= size; index += SIMD_WIDTH) {
+    const SIMD_VECTOR     values = *(const SIMD_VECTOR *)(matrix + index);
+    const SIMD_INT_VECTOR greater = maxima < values;
+
+    maxima  = SIMD_SELECT(greater, values, maxima);
+    indices = (greater & (lanes + (int32_t)index)) | (~greater & indices);
+  }
+
+  *max = maxima[0];
+  argmax = indices[0];
+
+  // Lanes hold the first maxima of their elements, so of equal ones the leftmost wins.
+  for (int lane = 1; lane < SIMD_WIDTH; lane += 1) {
+    if (*max < maxima[lane] || (*max == maxima[lane] && (uint64_t)indices[lane] < argmax)) {
+      *max = maxima[lane];
+      argmax = indices[lane];
+    }
+  }
+
+  for (; index < size; index += 1) {
+    if (*max < matrix[index]) {
+      *max = matrix[index];
+      argmax = index;
+    }
+  }
+
+  return argmax;
+}
+
+// Index of the first element equal to `value`, NaN being equal to NaN, or `size`, if there is none.
+SIMD_TARGET static uint64_t
+SIMD_FN(find)(const float *matrix, const float value, const uint64_t size) {
+  const SIMD_VECTOR     values = SIMD_SPLAT(value);
+  const SIMD_INT_VECTOR nan = (SIMD_INT_VECTOR){0} - (value != value);
+  uint64_t              index = 0;
+
+  // Checks four vectors at a time, as collecting lanes of the comparison result is the slow part.
+  for (; index + 4*SIMD_WIDTH <= size; index += 4*SIMD_WIDTH) {
+    SIMD_INT_VECTOR found = {0};
+    int32_t         any = 0;
+
+    for (int part = 0; part < 4; part += 1) {
+      const SIMD_VECTOR a = *(const SIMD_VECTOR *)(matrix + index + part*SIMD_WIDTH);
+      found |= (a == values) | ((a != a) & nan);
+    }
+
+    for (int lane = 0; lane < SIMD_WIDTH; lane += 1) any |= found[lane];
+
+    if (any) break;
+  }
+
+  for (; index < size; index += 1) {
+    if (matrix[index] == value || (value != value && matrix[index] != matrix[index])) return index;
+  }
+
+  return size;
+}
+
+#define SIMD_UINT_VECTOR SIMD_FN(uint_vector_t)
+#define SIMD_WIDE_VECTOR SIMD_FN(wide_vector_t)
+
+typedef uint32_t SIMD_UINT_VECTOR __attribute__((vector_size(SIMD_WIDTH * 4)));
+typedef uint64_t SIMD_WIDE_VECTOR __attribute__((vector_size(SIMD_WIDTH * 8)));
+
+// Philox4x32-10 blocks, one per lane. Counter words of block `first_block + b` are its number
+// and `stream`, the key is `seed`, and its four words are written to out[4*b] .. out[4*b + 3].
+SIMD_TARGET static void
+SIMD_FN(philox)(const uint64_t first_block, const uint32_t stream, const uint64_t seed,
+                uint32_t *out, const uint64_t blocks) {
+  for (uint64_t block = 0; block < blocks; block += SIMD_WIDTH) {
+    SIMD_UINT_VECTOR x0, x1, x2 = (SIMD_UINT_VECTOR){0} + stream, x3 = {0};
+    uint32_t         k0 = (uint32_t) seed, k1 = (uint32_t) (seed >> 32);
+
+    for (int lane = 0; lane < SIMD_WIDTH; lane += 1) {
+      x0[lane] = (uint32_t) (first_block + block + lane);
+      x1[lane] = (uint32_t) ((first_block + block + lane) >> 32);
+    }
+
+    for (int round = 0; round < 10; round += 1) {
+      const SIMD_WIDE_VECTOR p0 = __builtin_convertvector(x0, SIMD_WIDE_VECTOR) * PHILOX_M0;
+      const SIMD_WIDE_VECTOR p1 = __builtin_convertvector(x2, SIMD_WIDE_VECTOR) * PHILOX_M1;
+
+      x0 = __builtin_convertvector(p1 >> 32, SIMD_UINT_VECTOR) ^ x1 ^ k0;
+      x1 = __builtin_convertvector(p1, SIMD_UINT_VECTOR);
+      x2 = __builtin_convertvector(p0 >> 32, SIMD_UINT_VECTOR) ^ x3 ^ k1;
+      x3 = __builtin_convertvector(p0, SIMD_UINT_VECTOR);
+      k0 += PHILOX_W0;
+      k1 += PHILOX_W1;
+    }
+
+    for (int lane = 0; lane < SIMD_WIDTH && block + lane < blocks; lane += 1) {
+      out[4*(block + lane)]     = x0[lane];
+      out[4*(block + lane) + 1] = x1[lane];
+      out[4*(block + lane) + 2] = x2[lane];
+      out[4*(block + lane) + 3] = x3[lane];
+    }
+  }
+}
+
+SIMD_BINARY_KERNEL(add, alpha*a + beta*b)
+SIMD_BINARY_KERNEL(subtract, a - b)
+SIMD_BINARY_KERNEL(multiply, a * b)
+SIMD_BINARY_KERNEL(divide, a / b)
+
+SIMD_UNARY_KERNEL(add_scalar, a + scalar)
+SIMD_UNARY_KERNEL(subtract_from_scalar, scalar - a)
+SIMD_UNARY_KERNEL(multiply_with_scalar, a * scalar)
+SIMD_UNARY_KERNEL(divide_scalar, scalar / a)
+SIMD_UNARY_KERNEL(divide_by_scalar, a / scalar)
+SIMD_UNARY_KERNEL(neg, -a)
+
+static const simd_kernels_t SIMD_FN(kernels) = {
+  .isa                  = SIMD_STRING(SIMD_ISA),
+  .add                  = SIMD_FN(add),
+  .subtract             = SIMD_FN(subtract),
+  .multiply             = SIMD_FN(multiply),
+  .divide               = SIMD_FN(divide),
+  .add_scalar           = SIMD_FN(add_scalar),
+  .subtract_from_scalar = SIMD_FN(subtract_from_scalar),
+  .multiply_with_scalar = SIMD_FN(multiply_with_scalar),
+  .divide_scalar        = SIMD_FN(divide_scalar),
+  .divide_by_scalar     = SIMD_FN(divide_by_scalar),
+  .neg                  = SIMD_FN(neg),
+  .exp                  = SIMD_FN(exp),
+  .log                  = SIMD_FN(log),
+  .sigmoid              = SIMD_FN(sigmoid),
+  .tanh                 = SIMD_FN(tanh),
+  .erf                  = SIMD_FN(erf),
+  .sqrt                 = SIMD_FN(sqrt),
+  .sum                  = SIMD_FN(sum),
+  .sum_kahan            = SIMD_FN(sum_kahan),
+  .max                  = SIMD_FN(max),
+  .min                  = SIMD_FN(min),
+  .max_finite           = SIMD_FN(max_finite),
+  .min_finite           = SIMD_FN(min_finite),
+  .argmax               = SIMD_FN(argmax),
+  .find                 = SIMD_FN(find),
+  .philox               = SIMD_FN(philox)
+};
+
+#undef SIMD_BINARY_KERNEL
+#undef SIMD_UNARY_KERNEL
+#undef SIMD_MATH_KERNEL
+#undef SIMD_EXTREMUM_KERNEL
+#undef SIMD_NEUMAIER_STEP
+#undef SIMD_SCALAR_SELECT
+#undef SIMD_DOUBLE_SELECT
+#undef SIMD_DOUBLE_ABS
+#undef SIMD_LOAD_DOUBLE
+#undef SIMD_HALF_VECTOR
+#undef SIMD_DOUBLE_WIDTH
+#undef SIMD_LONG_VECTOR
+#undef SIMD_DOUBLE_VECTOR
+#undef SIMD_TO_FLOAT
+#undef SIMD_WIDE_VECTOR
+#undef SIMD_UINT_VECTOR
+#undef SIMD_MAGIC
+#undef SIMD_MAGIC_BITS
+#undef SIMD_SELECT
+#undef SIMD_SPLAT
+#undef SIMD_INT_VECTOR
+#undef SIMD_VECTOR
+#undef SIMD_FN
@@ -0,0 +1,52 @@
+#ifndef INCLUDED_MATRIX_STREAM_H
+#define INCLUDED_MATRIX_STREAM_H
+
+#include <stdint.h>
+
+#include "matrix.h"
+#include "matrix_idx.h"
+
+// The longest header: IDX one with 255 dimensions.
+#define STREAM_HEADER_MAX (4 + 4*255)
+
+typedef enum {
+  STREAM_MTX,
+  STREAM_IDX
+} stream_format_t;
+
+// Matrix file, which comes in chunks, e.g. inflated from gzip one by one. As soon as the header
+// is complete, the whole matrix is allocated, and the following chunks are stored into it right away,
+// IDX elements converted, so that only the matrix and a chunk are held in memory at once.
+typedef struct {
+  stream_format_t  format;
+  int              float_result;    // IDX integers are converted to floats
+  int              normalize;       // and normalized, as matrix_normalize() does
+  int              failed;
+  uint8_t          header[STREAM_HEADER_MAX];
+  uint32_t         header_length;
+  uint8_t          partial[8];      // IDX element split between chunks
+  uint32_t         partial_length;
+  IdxData          idx;
+  uint8_t         *result;          // .mtx file contents: float or typed matrix
+  uint64_t         result_size;
+  uint64_t         written;         // bytes of result, for .mtx, or elements, for IDX
+  uint32_t         elements_offset; // result header size, for IDX
+  uint32_t         element_size;    // result element size, for IDX
+} MatrixStream;
+
+void
+matrix_stream_init(MatrixStream *stream, const stream_format_t format, const int float_result, const int normalize);
+
+// Stores the next chunk. Returns 0, when the header is malformed or there's more data than it says.
+int
+matrix_stream_write(MatrixStream *stream, const uint8_t *data, const uint64_t size);
+
+// Returns the matrix, which stays owned by the stream, and sets its size in bytes,
+// or returns NULL, when the data were malformed or incomplete.
+void *
+matrix_stream_finish(MatrixStream *stream, uint64_t *size);
+
+void
+matrix_stream_free(MatrixStream *stream);
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef INCLUDED_MATRIX_TYPED_H
+#define INCLUDED_MATRIX_TYPED_H
+
+#include <stdint.h>
+
+#include "matrix.h"
+
+// Matrices of elements of other types than float. Their header is four uint32 words:
+// rows, columns, element type and MX_TYPED_MAGIC, which tells typed matrix from the float one,
+// e.g. when loading it from file. Elements follow the header, row by row.
+#define MX_TYPED_HEADER_SIZE 16
+#define MX_TYPED_MAGIC 0x5458544d // "MTXT"
+
+typedef enum {
+  MX_FLOAT32,
+  MX_FLOAT64,
+  MX_FLOAT16,   // IEEE 754 half precision
+  MX_BFLOAT16,  // upper half of float32
+  MX_INT8,
+  MX_UINT8,
+  MX_INT32,
+  MX_TYPES_COUNT
+} matrix_type_t;
+
+typedef struct {
+  uint32_t rows;
+  uint32_t cols;
+  uint32_t type;
+  uint32_t magic;
+} TypedHeader;
+
+typedef TypedHeader *TypedMatrix;
+
+#define MX_TYPED_DATA(matrix) ((void *)((char *)(matrix) + MX_TYPED_HEADER_SIZE))
+#define MX_TYPED_COUNT(matrix) ((uint64_t)(matrix)->rows*(uint64_t)(matrix)->cols)
+
+typedef enum {
+  MX_ADD,
+  MX_SUBTRACT,
+  MX_MULTIPLY,
+  MX_DIVIDE
+} matrix_operation_t;
+
+// Type by its name, e.g. "float64", or -1, if there's no such type.
+int
+matrix_type_from_name(const char *name);
+
+uint32_t
+matrix_type_size(const matrix_type_t type);
+
+int
+matrix_type_is_integer(const matrix_type_t type);
+
+// Size of typed matrix in bytes, header included, or 0, when it doesn't fit in uint64.
+uint64_t
+matrix_typed_byte_size(const uint32_t rows, const uint32_t cols, const matrix_type_t type);
+
+// Checks the header of `byte_size` bytes long binary: magic, known type and size matching dimensions.
+int
+matrix_typed_valid(const void *data, const uint64_t byte_size);
+
+void
+matrix_typed_init(TypedMatrix matrix, const uint32_t rows, const uint32_t cols, const matrix_type_t type);
+
+// Widens `count` elements, starting from `from`, to double.
+void
+matrix_typed_read(const TypedMatrix matrix, const uint64_t from, const uint64_t count, double *out);
+
+// Elements conversions. Result header must be initialized with the type to convert to.
+void
+matrix_typed_convert(const TypedMatrix source, TypedMatrix result);
+
+void
+matrix_typed_from_matrex(const Matrix source, TypedMatrix result);
+
+void
+matrix_typed_to_matrex(const TypedMatrix source, Matrix result);
+
+void
+matrix_typed_fill(TypedMatrix matrix, const double value);
+
+void
+matrix_typed_eye(TypedMatrix matrix, const double value);
+
+// Elementwise operations on matrices of the same type and size or on a matrix and a scalar,
+// which is the first operand, if `scalar_first` is set. Return 0, when operands don't match.
+int
+matrix_typed_operate(
+  const matrix_operation_t operation, const TypedMatrix first, const TypedMatrix second, TypedMatrix result
+);
+
+void
+matrix_typed_operate_scalar(
+  const matrix_operation_t operation, const TypedMatrix matrix, const double scalar,
+  const int scalar_first, TypedMatrix result
+);
+
+// Applies math function by its name, the same ones matrix_apply() knows. Returns 0, if it's unknown.
+int
+matrix_typed_apply(const TypedMatrix matrix, const char *function_name, TypedMatrix result);
+
+// Minimum number of multiply-adds per thread pool chunk in the built-in typed matrix product.
+#define TYPED_DOT_PARALLEL_WORK (64*64*64)
+
+// Returns 0, when types or sizes don't match or memory runs out.
+int
+matrix_typed_dot(const double alpha, const TypedMatrix first, const TypedMatrix second, TypedMatrix result);
+
+// Product of int8 matrices: exact int32 one, when result type is int32, or float32 one, scaled
+// by scales of the rows of the first matrix and of the columns of the second one, see matrix_quantized_dot().
+// Returns 0, when types or sizes don't match or memory runs out.
+int
+matrix_typed_quantized_dot(
+  const TypedMatrix first, const TypedMatrix second,
+  const float *first_scales, const uint64_t first_scales_step,
+  const float *second_scales, const uint64_t second_scales_step,
+  TypedMatrix result
+);
+
+void
+matrix_typed_transpose(const TypedMatrix matrix, TypedMatrix result);
+
+double
+matrix_typed_sum(const TypedMatrix matrix);
+
+double
+matrix_typed_max(const TypedMatrix matrix);
+
+double
+matrix_typed_min(const TypedMatrix matrix);
+
+// Cholesky decomposition and forward substitution, as matrix_cholesky() and matrix_solve() do.
+// Return 0, when sizes don't match or memory runs out.
+int
+matrix_typed_cholesky(const TypedMatrix matrix, TypedMatrix result);
+
+int
+matrix_typed_solve(const TypedMatrix matrix, const TypedMatrix beta, TypedMatrix result);
+
+#endif
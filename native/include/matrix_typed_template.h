@@ -0,0 +1,565 @@
+// Typed matrix kernels template, included by matrix_typed.c once per element type.
+// Expects TYPED_NAME (name suffix), TYPED_STORAGE (type of stored elements), TYPED_COMPUTE
+// (type, arithmetic is done in) and TYPED_MATH(f) (libm function `f` for the compute type) to be defined.
+// Elements, stored in a narrower type, than the compute one, need TYPED_LOAD_BLOCK(in, count, out) and
+// TYPED_STORE_BLOCK(in, count, out) to convert arrays between the two: kernels convert them TYPED_BLOCK
+// elements at a time, and TYPED_BLOCK_GEMM(rows, cols, inner, alpha, first, first_stride, second,
+// second_stride, result, result_stride), which adds product of compute type blocks to the result
+// and returns 0, when out of memory.
+// Optional TYPED_GEMM(alpha, first, second, result, rows, inner, cols) does matrix product of elements,
+// stored in compute type, returning 0, when out of memory, and TYPED_SIMD_MATH tells, that compute type is float, so matrix_simd math
+// kernels apply.
+// No include guard on purpose.
+
+#define TYPED_FN(name) TYPED_CONCAT(name, TYPED_NAME)
+
+typedef TYPED_COMPUTE (*TYPED_FN(math_t))(TYPED_COMPUTE);
+
+// Stored elements as compute type values: the elements themselves or their conversion into the buffer.
+static inline const TYPED_COMPUTE *
+TYPED_FN(load)(const TYPED_STORAGE *elements, const uint64_t count, TYPED_COMPUTE *buffer) {
+#ifdef TYPED_LOAD_BLOCK
+  TYPED_LOAD_BLOCK(elements, count, buffer);
+  return buffer;
+#else
+  (void)count;
+  (void)buffer;
+  return elements;
+#endif
+}
+
+// Where to compute values of the elements: the elements themselves or the buffer, store() converts them from.
+static inline TYPED_COMPUTE *
+TYPED_FN(target)(TYPED_STORAGE *elements, TYPED_COMPUTE *buffer) {
+#ifdef TYPED_LOAD_BLOCK
+  (void)elements;
+  return buffer;
+#else
+  (void)buffer;
+  return elements;
+#endif
+}
+
+static inline void
+TYPED_FN(store)(const TYPED_COMPUTE *values, const uint64_t count, TYPED_STORAGE *elements) {
+#ifdef TYPED_STORE_BLOCK
+  TYPED_STORE_BLOCK(values, count, elements);
+#else
+  (void)values;
+  (void)count;
+  (void)elements;
+#endif
+}
+
+// Buffer for `count` compute type values, if elements need conversion, NULL otherwise.
+static TYPED_COMPUTE *
+TYPED_FN(allocate)(const uint64_t count) {
+#ifdef TYPED_LOAD_BLOCK
+  return malloc(count*sizeof(TYPED_COMPUTE));
+#else
+  (void)count;
+  return NULL;
+#endif
+}
+
+// Tells, whether allocate() should have returned a buffer, but has run out of memory.
+static inline int
+TYPED_FN(allocate_failed)(const TYPED_COMPUTE *buffer) {
+#ifdef TYPED_LOAD_BLOCK
+  return buffer == NULL;
+#else
+  (void)buffer;
+  return 0;
+#endif
+}
+
+static void
+TYPED_FN(read)(const void *data, const uint64_t count, double *out) {
+  const TYPED_STORAGE *elements = (const TYPED_STORAGE *)data;
+  TYPED_COMPUTE        buffer[TYPED_BLOCK];
+
+  for (uint64_t from = 0; from < count; from += TYPED_BLOCK) {
+    const uint64_t       size = TYPED_BLOCK_SIZE(from, count);
+    const TYPED_COMPUTE *values = TYPED_FN(load)(elements + from, size, buffer);
+
+    TYPED_EACH(size, out[from + index] = values[index]);
+  }
+}
+
+static void
+TYPED_FN(write)(const double *in, const uint64_t count, void *data) {
+  TYPED_STORAGE *elements = (TYPED_STORAGE *)data;
+  TYPED_COMPUTE  buffer[TYPED_BLOCK];
+
+  for (uint64_t from = 0; from < count; from += TYPED_BLOCK) {
+    const uint64_t size = TYPED_BLOCK_SIZE(from, count);
+    TYPED_COMPUTE *values = TYPED_FN(target)(elements + from, buffer);
+
+    TYPED_EACH(size, values[index] = (TYPED_COMPUTE)in[from + index]);
+    TYPED_FN(store)(values, size, elements + from);
+  }
+}
+
+static void
+TYPED_FN(from_floats)(const float *in, const uint64_t count, void *data) {
+  TYPED_STORAGE *elements = (TYPED_STORAGE *)data;
+  TYPED_COMPUTE  buffer[TYPED_BLOCK];
+
+  for (uint64_t from = 0; from < count; from += TYPED_BLOCK) {
+    const uint64_t size = TYPED_BLOCK_SIZE(from, count);
+    TYPED_COMPUTE *values = TYPED_FN(target)(elements + from, buffer);
+
+    TYPED_EACH(size, values[index] = (TYPED_COMPUTE)in[from + index]);
+    TYPED_FN(store)(values, size, elements + from);
+  }
+}
+
+static void
+TYPED_FN(to_floats)(const void *data, const uint64_t count, float *out) {
+  const TYPED_STORAGE *elements = (const TYPED_STORAGE *)data;
+  TYPED_COMPUTE        buffer[TYPED_BLOCK];
+
+  for (uint64_t from = 0; from < count; from += TYPED_BLOCK) {
+    const uint64_t       size = TYPED_BLOCK_SIZE(from, count);
+    const TYPED_COMPUTE *values = TYPED_FN(load)(elements + from, size, buffer);
+
+    TYPED_EACH(size, out[from + index] = (float)values[index]);
+  }
+}
+
+static void
+TYPED_FN(fill)(void *data, const double value, const uint64_t count) {
+  TYPED_STORAGE *elements = (TYPED_STORAGE *)data;
+  TYPED_STORAGE  element;
+  TYPED_COMPUTE  buffer[1];
+  TYPED_COMPUTE *converted = TYPED_FN(target)(&element, buffer);
+
+  *converted = (TYPED_COMPUTE)value;
+  TYPED_FN(store)(converted, 1, &element);
+
+  TYPED_EACH(count, elements[index] = element);
+}
+
+static void
+TYPED_FN(operate)(
+  const matrix_operation_t operation, const void *first, const void *second, void *result, const uint64_t count
+) {
+  TYPED_COMPUTE a_buffer[TYPED_BLOCK], b_buffer[TYPED_BLOCK], out_buffer[TYPED_BLOCK];
+
+  for (uint64_t from = 0; from < count; from += TYPED_BLOCK) {
+    const uint64_t       size = TYPED_BLOCK_SIZE(from, count);
+    const TYPED_COMPUTE *a = TYPED_FN(load)((const TYPED_STORAGE *)first + from, size, a_buffer);
+    const TYPED_COMPUTE *b = TYPED_FN(load)((const TYPED_STORAGE *)second + from, size, b_buffer);
+    TYPED_COMPUTE       *out = TYPED_FN(target)((TYPED_STORAGE *)result + from, out_buffer);
+
+    switch (operation) {
+      case MX_ADD:
+        TYPED_EACH(size, out[index] = a[index] + b[index]);
+        break;
+      case MX_SUBTRACT:
+        TYPED_EACH(size, out[index] = a[index] - b[index]);
+        break;
+      case MX_MULTIPLY:
+        TYPED_EACH(size, out[index] = a[index] * b[index]);
+        break;
+      case MX_DIVIDE:
+        TYPED_EACH(size, out[index] = a[index] / b[index]);
+        break;
+    }
+
+    TYPED_FN(store)(out, size, (TYPED_STORAGE *)result + from);
+  }
+}
+
+static void
+TYPED_FN(operate_scalar)(
+  const matrix_operation_t operation, const void *matrix, const double scalar, const int scalar_first,
+  void *result, const uint64_t count
+) {
+  const TYPED_COMPUTE s = (TYPED_COMPUTE)scalar;
+  TYPED_COMPUTE       a_buffer[TYPED_BLOCK], out_buffer[TYPED_BLOCK];
+
+  for (uint64_t from = 0; from < count; from += TYPED_BLOCK) {
+    const uint64_t       size = TYPED_BLOCK_SIZE(from, count);
+    const TYPED_COMPUTE *a = TYPED_FN(load)((const TYPED_STORAGE *)matrix + from, size, a_buffer);
+    TYPED_COMPUTE       *out = TYPED_FN(target)((TYPED_STORAGE *)result + from, out_buffer);
+
+    switch (operation) {
+      case MX_ADD:
+        TYPED_EACH(size, out[index] = a[index] + s);
+        break;
+      case MX_SUBTRACT:
+        if (scalar_first)
+          TYPED_EACH(size, out[index] = s - a[index]);
+        else
+          TYPED_EACH(size, out[index] = a[index] - s);
+        break;
+      case MX_MULTIPLY:
+        TYPED_EACH(size, out[index] = a[index] * s);
+        break;
+      case MX_DIVIDE:
+        if (scalar_first)
+          TYPED_EACH(size, out[index] = s / a[index]);
+        else
+          TYPED_EACH(size, out[index] = a[index] / s);
+        break;
+    }
+
+    TYPED_FN(store)(out, size, (TYPED_STORAGE *)result + from);
+  }
+}
+
+static TYPED_COMPUTE
+TYPED_FN(sigmoid)(TYPED_COMPUTE x) {
+  return 1/(1 + TYPED_MATH(exp)(-x));
+}
+
+static TYPED_FN(math_t)
+TYPED_FN(math)(const char *name) {
+  static const struct {
+    const char     *name;
+    TYPED_FN(math_t) func;
+  } functions[] = {
+    {"exp", TYPED_MATH(exp)}, {"exp2", TYPED_MATH(exp2)}, {"sigmoid", TYPED_FN(sigmoid)},
+    {"expm1", TYPED_MATH(expm1)}, {"ceil", TYPED_MATH(ceil)}, {"floor", TYPED_MATH(floor)},
+    {"truncate", TYPED_MATH(trunc)}, {"trunc", TYPED_MATH(trunc)}, {"round", TYPED_MATH(round)},
+    {"abs", TYPED_MATH(fabs)}, {"erf", TYPED_MATH(erf)}, {"erfc", TYPED_MATH(erfc)},
+    {"tgamma", TYPED_MATH(tgamma)}, {"lgamma", TYPED_MATH(lgamma)}, {"log", TYPED_MATH(log)},
+    {"log2", TYPED_MATH(log2)}, {"sqrt", TYPED_MATH(sqrt)}, {"cbrt", TYPED_MATH(cbrt)},
+    {"sin", TYPED_MATH(sin)}, {"cos", TYPED_MATH(cos)}, {"tan", TYPED_MATH(tan)},
+    {"asin", TYPED_MATH(asin)}, {"acos", TYPED_MATH(acos)}, {"atan", TYPED_MATH(atan)},
+    {"sinh", TYPED_MATH(sinh)}, {"cosh", TYPED_MATH(cosh)}, {"tanh", TYPED_MATH(tanh)},
+    {"asinh", TYPED_MATH(asinh)}, {"acosh", TYPED_MATH(acosh)}, {"atanh", TYPED_MATH(atanh)}
+  };
+
+  for (uint64_t index = 0; index < sizeof(functions)/sizeof(functions[0]); index += 1)
+    if (strcmp(name, functions[index].name) == 0) return functions[index].func;
+
+  return NULL;
+}
+
+static int
+TYPED_FN(apply)(const char *function_name, const void *matrix, void *result, const uint64_t count) {
+  const TYPED_FN(math_t) func = TYPED_FN(math)(function_name);
+#ifdef TYPED_SIMD_MATH
+  const simd_unary_t     simd_func = matrix_simd_math(function_name);
+#endif
+  TYPED_COMPUTE          a_buffer[TYPED_BLOCK], out_buffer[TYPED_BLOCK];
+
+  if (func == NULL) return 0;
+
+  for (uint64_t from = 0; from < count; from += TYPED_BLOCK) {
+    const uint64_t       size = TYPED_BLOCK_SIZE(from, count);
+    const TYPED_COMPUTE *a = TYPED_FN(load)((const TYPED_STORAGE *)matrix + from, size, a_buffer);
+    TYPED_COMPUTE       *out = TYPED_FN(target)((TYPED_STORAGE *)result + from, out_buffer);
+
+#ifdef TYPED_SIMD_MATH
+    if (simd_func != NULL)
+      simd_func(a, 0, out, size);
+    else
+#endif
+      TYPED_EACH(size, out[index] = func(a[index]));
+
+    TYPED_FN(store)(out, size, (TYPED_STORAGE *)result + from);
+  }
+
+  return 1;
+}
+
+#ifdef TYPED_GEMM
+
+static int
+TYPED_FN(dot)(
+  const double alpha, const void *first, const void *second, void *result,
+  const uint64_t rows, const uint64_t inner, const uint64_t cols
+) {
+  return TYPED_GEMM((TYPED_COMPUTE)alpha, first, second, result, rows, inner, cols);
+}
+
+#elif defined(TYPED_LOAD_BLOCK)
+
+// Multiplies TYPED_GEMM_ROWS × TYPED_GEMM_COLS tile of the result at a time. Blocks of the matrices,
+// the tile depends on, are converted into compute type, TYPED_GEMM_INNER elements deep, and their
+// products are accumulated with TYPED_BLOCK_GEMM, which is parallel: BLAS, matrix_gemm() or rows
+// split between thread pool workers. So conversions take a small fraction of the time and only
+// the blocks, not whole matrices, are kept widened.
+static int
+TYPED_FN(dot)(
+  const double alpha, const void *first, const void *second, void *result,
+  const uint64_t rows, const uint64_t inner, const uint64_t cols
+) {
+  const TYPED_STORAGE *a = (const TYPED_STORAGE *)first;
+  const TYPED_STORAGE *b = (const TYPED_STORAGE *)second;
+  TYPED_STORAGE       *out = (TYPED_STORAGE *)result;
+  TYPED_COMPUTE       *a_block = malloc(TYPED_GEMM_ROWS*TYPED_GEMM_INNER*sizeof(TYPED_COMPUTE));
+  TYPED_COMPUTE       *b_block = malloc(TYPED_GEMM_INNER*TYPED_GEMM_COLS*sizeof(TYPED_COMPUTE));
+  TYPED_COMPUTE       *sums = malloc(TYPED_GEMM_ROWS*TYPED_GEMM_COLS*sizeof(TYPED_COMPUTE));
+  int                  success = a_block != NULL && b_block != NULL && sums != NULL;
+
+  for (uint64_t row_from = 0; success && row_from < rows; row_from += TYPED_GEMM_ROWS) {
+    const uint64_t height = row_from + TYPED_GEMM_ROWS < rows ? TYPED_GEMM_ROWS : rows - row_from;
+
+    for (uint64_t col_from = 0; success && col_from < cols; col_from += TYPED_GEMM_COLS) {
+      const uint64_t width = col_from + TYPED_GEMM_COLS < cols ? TYPED_GEMM_COLS : cols - col_from;
+
+      memset(sums, 0, height*width*sizeof(TYPED_COMPUTE));
+
+      for (uint64_t inner_from = 0; success && inner_from < inner; inner_from += TYPED_GEMM_INNER) {
+        const uint64_t depth = inner_from + TYPED_GEMM_INNER < inner ? TYPED_GEMM_INNER : inner - inner_from;
+
+        for (uint64_t row = 0; row < height; row += 1)
+          TYPED_LOAD_BLOCK(a + (row_from + row)*inner + inner_from, depth, a_block + row*depth);
+
+        for (uint64_t k = 0; k < depth; k += 1)
+          TYPED_LOAD_BLOCK(b + (inner_from + k)*cols + col_from, width, b_block + k*width);
+
+        success = TYPED_BLOCK_GEMM(height, width, depth, (TYPED_COMPUTE)alpha, a_block, depth, b_block, width, sums, width);
+      }
+
+      for (uint64_t row = 0; row < height; row += 1)
+        TYPED_STORE_BLOCK(sums + row*width, width, out + (row_from + row)*cols + col_from);
+    }
+  }
+
+  free(a_block);
+  free(b_block);
+  free(sums);
+  return success;
+}
+
+#else
+
+// Multiplies chunk of rows of the first matrix by the second one, TYPED_DOT_ROWS × TYPED_DOT_COLS
+// block of the result at a time. Each TYPED_DOT_INNER rows of the second matrix part, the block
+// depends on, stay in cache, while all rows of the block are accumulated with them.
+static void
+TYPED_FN(dot_rows)(void *args, uint64_t from, uint64_t to) {
+  const typed_dot_args_t *dot = (const typed_dot_args_t *)args;
+  const TYPED_COMPUTE    *a = (const TYPED_COMPUTE *)dot->first;
+  const TYPED_COMPUTE    *b = (const TYPED_COMPUTE *)dot->second;
+  TYPED_COMPUTE          *out = (TYPED_COMPUTE *)dot->result;
+  const uint64_t          inner = dot->inner, cols = dot->cols;
+  TYPED_COMPUTE          *sums = malloc(TYPED_DOT_ROWS*TYPED_DOT_COLS*sizeof(TYPED_COMPUTE));
+
+  if (sums == NULL) {
+    __atomic_store_n(&((typed_dot_args_t *)args)->failed, 1, __ATOMIC_RELAXED);
+    return;
+  }
+
+  for (uint64_t row_from = from; row_from < to; row_from += TYPED_DOT_ROWS) {
+    const uint64_t row_to = row_from + TYPED_DOT_ROWS < to ? row_from + TYPED_DOT_ROWS : to;
+
+    for (uint64_t col_from = 0; col_from < cols; col_from += TYPED_DOT_COLS) {
+      const uint64_t width = col_from + TYPED_DOT_COLS < cols ? TYPED_DOT_COLS : cols - col_from;
+
+      memset(sums, 0, TYPED_DOT_ROWS*TYPED_DOT_COLS*sizeof(TYPED_COMPUTE));
+
+      for (uint64_t inner_from = 0; inner_from < inner; inner_from += TYPED_DOT_INNER) {
+        const uint64_t inner_to = inner_from + TYPED_DOT_INNER < inner ? inner_from + TYPED_DOT_INNER : inner;
+
+        for (uint64_t row = row_from; row < row_to; row += 1) {
+          TYPED_COMPUTE *row_sums = sums + (row - row_from)*TYPED_DOT_COLS;
+          uint64_t       k = inner_from;
+
+          // Four rows of the second matrix at a time, to load and store the sums less often.
+          for (; k + 4 <= inner_to; k += 4) {
+            const TYPED_COMPUTE  a_0 = a[row*inner + k], a_1 = a[row*inner + k + 1];
+            const TYPED_COMPUTE  a_2 = a[row*inner + k + 2], a_3 = a[row*inner + k + 3];
+            const TYPED_COMPUTE *b_0 = b + k*cols + col_from, *b_1 = b_0 + cols, *b_2 = b_1 + cols, *b_3 = b_2 + cols;
+
+            for (uint64_t col = 0; col < width; col += 1)
+              row_sums[col] += a_0*b_0[col] + a_1*b_1[col] + a_2*b_2[col] + a_3*b_3[col];
+          }
+
+          for (; k < inner_to; k += 1) {
+            const TYPED_COMPUTE  a_k = a[row*inner + k];
+            const TYPED_COMPUTE *b_k = b + k*cols + col_from;
+
+            for (uint64_t col = 0; col < width; col += 1) row_sums[col] += a_k*b_k[col];
+          }
+        }
+      }
+
+      for (uint64_t row = row_from; row < row_to; row += 1)
+        for (uint64_t col = 0; col < width; col += 1)
+          out[row*cols + col_from + col] = (TYPED_COMPUTE)dot->alpha*sums[(row - row_from)*TYPED_DOT_COLS + col];
+    }
+  }
+
+  free(sums);
+}
+
+static int
+TYPED_FN(dot)(
+  const double alpha, const void *first, const void *second, void *result,
+  const uint64_t rows, const uint64_t inner, const uint64_t cols
+) {
+  typed_dot_args_t args = {alpha, first, second, result, inner, cols, 0};
+  const uint64_t   row_work = inner*cols > 0 ? inner*cols : 1;
+
+  thread_pool_run(TYPED_FN(dot_rows), &args, rows, TYPED_DOT_PARALLEL_WORK/row_work + 1);
+
+  return !args.failed;
+}
+
+#endif
+
+static void
+TYPED_FN(transpose)(const void *matrix, void *result, const uint64_t rows, const uint64_t cols) {
+  const TYPED_STORAGE *a = (const TYPED_STORAGE *)matrix;
+  TYPED_STORAGE       *out = (TYPED_STORAGE *)result;
+
+  for (uint64_t row_from = 0; row_from < rows; row_from += TYPED_TRANSPOSE_TILE)
+    for (uint64_t col_from = 0; col_from < cols; col_from += TYPED_TRANSPOSE_TILE) {
+      const uint64_t row_to = row_from + TYPED_TRANSPOSE_TILE < rows ? row_from + TYPED_TRANSPOSE_TILE : rows;
+      const uint64_t col_to = col_from + TYPED_TRANSPOSE_TILE < cols ? col_from + TYPED_TRANSPOSE_TILE : cols;
+
+      for (uint64_t row = row_from; row < row_to; row += 1)
+        for (uint64_t col = col_from; col < col_to; col += 1)
+          out[col*rows + row] = a[row*cols + col];
+    }
+}
+
+// Sums a block at a time, so that rounding errors don't grow with the number of elements as fast.
+static double
+TYPED_FN(sum)(const void *matrix, const uint64_t count) {
+  TYPED_COMPUTE buffer[TYPED_BLOCK];
+  double        sum = 0;
+
+  for (uint64_t from = 0; from < count; from += TYPED_BLOCK) {
+    const uint64_t       size = TYPED_BLOCK_SIZE(from, count);
+    const TYPED_COMPUTE *a = TYPED_FN(load)((const TYPED_STORAGE *)matrix + from, size, buffer);
+    double               block_sum = 0;
+
+    TYPED_EACH(size, block_sum += a[index]);
+
+    sum += block_sum;
+  }
+
+  return sum;
+}
+
+static double
+TYPED_FN(max)(const void *matrix, const uint64_t count) {
+  TYPED_COMPUTE buffer[TYPED_BLOCK];
+  TYPED_COMPUTE max = TYPED_FN(load)((const TYPED_STORAGE *)matrix, 1, buffer)[0];
+
+  for (uint64_t from = 0; from < count; from += TYPED_BLOCK) {
+    const uint64_t       size = TYPED_BLOCK_SIZE(from, count);
+    const TYPED_COMPUTE *a = TYPED_FN(load)((const TYPED_STORAGE *)matrix + from, size, buffer);
+
+    TYPED_EACH(size, if (max < a[index]) max = a[index]);
+  }
+
+  return max;
+}
+
+static double
+TYPED_FN(min)(const void *matrix, const uint64_t count) {
+  TYPED_COMPUTE buffer[TYPED_BLOCK];
+  TYPED_COMPUTE min = TYPED_FN(load)((const TYPED_STORAGE *)matrix, 1, buffer)[0];
+
+  for (uint64_t from = 0; from < count; from += TYPED_BLOCK) {
+    const uint64_t       size = TYPED_BLOCK_SIZE(from, count);
+    const TYPED_COMPUTE *a = TYPED_FN(load)((const TYPED_STORAGE *)matrix + from, size, buffer);
+
+    TYPED_EACH(size, if (min > a[index]) min = a[index]);
+  }
+
+  return min;
+}
+
+// Decomposes in compute type, converting the whole matrix, if it's stored in another one.
+static int
+TYPED_FN(cholesky)(const void *matrix, void *result, const uint64_t size) {
+  TYPED_COMPUTE       *a_buffer = TYPED_FN(allocate)(size*size), *l_buffer = TYPED_FN(allocate)(size*size);
+  const TYPED_COMPUTE *a;
+  TYPED_COMPUTE       *l;
+
+  if (TYPED_FN(allocate_failed)(a_buffer) || TYPED_FN(allocate_failed)(l_buffer)) {
+    free(a_buffer);
+    free(l_buffer);
+    return 0;
+  }
+
+  a = TYPED_FN(load)((const TYPED_STORAGE *)matrix, size*size, a_buffer);
+  l = TYPED_FN(target)((TYPED_STORAGE *)result, l_buffer);
+
+  memset(l, 0, size*size*sizeof(TYPED_COMPUTE));
+
+  for (uint64_t i = 0; i < size; i += 1)
+    for (uint64_t k = 0; k <= i; k += 1) {
+      TYPED_COMPUTE sum = 0;
+
+      for (uint64_t j = 0; j < k; j += 1) sum += l[i*size + j]*l[k*size + j];
+
+      l[i*size + k] = i == k ?
+        TYPED_MATH(sqrt)(TYPED_MATH(fmax)(a[i*size + i] - sum, 0)) :
+        (a[i*size + k] - sum)/l[k*size + k];
+    }
+
+  TYPED_FN(store)(l, size*size, (TYPED_STORAGE *)result);
+
+  free(a_buffer);
+  free(l_buffer);
+  return 1;
+}
+
+static int
+TYPED_FN(solve)(const void *matrix, const void *beta, void *result, const uint64_t size) {
+  TYPED_COMPUTE       *l_buffer = TYPED_FN(allocate)(size*size), *b_buffer = TYPED_FN(allocate)(size);
+  TYPED_COMPUTE       *x_buffer = TYPED_FN(allocate)(size);
+  const TYPED_COMPUTE *l, *b;
+  TYPED_COMPUTE       *x;
+
+  if (
+    TYPED_FN(allocate_failed)(l_buffer) || TYPED_FN(allocate_failed)(b_buffer) ||
+    TYPED_FN(allocate_failed)(x_buffer)
+  ) {
+    free(l_buffer);
+    free(b_buffer);
+    free(x_buffer);
+    return 0;
+  }
+
+  l = TYPED_FN(load)((const TYPED_STORAGE *)matrix, size*size, l_buffer);
+  b = TYPED_FN(load)((const TYPED_STORAGE *)beta, size, b_buffer);
+  x = TYPED_FN(target)((TYPED_STORAGE *)result, x_buffer);
+
+  for (uint64_t row = 0; row < size; row += 1) {
+    TYPED_COMPUTE sum = 0;
+
+    for (uint64_t col = 0; col < row; col += 1) sum += x[col]*l[row*size + col];
+
+    x[row] = (b[row] - sum)/l[row*size + row];
+  }
+
+  TYPED_FN(store)(x, size, (TYPED_STORAGE *)result);
+
+  free(l_buffer);
+  free(b_buffer);
+  free(x_buffer);
+  return 1;
+}
+
+static const typed_kernels_t TYPED_FN(kernels) = {
+  .name           = TYPED_STRING(TYPED_NAME),
+  .size           = sizeof(TYPED_STORAGE),
+  .read           = TYPED_FN(read),
+  .write          = TYPED_FN(write),
+  .from_floats    = TYPED_FN(from_floats),
+  .to_floats      = TYPED_FN(to_floats),
+  .fill           = TYPED_FN(fill),
+  .operate        = TYPED_FN(operate),
+  .operate_scalar = TYPED_FN(operate_scalar),
+  .apply          = TYPED_FN(apply),
+  .dot            = TYPED_FN(dot),
+  .transpose      = TYPED_FN(transpose),
+  .sum            = TYPED_FN(sum),
+  .max            = TYPED_FN(max),
+  .min            = TYPED_FN(min),
+  .cholesky       = TYPED_FN(cholesky),
+  .solve          = TYPED_FN(solve)
+};
+
+#undef TYPED_FN
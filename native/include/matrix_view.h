@@ -0,0 +1,35 @@
+#ifndef INCLUDED_MATRIX_VIEW_H
+#define INCLUDED_MATRIX_VIEW_H
+
+#include <stdint.h>
+
+#include "matrix.h"
+
+// Rectangular part of a matrix, used in place. Rows of the view are `stride` elements apart,
+// where stride is the number of columns of the whole matrix.
+typedef struct {
+  const float *data;    // first element of the view
+  uint32_t     rows;
+  uint32_t     cols;
+  uint64_t     stride;
+} MatrixView;
+
+// View of the whole matrix.
+MatrixView
+matrix_view_of(const Matrix matrix);
+
+void
+matrix_view_copy(const MatrixView view, Matrix result);
+
+double
+matrix_view_sum(const MatrixView view);
+
+void
+matrix_view_add(
+  const MatrixView first, const MatrixView second, const float alpha, const float beta, Matrix result
+);
+
+int
+matrix_view_dot(const float alpha, const MatrixView first, const MatrixView second, Matrix result);
+
+#endif
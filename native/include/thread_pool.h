@@ -0,0 +1,21 @@
+#ifndef INCLUDED_THREAD_POOL_H
+#define INCLUDED_THREAD_POOL_H
+
+#include <stdint.h>
+
+// Processes elements [from, to) of some job. `args` is passed as is from thread_pool_run().
+typedef void (*thread_pool_task_t)(void *args, uint64_t from, uint64_t to);
+
+int
+thread_pool_start(uint32_t workers);
+
+void
+thread_pool_stop(void);
+
+uint32_t
+thread_pool_size(void);
+
+void
+thread_pool_run(thread_pool_task_t task, void *args, uint64_t size, uint64_t grain);
+
+#endif
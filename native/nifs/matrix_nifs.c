@@ -1,16 +1,55 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "erl_nif.h"
 
 #include "../include/matrix.h"
+#include "../include/matrix_csv.h"
 #include "../include/matrix_dot.h"
+#include "../include/matrix_expression.h"
+#include "../include/matrix_gemm.h"
+#include "../include/matrix_idx.h"
 #include "../include/matrix_linalg.h"
+#include "../include/matrix_quantized.h"
+#include "../include/matrix_random.h"
+#include "../include/matrix_simd.h"
+#include "../include/matrix_stream.h"
+#include "../include/matrix_typed.h"
+#include "../include/matrix_view.h"
+#include "../include/thread_pool.h"
 
 #define ASSERT_SIZES_MATCH(m1, m2) if (MX_ROWS(m1) != MX_ROWS(m2) || MX_COLS(m1) != MX_COLS(m2)) \
     return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
 
+#define ASSERT_SIZES_BROADCAST(m1, m2) if (!matrix_broadcastable(m1, m2)) \
+    return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
+
 #define UNUSED_VAR(v) (void)(v)
 
+// Default amount of work (roughly, the number of elements touched or multiply-adds done),
+// starting from which a NIF leaves the normal scheduler. About a millisecond of work.
+#define DIRTY_THRESHOLD_DEFAULT 250000
+
+// Amount of work for the product of m×k and k×n matrices.
+#define DOT_WORK(m, k, n) ((uint64_t)(m)*(uint64_t)(k)*(uint64_t)(n))
+
+// Reschedules the calling NIF onto a dirty CPU scheduler, when the work it is about to do
+// would block the normal scheduler for too long. The NIF is called again with the same arguments.
+#define SCHEDULE_DIRTY_IF_LARGE(nif, work) do {                                                  \
+  if ((uint64_t)(work) >= dirty_threshold && enif_thread_type() == ERL_NIF_THR_NORMAL_SCHEDULER) \
+    return enif_schedule_nif(env, #nif, ERL_NIF_DIRTY_JOB_CPU_BOUND, nif, argc, argv);          \
+} while (0)
+
+// Set from `:dirty_threshold` application env on load, or by `set_dirty_threshold/1`.
+static uint64_t dirty_threshold = DIRTY_THRESHOLD_DEFAULT;
+
 //-----------------------------------------------------------------------------
 // Inner helper functions headers
 //-----------------------------------------------------------------------------
@@ -45,9 +84,11 @@ add(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   first_data  = (float *) first.data;
   second_data = (float *) second.data;
 
-  ASSERT_SIZES_MATCH(first_data, second_data);
+  ASSERT_SIZES_BROADCAST(first_data, second_data);
+
+  data_size   = matrix_broadcast_length(first_data, second_data);
 
-  data_size   = MX_LENGTH(first_data);
+  SCHEDULE_DIRTY_IF_LARGE(add, data_size);
 
   result_size = sizeof(float) * data_size;
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
@@ -72,6 +113,9 @@ add_scalar(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   scalar = get_scalar(env, argv[1]);
 
   matrix_data = (float *) matrix.data;
+
+  SCHEDULE_DIRTY_IF_LARGE(add_scalar, MX_LENGTH(matrix_data));
+
   data_size   = MX_LENGTH(matrix_data);
 
   result_size = sizeof(float) * data_size;
@@ -99,6 +143,8 @@ apply_math(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
 
   matrix_data  = (float *) matrix.data;
 
+  SCHEDULE_DIRTY_IF_LARGE(apply_math, MX_LENGTH(matrix_data));
+
   data_size   = MX_LENGTH(matrix_data);
 
   result_size = sizeof(float) * data_size;
@@ -110,39 +156,14 @@ apply_math(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
     return enif_make_badarg(env);
 }
 
-#define WORKERS_NUM 8
-
-#define min(a,b) \
-   ({ __typeof__ (a) _a = (a); \
-       __typeof__ (b) _b = (b); \
-     _a < _b ? _a : _b; })
-
-void* math(void* args) {
-  const Matrix* m = (const Matrix*)args;
-  const Matrix matrix = m[0];
-  const Matrix result = m[1];
-  const uint64_t* i= (const uint64_t*)args;
-  const uint64_t from = i[2];
-  const uint64_t to = i[3];
-  math_func_ptr_t* f = (math_func_ptr_t*)args;
-  math_func_ptr_t math_func = f[4];
-
-  for (uint64_t index = 2 + from; index < (2 + to); index += 1) {
-    result[index] = math_func(matrix[index]);
-  }
-
-  return NULL;
-}
-
 static ERL_NIF_TERM
 apply_parallel_math(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   ErlNifBinary  matrix;
   ERL_NIF_TERM  result;
   char          function_name[16];
   float        *matrix_data, *result_data;
-  uint64_t       data_size, chunk_size;
+  uint64_t       data_size;
   size_t        result_size;
-  ErlNifTid workers[WORKERS_NUM];
 
   (void)(argc);
 
@@ -152,47 +173,36 @@ apply_parallel_math(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
 
   matrix_data  = (float *) matrix.data;
 
+  SCHEDULE_DIRTY_IF_LARGE(apply_parallel_math, MX_LENGTH(matrix_data));
+
   data_size   = MX_LENGTH(matrix_data);
 
   result_size = sizeof(float) * data_size;
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
 
-
-  MX_SET_ROWS(result_data, MX_ROWS(matrix_data));
-  MX_SET_COLS(result_data, MX_COLS(matrix_data));
-
-  chunk_size = data_size / WORKERS_NUM + 1;
-
-  math_func_ptr_t func = math_func_from_name(function_name);
-
-  for (int i = 0; i < WORKERS_NUM; i++ ) {
-    uint64_t from = i*chunk_size;
-    uint64_t to = min((i+1)*chunk_size, data_size-2);
-    void* args[] = {matrix_data, result_data, (void*)from, (void*)to, (void*)func};
-    enif_thread_create("apply_math", &workers[i], &math, args, NULL);
-  }
-
-  for (int i = 0; i < WORKERS_NUM; i++ ) {
-    enif_thread_join(workers[i], NULL);
-  }
-
-  return result;
+  if (matrix_apply_parallel(matrix_data, function_name, result_data) == 1)
+    return result;
+  else
+    return enif_make_badarg(env);
 }
 
 static ERL_NIF_TERM
 argmax(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   ErlNifBinary  matrix;
   float        *matrix_data;
-  int32_t       argmax;
+  int32_t       index;
 
   (void)(argc);
 
   if (!enif_inspect_binary(env, argv[0], &matrix)) return enif_make_badarg(env);
 
   matrix_data = (float *) matrix.data;
-  argmax      = matrix_argmax(matrix_data);
 
-  return enif_make_int(env, argmax);
+  SCHEDULE_DIRTY_IF_LARGE(argmax, MX_LENGTH(matrix_data));
+
+  index       = matrix_argmax(matrix_data);
+
+  return enif_make_int(env, index);
 }
 
 static ERL_NIF_TERM
@@ -240,6 +250,8 @@ concat_columns(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   first_data  = (float *) first.data;
   second_data = (float *) second.data;
 
+  SCHEDULE_DIRTY_IF_LARGE(concat_columns, MX_LENGTH(first_data) + MX_LENGTH(second_data));
+
   result_size = 2*sizeof(float) + MX_DATA_BYTE_SIZE(first_data) + MX_DATA_BYTE_SIZE(second_data);
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
 
@@ -263,6 +275,9 @@ power(ErlNifEnv *env, int argc, const ERL_NIF_TERM *argv) {
   if (!enif_inspect_binary(env, argv[1], &matrix)) return enif_make_badarg(env);
 
   matrix_data = (float *) matrix.data;
+
+  SCHEDULE_DIRTY_IF_LARGE(power, MX_LENGTH(matrix_data));
+
   data_size   = MX_LENGTH(matrix_data);
 
   result_size = sizeof(float) * data_size;
@@ -289,9 +304,11 @@ divide(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   first_data  = (float *) first.data;
   second_data = (float *) second.data;
 
-  ASSERT_SIZES_MATCH(first_data, second_data);
+  ASSERT_SIZES_BROADCAST(first_data, second_data);
 
-  data_size   = MX_LENGTH(first_data);
+  data_size   = matrix_broadcast_length(first_data, second_data);
+
+  SCHEDULE_DIRTY_IF_LARGE(divide, data_size);
 
   result_size = sizeof(float) * data_size;
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
@@ -316,6 +333,9 @@ divide_scalar(ErlNifEnv *env, int argc, const ERL_NIF_TERM *argv) {
   if (!enif_inspect_binary(env, argv[1], &matrix)) return enif_make_badarg(env);
 
   matrix_data = (float *) matrix.data;
+
+  SCHEDULE_DIRTY_IF_LARGE(divide_scalar, MX_LENGTH(matrix_data));
+
   data_size   = MX_LENGTH(matrix_data);
 
   result_size = sizeof(float) * data_size;
@@ -341,6 +361,9 @@ divide_by_scalar(ErlNifEnv *env, int argc, const ERL_NIF_TERM *argv) {
   scalar = get_scalar(env, argv[1]);
 
   matrix_data = (float *) matrix.data;
+
+  SCHEDULE_DIRTY_IF_LARGE(divide_by_scalar, MX_LENGTH(matrix_data));
+
   data_size   = MX_LENGTH(matrix_data);
 
   result_size = sizeof(float) * data_size;
@@ -371,12 +394,15 @@ dot(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   if (MX_COLS(first_data) != MX_ROWS(second_data))
     return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
 
+  SCHEDULE_DIRTY_IF_LARGE(dot, DOT_WORK(MX_ROWS(first_data), MX_COLS(first_data), MX_COLS(second_data)));
+
   data_size   =  MX_ROWS(first_data) * MX_COLS(second_data) + 2;
 
   result_size = sizeof(float) * data_size;
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
 
-  matrix_dot(1.0, first_data, second_data, result_data);
+  if (!matrix_dot(1.0, first_data, second_data, result_data))
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
 
   return result;
 }
@@ -404,12 +430,15 @@ dot_and_add(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
       MX_COLS(second_data) != MX_COLS(third_data))
     return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
 
+  SCHEDULE_DIRTY_IF_LARGE(dot_and_add, DOT_WORK(MX_ROWS(first_data), MX_COLS(first_data), MX_COLS(second_data)));
+
   data_size   = MX_ROWS(first_data) * MX_COLS(second_data) + 2;
 
   result_size = sizeof(float) * data_size;
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
 
-  matrix_dot_and_add(1.0, first_data, second_data, third_data, result_data);
+  if (!matrix_dot_and_add(1.0, first_data, second_data, third_data, result_data))
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
 
   return result;
 }
@@ -437,12 +466,15 @@ dot_and_apply(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   if (MX_COLS(first_data) != MX_ROWS(second_data))
     return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
 
+  SCHEDULE_DIRTY_IF_LARGE(dot_and_apply, DOT_WORK(MX_ROWS(first_data), MX_COLS(first_data), MX_COLS(second_data)));
+
   data_size   = MX_ROWS(first_data) * MX_COLS(second_data) + 2;
 
   result_size = sizeof(float) * data_size;
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
 
-  matrix_dot_and_apply(1.0, first_data, second_data, function_name, result_data);
+  if (!matrix_dot_and_apply(1.0, first_data, second_data, function_name, result_data))
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
 
   return result;
 }
@@ -466,12 +498,15 @@ dot_nt(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   if (MX_COLS(first_data) != MX_COLS(second_data))
     return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
 
+  SCHEDULE_DIRTY_IF_LARGE(dot_nt, DOT_WORK(MX_ROWS(first_data), MX_COLS(first_data), MX_ROWS(second_data)));
+
   data_size   = MX_ROWS(first_data) * MX_ROWS(second_data) + 2;
 
   result_size = sizeof(float) * data_size;
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
 
-  matrix_dot_nt(1.0, first_data, second_data, result_data);
+  if (!matrix_dot_nt(1.0, first_data, second_data, result_data))
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
 
   return result;
 }
@@ -497,12 +532,15 @@ dot_tn(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   if (MX_ROWS(first_data) != MX_ROWS(second_data))
     return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
 
+  SCHEDULE_DIRTY_IF_LARGE(dot_tn, DOT_WORK(MX_COLS(first_data), MX_ROWS(first_data), MX_COLS(second_data)));
+
   data_size   = MX_COLS(first_data) * MX_COLS(second_data) + 2;
 
   result_size = sizeof(float) * data_size;
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
 
-  matrix_dot_tn(alpha, first_data, second_data, result_data);
+  if (!matrix_dot_tn(alpha, first_data, second_data, result_data))
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
 
   return result;
 }
@@ -528,6 +566,8 @@ forward_substitute(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   if (MX_ROWS(first_data) != MX_ROWS(second_data))
     return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
 
+  SCHEDULE_DIRTY_IF_LARGE(forward_substitute, MX_LENGTH(first_data));
+
   data_size   =  MX_ROWS(first_data) + 2;
 
   result_size = sizeof(float) * data_size;
@@ -555,6 +595,8 @@ cholesky(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   if (MX_COLS(first_data) != MX_COLS(first_data))
     return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
 
+  SCHEDULE_DIRTY_IF_LARGE(cholesky, DOT_WORK(MX_ROWS(first_data), MX_ROWS(first_data), MX_ROWS(first_data)) / 3);
+
   data_size   =  MX_ROWS(first_data) * MX_COLS(first_data) + 2;
   result_size = sizeof(float) * data_size;
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
@@ -577,6 +619,8 @@ eye(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   enif_get_uint64(env, argv[0], &size);
   value = get_scalar(env, argv[1]);
 
+  SCHEDULE_DIRTY_IF_LARGE(eye, size*size);
+
 
   result_size = (size*size + 2) * sizeof(float);
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
@@ -638,6 +682,8 @@ fill(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   if (!enif_inspect_binary(env, argv[2], &value)) return enif_make_badarg(env);
   value_data = (float*)value.data;
 
+  SCHEDULE_DIRTY_IF_LARGE(fill, rows*cols);
+
   result_size = (rows*cols + 2) * sizeof(float);
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
 
@@ -663,6 +709,8 @@ find(ErlNifEnv *env, int argc, const ERL_NIF_TERM *argv) {
   matrix_data = (float *) matrix.data;
   element_data = (float *) element.data;
 
+  SCHEDULE_DIRTY_IF_LARGE(find, MX_LENGTH(matrix_data));
+
 
   if (isnan(*element_data)) {
     index = matrix_find_nan(matrix_data);
@@ -693,6 +741,8 @@ from_range(ErlNifEnv *env, int argc, const ERL_NIF_TERM *argv) {
   enif_get_int64(env, argv[2], &rows);
   enif_get_int64(env, argv[3], &cols);
 
+  SCHEDULE_DIRTY_IF_LARGE(from_range, rows*cols);
+
   result_size = sizeof(float) * (2 + rows * cols);
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
 
@@ -732,7 +782,7 @@ make_cell_value(ErlNifEnv* env, const float value) {
 static ERL_NIF_TERM
 max(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   ErlNifBinary  matrix;
-  float         max;
+  float         max_value;
   float        *matrix_data;
 
   (void)(argc);
@@ -741,9 +791,11 @@ max(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
 
   matrix_data = (float *) matrix.data;
 
-  max = matrix_max(matrix_data);
+  SCHEDULE_DIRTY_IF_LARGE(max, MX_LENGTH(matrix_data));
+
+  max_value = matrix_max(matrix_data);
 
-  return make_cell_value(env, max);
+  return make_cell_value(env, max_value);
 }
 
 static ERL_NIF_TERM
@@ -758,6 +810,8 @@ max_finite(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
 
   matrix_data = (float *) matrix.data;
 
+  SCHEDULE_DIRTY_IF_LARGE(max_finite, MX_LENGTH(matrix_data));
+
   max = matrix_max_finite(matrix_data);
 
   if (isnan(max))
@@ -778,6 +832,8 @@ minimum(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
 
   matrix_data = (float *) matrix.data;
 
+  SCHEDULE_DIRTY_IF_LARGE(minimum, MX_LENGTH(matrix_data));
+
   min = matrix_min(matrix_data);
 
   return make_cell_value(env, min);
@@ -795,6 +851,8 @@ min_finite(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
 
   matrix_data = (float *) matrix.data;
 
+  SCHEDULE_DIRTY_IF_LARGE(min_finite, MX_LENGTH(matrix_data));
+
   min = matrix_min_finite(matrix_data);
 
   if (isnan(min))
@@ -819,9 +877,11 @@ multiply(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   first_data  = (float *) first.data;
   second_data = (float *) second.data;
 
-  ASSERT_SIZES_MATCH(first_data, second_data);
+  ASSERT_SIZES_BROADCAST(first_data, second_data);
 
-  data_size   = MX_LENGTH(first_data);
+  data_size   = matrix_broadcast_length(first_data, second_data);
+
+  SCHEDULE_DIRTY_IF_LARGE(multiply, data_size);
 
   result_size = sizeof(float) * data_size;
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
@@ -846,6 +906,9 @@ multiply_with_scalar(ErlNifEnv *env, int argc, const ERL_NIF_TERM *argv) {
   scalar = get_scalar(env, argv[1]);
 
   matrix_data = (float *) matrix.data;
+
+  SCHEDULE_DIRTY_IF_LARGE(multiply_with_scalar, MX_LENGTH(matrix_data));
+
   data_size   = MX_LENGTH(matrix_data);
 
   result_size = sizeof(float) * data_size;
@@ -869,6 +932,9 @@ neg(ErlNifEnv *env, int argc, const ERL_NIF_TERM *argv) {
   if (!enif_inspect_binary(env, argv[0], &matrix)) return enif_make_badarg(env);
 
   matrix_data = (float *) matrix.data;
+
+  SCHEDULE_DIRTY_IF_LARGE(neg, MX_LENGTH(matrix_data));
+
   data_size   = MX_LENGTH(matrix_data);
 
   result_size = sizeof(float) * data_size;
@@ -892,6 +958,9 @@ normalize(ErlNifEnv *env, int argc, const ERL_NIF_TERM *argv) {
   if (!enif_inspect_binary(env, argv[0], &matrix)) return enif_make_badarg(env);
 
   matrix_data = (float *) matrix.data;
+
+  SCHEDULE_DIRTY_IF_LARGE(normalize, MX_LENGTH(matrix_data));
+
   data_size   = MX_LENGTH(matrix_data);
 
   result_size = sizeof(float) * data_size;
@@ -902,29 +971,118 @@ normalize(ErlNifEnv *env, int argc, const ERL_NIF_TERM *argv) {
   return result;
 }
 
+// Reads distribution tuple: {:uniform, min, max}, {:normal, mean, std},
+// {:truncated_normal, mean, std} or {:bernoulli, probability}.
+static int
+get_distribution(ErlNifEnv *env, ERL_NIF_TERM term, RandomDistribution *distribution) {
+  const ERL_NIF_TERM *tuple;
+  int32_t             arity;
+  char                name[32];
+
+  if (!enif_get_tuple(env, term, &arity, &tuple) || arity < 2) return 0;
+  if (!enif_get_atom(env, tuple[0], name, sizeof(name), ERL_NIF_LATIN1)) return 0;
+
+  if (strcmp(name, "uniform") == 0 && arity == 3) distribution->type = RANDOM_UNIFORM;
+  else if (strcmp(name, "normal") == 0 && arity == 3) distribution->type = RANDOM_NORMAL;
+  else if (strcmp(name, "truncated_normal") == 0 && arity == 3) distribution->type = RANDOM_TRUNCATED_NORMAL;
+  else if (strcmp(name, "bernoulli") == 0 && arity == 2) distribution->type = RANDOM_BERNOULLI;
+  else return 0;
+
+  for (int32_t index = 1; index < arity; index += 1) {
+    if (!enif_is_number(env, tuple[index])) return 0;
+  }
+
+  distribution->first = get_scalar(env, tuple[1]);
+  distribution->second = arity == 3 ? get_scalar(env, tuple[2]) : 0.0f;
+
+  return 1;
+}
+
+// Takes rows, columns, distribution tuple and either a seed or nil, for a seed of its own.
 static ERL_NIF_TERM
 random_matrix(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
-  ERL_NIF_TERM result;
-  long rows, cols;
-  float *result_data;
-  size_t result_size;
+  ERL_NIF_TERM        result;
+  uint32_t            rows, cols;
+  ErlNifUInt64        seed;
+  RandomDistribution  distribution;
+  float              *result_data;
+  size_t              result_size;
 
-  (void)(argc);
+  UNUSED_VAR(argc);
 
-  enif_get_int64(env, argv[0], &rows);
-  enif_get_int64(env, argv[1], &cols);
+  if (!enif_get_uint(env, argv[0], &rows)) return enif_make_badarg(env);
+  if (!enif_get_uint(env, argv[1], &cols)) return enif_make_badarg(env);
+  if (!get_distribution(env, argv[2], &distribution)) return enif_make_badarg(env);
+  if (!enif_get_uint64(env, argv[3], &seed)) {
+    if (!enif_is_identical(argv[3], enif_make_atom(env, "nil"))) return enif_make_badarg(env);
+    seed = matrix_random_seed();
+  }
 
-  result_size = (rows*cols + 2) * sizeof(float);
+  SCHEDULE_DIRTY_IF_LARGE(random_matrix, (uint64_t) rows*cols);
+
+  result_size = ((uint64_t) rows*cols + 2) * sizeof(float);
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
 
   MX_SET_ROWS(result_data, rows);
   MX_SET_COLS(result_data, cols);
 
-  matrix_random(result_data);
+  matrix_random(result_data, &distribution, seed);
 
   return result;
 }
 
+static ERL_NIF_TERM
+reduce_columns(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  ErlNifBinary  matrix;
+  ERL_NIF_TERM  result;
+  char          reduction_name[16];
+  float        *matrix_data, *result_data;
+  size_t        result_size;
+
+  (void)(argc);
+
+  if (!enif_inspect_binary(env, argv[0], &matrix)) return enif_make_badarg(env);
+  if (enif_get_atom(env, argv[1], reduction_name, 16, ERL_NIF_LATIN1) == 0) return enif_make_badarg(env);
+
+  matrix_data = (float *) matrix.data;
+
+  SCHEDULE_DIRTY_IF_LARGE(reduce_columns, MX_LENGTH(matrix_data));
+
+  result_size = sizeof(float) * (2 + MX_COLS(matrix_data));
+  result_data = (float *) enif_make_new_binary(env, result_size, &result);
+
+  if (matrix_reduce_columns(matrix_data, reduction_name, result_data) == 1)
+    return result;
+  else
+    return enif_make_badarg(env);
+}
+
+static ERL_NIF_TERM
+reduce_rows(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  ErlNifBinary  matrix;
+  ERL_NIF_TERM  result;
+  char          reduction_name[16];
+  float        *matrix_data, *result_data;
+  size_t        result_size;
+
+  (void)(argc);
+
+  if (!enif_inspect_binary(env, argv[0], &matrix)) return enif_make_badarg(env);
+  if (enif_get_atom(env, argv[1], reduction_name, 16, ERL_NIF_LATIN1) == 0) return enif_make_badarg(env);
+
+  matrix_data = (float *) matrix.data;
+
+  SCHEDULE_DIRTY_IF_LARGE(reduce_rows, MX_LENGTH(matrix_data));
+
+  result_size = sizeof(float) * (2 + MX_ROWS(matrix_data));
+  result_data = (float *) enif_make_new_binary(env, result_size, &result);
+
+  if (matrix_reduce_rows(matrix_data, reduction_name, result_data) == 1)
+    return result;
+  else
+    return enif_make_badarg(env);
+}
+
 static ERL_NIF_TERM
 resize(ErlNifEnv *env, int argc, const ERL_NIF_TERM *argv) {
   ErlNifBinary  matrix;
@@ -944,6 +1102,8 @@ resize(ErlNifEnv *env, int argc, const ERL_NIF_TERM *argv) {
   new_rows = (int32_t)round((float)MX_ROWS(matrix_data) * scale);
   new_cols = (int32_t)round((float)MX_COLS(matrix_data) * scale);
 
+  SCHEDULE_DIRTY_IF_LARGE(resize, new_rows*new_cols);
+
   result_size = sizeof(float) * (2 + new_rows * new_cols);
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
 
@@ -1010,6 +1170,8 @@ set(ErlNifEnv* env, int32_t argc, const ERL_NIF_TERM *argv) {
   if (row >= rows || column >= cols)
     return enif_raise_exception(env, enif_make_string(env, "Position out of bounds.", ERL_NIF_LATIN1));
 
+  SCHEDULE_DIRTY_IF_LARGE(set, MX_LENGTH(matrix_data));
+
 
   result_size = MX_BYTE_SIZE(matrix_data);
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
@@ -1044,6 +1206,8 @@ set_column(ErlNifEnv* env, int32_t argc, const ERL_NIF_TERM *argv) {
   if (column >= cols)
     return enif_raise_exception(env, enif_make_string(env, "Position out of bounds.", ERL_NIF_LATIN1));
 
+  SCHEDULE_DIRTY_IF_LARGE(set_column, MX_LENGTH(matrix_data));
+
 
   result_size = MX_BYTE_SIZE(matrix_data);
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
@@ -1053,6 +1217,46 @@ set_column(ErlNifEnv* env, int32_t argc, const ERL_NIF_TERM *argv) {
   return result;
 }
 
+static ERL_NIF_TERM
+set_dirty_threshold(ErlNifEnv* env, int32_t argc, const ERL_NIF_TERM *argv) {
+  unsigned long threshold;
+
+  UNUSED_VAR(argc);
+
+  if (!enif_get_uint64(env, argv[0], &threshold)) return enif_make_badarg(env);
+
+  dirty_threshold = threshold;
+
+  return enif_make_atom(env, "ok");
+}
+
+static ERL_NIF_TERM
+set_simd(ErlNifEnv* env, int32_t argc, const ERL_NIF_TERM *argv) {
+  char isa[16];
+
+  UNUSED_VAR(argc);
+
+  if (!enif_get_atom(env, argv[0], isa, 16, ERL_NIF_LATIN1)) return enif_make_badarg(env);
+
+  if (matrix_simd_select(isa))
+    return enif_make_atom(env, "ok");
+  else
+    return enif_make_atom(env, "unsupported");
+}
+
+static ERL_NIF_TERM
+set_dot_workers(ErlNifEnv* env, int32_t argc, const ERL_NIF_TERM *argv) {
+  uint32_t workers;
+
+  UNUSED_VAR(argc);
+
+  if (!enif_get_uint(env, argv[0], &workers)) return enif_make_badarg(env);
+
+  matrix_gemm_set_max_workers(workers);
+
+  return enif_make_atom(env, "ok");
+}
+
 static ERL_NIF_TERM
 submatrix(ErlNifEnv* env, int32_t argc, const ERL_NIF_TERM *argv) {
   ErlNifBinary  matrix;
@@ -1080,6 +1284,8 @@ submatrix(ErlNifEnv* env, int32_t argc, const ERL_NIF_TERM *argv) {
     return enif_raise_exception(env, enif_make_string(env,
       "Submatrix position out of bounds.", ERL_NIF_LATIN1));
 
+  SCHEDULE_DIRTY_IF_LARGE(submatrix, (row_to - row_from + 1) * (column_to - column_from + 1));
+
 
   result_size = ((row_to - row_from + 1) * (column_to - column_from + 1) + 2) * MX_ELEMENT_SIZE;
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
@@ -1105,9 +1311,11 @@ subtract(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   first_data  = (float *) first.data;
   second_data = (float *) second.data;
 
-  ASSERT_SIZES_MATCH(first_data, second_data);
+  ASSERT_SIZES_BROADCAST(first_data, second_data);
 
-  data_size   = MX_LENGTH(first_data);
+  data_size   = matrix_broadcast_length(first_data, second_data);
+
+  SCHEDULE_DIRTY_IF_LARGE(subtract, data_size);
 
   result_size = sizeof(float) * data_size;
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
@@ -1132,6 +1340,9 @@ subtract_from_scalar(ErlNifEnv *env, int argc, const ERL_NIF_TERM *argv) {
   scalar = get_scalar(env, argv[0]);
 
   matrix_data = (float *) matrix.data;
+
+  SCHEDULE_DIRTY_IF_LARGE(subtract_from_scalar, MX_LENGTH(matrix_data));
+
   data_size   = MX_LENGTH(matrix_data);
 
   result_size = sizeof(float) * data_size;
@@ -1145,18 +1356,24 @@ subtract_from_scalar(ErlNifEnv *env, int argc, const ERL_NIF_TERM *argv) {
 static ERL_NIF_TERM
 sum(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   ErlNifBinary  matrix;
-  double         sum;
+  double         sum_value;
   float        *matrix_data;
-
-  (void)(argc);
+  char          mode[16] = "pairwise";
 
   if (!enif_inspect_binary(env, argv[0], &matrix)) return enif_make_badarg(env);
+  if (argc > 1 && !enif_get_atom(env, argv[1], mode, 16, ERL_NIF_LATIN1)) return enif_make_badarg(env);
+  if (strcmp(mode, "pairwise") != 0 && strcmp(mode, "kahan") != 0) return enif_make_badarg(env);
 
   matrix_data = (float *) matrix.data;
 
-  sum = matrix_sum(matrix_data);
+  SCHEDULE_DIRTY_IF_LARGE(sum, MX_LENGTH(matrix_data));
+
+  if (strcmp(mode, "kahan") == 0)
+    sum_value = matrix_sum_kahan(matrix_data);
+  else
+    sum_value = matrix_sum(matrix_data);
 
-  return make_cell_value(env, sum);
+  return make_cell_value(env, sum_value);
 }
 
 static ERL_NIF_TERM
@@ -1175,6 +1392,8 @@ to_list(ErlNifEnv* env, int32_t argc, const ERL_NIF_TERM *argv) {
   rows = MX_ROWS(matrix_data);
   cols = MX_COLS(matrix_data);
 
+  SCHEDULE_DIRTY_IF_LARGE(to_list, MX_LENGTH(matrix_data));
+
   result = enif_make_list(env, 0);
   for (uint64_t i = rows*cols + 2; i-- > 2; ) {
     result = enif_make_list_cell(env, make_cell_value(env, matrix_data[i]), result);
@@ -1183,6 +1402,34 @@ to_list(ErlNifEnv* env, int32_t argc, const ERL_NIF_TERM *argv) {
   return result;
 }
 
+// Returns `length` elements starting from flat `offset` as a list.
+static ERL_NIF_TERM
+chunk_to_list(ErlNifEnv* env, int32_t argc, const ERL_NIF_TERM *argv) {
+  ErlNifBinary  matrix;
+  ErlNifUInt64  offset, length;
+  float        *matrix_data;
+  ERL_NIF_TERM  result;
+
+  UNUSED_VAR(argc);
+
+  if (!enif_inspect_binary(env, argv[0], &matrix)) return enif_make_badarg(env);
+  if (!enif_get_uint64(env, argv[1], &offset)) return enif_make_badarg(env);
+  if (!enif_get_uint64(env, argv[2], &length)) return enif_make_badarg(env);
+
+  matrix_data = (float *) matrix.data;
+
+  if (offset + length > (uint64_t) MX_ROWS(matrix_data)*MX_COLS(matrix_data)) return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(chunk_to_list, length);
+
+  result = enif_make_list(env, 0);
+  for (uint64_t i = offset + length + 2; i-- > offset + 2; ) {
+    result = enif_make_list_cell(env, make_cell_value(env, matrix_data[i]), result);
+  }
+
+  return result;
+}
+
 static ERL_NIF_TERM
 to_list_of_lists(ErlNifEnv* env, int32_t argc, const ERL_NIF_TERM *argv) {
   /* to_list_of_lists(matrix) -> [[first row], [second row], ...,[last row]] */
@@ -1199,6 +1446,8 @@ to_list_of_lists(ErlNifEnv* env, int32_t argc, const ERL_NIF_TERM *argv) {
   rows = MX_ROWS(matrix_data);
   cols = MX_COLS(matrix_data);
 
+  SCHEDULE_DIRTY_IF_LARGE(to_list_of_lists, MX_LENGTH(matrix_data));
+
   result = enif_make_list(env, 0);
 
   for (uint32_t r = rows; r-- > 0; ) {
@@ -1225,6 +1474,9 @@ transpose(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   if (!enif_inspect_binary(env, argv[0], &matrix)) return enif_make_badarg(env);
 
   matrix_data = (float *) matrix.data;
+
+  SCHEDULE_DIRTY_IF_LARGE(transpose, MX_LENGTH(matrix_data));
+
   data_size   = MX_LENGTH(matrix_data);
 
   result_size = sizeof(float) * data_size;
@@ -1247,6 +1499,8 @@ zeros(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   enif_get_int64(env, argv[0], &rows);
   enif_get_int64(env, argv[1], &cols);
 
+  SCHEDULE_DIRTY_IF_LARGE(zeros, rows*cols);
+
   result_size = (rows*cols + 2) * sizeof(float);
   result_data = (float *) enif_make_new_binary(env, result_size, &result);
 
@@ -1258,75 +1512,1622 @@ zeros(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
   return result;
 }
 
-static ErlNifFunc nif_functions[] = {
-  {"add",                  4, add,                  0},
-  {"add_scalar",           2, add_scalar,           0},
-  {"apply_math",           2, apply_math,           0},
-  {"apply_parallel_math",  2, apply_parallel_math,  0},
-  {"argmax",               1, argmax,               0},
-  {"column_to_list",       2, column_to_list,       0},
-  {"concat_columns",       2, concat_columns,       0},
-  {"power",                2, power,                0},
-  {"divide",               2, divide,               0},
-  {"divide_scalar",        2, divide_scalar,        0},
-  {"divide_by_scalar",     2, divide_by_scalar,     0},
-  {"dot",                  2, dot,                  0},
-  {"dot_and_add",          3, dot_and_add,          0},
-  {"dot_and_apply",        3, dot_and_apply,        0},
-  {"dot_nt",               2, dot_nt,               0},
-  {"dot_tn",               3, dot_tn,               0},
-  {"cholesky",             1, cholesky,             0},
-  {"forward_substitute",                2, forward_substitute,                0},
-  {"eye",                  2, eye,                  0},
-  {"diagonal",             1, diagonal,             0},
-  {"fill",                 3, fill,                 0},
-  {"find",                 2, find,                 0},
-  {"from_range",           4, from_range,           0},
-  {"max",                  1, max,                  0},
-  {"min",                  1, minimum,              0},
-  {"max_finite",           1, max_finite,           0},
-  {"min_finite",           1, min_finite,           0},
-  {"multiply",             2, multiply,             0},
-  {"multiply_with_scalar", 2, multiply_with_scalar, 0},
-  {"neg",                  1, neg,                  0},
-  {"normalize",            1, normalize,            0},
-  {"random",               2, random_matrix,        0},
-  {"resize",               2, resize,               0},
-  {"row_to_list",          2, row_to_list,          0},
-  {"set",                  4, set,                  0},
-  {"set_column",           3, set_column,           0},
-  {"submatrix",            5, submatrix,            0},
-  {"subtract",             2, subtract,             0},
-  {"subtract_from_scalar", 2, subtract_from_scalar, 0},
-  {"sum",                  1, sum,                  0},
-  {"to_list",              1, to_list,              0},
-  {"to_list_of_lists",     1, to_list_of_lists,     0},
-  {"transpose",            1, transpose,            0},
-  {"zeros",                2, zeros,                0}
-};
+//-----------------------------------------------------------------------------
+// Mutable matrices
+//-----------------------------------------------------------------------------
 
-// Solely to silence coveralls.travis task errors on Travis CI
-int
-upgrade(ErlNifEnv* env, void** priv_data, void** old_priv_data, ERL_NIF_TERM load_info) {
-  // Silence "unused var" warnings.
-  (void)(env);
-  (void)(priv_data);
-  (void)(old_priv_data);
-  (void)(load_info);
-  return 0;
+// Resource memory holds a whole matrix, header included, so it's used as Matrix directly.
+// Writes are not synchronized: processes sharing a mutable matrix must order them themselves.
+static ErlNifResourceType *mutable_matrix_type;
+
+// Matrix file mapped into memory. Read-only mappings are shared with the page cache and
+// handed out as resource binaries, copy-on-write ones are private and used as mutable matrices.
+typedef struct {
+  void   *data;
+  size_t  size;
+  int     writable;
+} MappedFile;
+
+static ErlNifResourceType *mapped_file_type;
+
+static void
+mapped_file_destructor(ErlNifEnv *env, void *resource) {
+  MappedFile *file = (MappedFile *) resource;
+
+  UNUSED_VAR(env);
+
+  if (file->data != NULL) munmap(file->data, file->size);
 }
 
-// Used for RNG initialization.
-int
-load(ErlNifEnv* env, void** priv_data, ERL_NIF_TERM load_info) {
-  // Silence "unused var" warnings.
-  (void)(env);
-  (void)(priv_data);
-  (void)(load_info);
+// Reads matrix data from either a binary or a mutable matrix resource.
+static int
+get_matrix(ErlNifEnv *env, ERL_NIF_TERM term, Matrix *matrix) {
+  ErlNifBinary  binary;
+  void         *resource;
 
-  srandom(time(NULL) + clock());
+  if (enif_get_resource(env, term, mutable_matrix_type, &resource)) {
+    *matrix = (Matrix) resource;
+    return 1;
+  }
+
+  if (enif_get_resource(env, term, mapped_file_type, &resource)) {
+    *matrix = (Matrix) ((MappedFile *) resource)->data;
+    return 1;
+  }
+
+  if (enif_inspect_binary(env, term, &binary)) {
+    *matrix = (Matrix) binary.data;
+    return 1;
+  }
 
   return 0;
 }
 
-ERL_NIF_INIT(Elixir.Matrex.NIFs, nif_functions, load, NULL, upgrade, NULL)
+static int
+get_mutable_matrix(ErlNifEnv *env, ERL_NIF_TERM term, Matrix *matrix) {
+  void *resource;
+
+  if (enif_get_resource(env, term, mutable_matrix_type, &resource)) {
+    *matrix = (Matrix) resource;
+    return 1;
+  }
+
+  if (enif_get_resource(env, term, mapped_file_type, &resource) && ((MappedFile *) resource)->writable) {
+    *matrix = (Matrix) ((MappedFile *) resource)->data;
+    return 1;
+  }
+
+  return 0;
+}
+
+static ERL_NIF_TERM
+mutable_new(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  ErlNifBinary  matrix;
+  ERL_NIF_TERM  result;
+  float        *result_data;
+
+  UNUSED_VAR(argc);
+
+  if (!enif_inspect_binary(env, argv[0], &matrix)) return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(mutable_new, matrix.size / sizeof(float));
+
+  result_data = (float *) enif_alloc_resource(mutable_matrix_type, matrix.size);
+  if (result_data == NULL)
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
+
+  memcpy(result_data, matrix.data, matrix.size);
+
+  result = enif_make_resource(env, result_data);
+  enif_release_resource(result_data);
+
+  return result;
+}
+
+static ERL_NIF_TERM
+mutable_to_binary(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  ERL_NIF_TERM  result;
+  float        *matrix_data, *result_data;
+  size_t        result_size;
+
+  UNUSED_VAR(argc);
+
+  if (!get_mutable_matrix(env, argv[0], &matrix_data)) return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(mutable_to_binary, MX_LENGTH(matrix_data));
+
+  result_size = sizeof(float) * MX_LENGTH(matrix_data);
+  result_data = (float *) enif_make_new_binary(env, result_size, &result);
+
+  memcpy(result_data, matrix_data, result_size);
+
+  return result;
+}
+
+static ERL_NIF_TERM
+mutable_size(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  float *matrix_data;
+
+  UNUSED_VAR(argc);
+
+  if (!get_mutable_matrix(env, argv[0], &matrix_data)) return enif_make_badarg(env);
+
+  return enif_make_tuple2(
+    env, enif_make_uint(env, MX_ROWS(matrix_data)), enif_make_uint(env, MX_COLS(matrix_data))
+  );
+}
+
+static ERL_NIF_TERM
+mutable_add(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  float *result_data, *first_data, *second_data;
+  float  alpha, beta;
+
+  UNUSED_VAR(argc);
+
+  if (!get_mutable_matrix(env, argv[0], &result_data)) return enif_make_badarg(env);
+  if (!get_matrix(env, argv[1], &first_data)) return enif_make_badarg(env);
+  if (!get_matrix(env, argv[2], &second_data)) return enif_make_badarg(env);
+  alpha = get_scalar(env, argv[3]);
+  beta = get_scalar(env, argv[4]);
+
+  ASSERT_SIZES_MATCH(first_data, second_data);
+  ASSERT_SIZES_MATCH(first_data, result_data);
+
+  SCHEDULE_DIRTY_IF_LARGE(mutable_add, MX_LENGTH(first_data));
+
+  matrix_add(first_data, second_data, alpha, beta, result_data);
+
+  return enif_make_atom(env, "ok");
+}
+
+static ERL_NIF_TERM
+mutable_multiply(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  float *result_data, *first_data, *second_data;
+
+  UNUSED_VAR(argc);
+
+  if (!get_mutable_matrix(env, argv[0], &result_data)) return enif_make_badarg(env);
+  if (!get_matrix(env, argv[1], &first_data)) return enif_make_badarg(env);
+  if (!get_matrix(env, argv[2], &second_data)) return enif_make_badarg(env);
+
+  ASSERT_SIZES_MATCH(first_data, second_data);
+  ASSERT_SIZES_MATCH(first_data, result_data);
+
+  SCHEDULE_DIRTY_IF_LARGE(mutable_multiply, MX_LENGTH(first_data));
+
+  matrix_multiply(first_data, second_data, result_data);
+
+  return enif_make_atom(env, "ok");
+}
+
+static ERL_NIF_TERM
+mutable_dot(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  float *result_data, *first_data, *second_data;
+  float  alpha;
+
+  UNUSED_VAR(argc);
+
+  if (!get_mutable_matrix(env, argv[0], &result_data)) return enif_make_badarg(env);
+  if (!get_matrix(env, argv[1], &first_data)) return enif_make_badarg(env);
+  if (!get_matrix(env, argv[2], &second_data)) return enif_make_badarg(env);
+  alpha = get_scalar(env, argv[3]);
+
+  if (MX_COLS(first_data) != MX_ROWS(second_data) ||
+      MX_ROWS(result_data) != MX_ROWS(first_data) || MX_COLS(result_data) != MX_COLS(second_data))
+    return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
+
+  // Product is written while operands are still being read.
+  if (result_data == first_data || result_data == second_data)
+    return enif_raise_exception(
+      env, enif_make_string(env, "Destination matrix must differ from operands.", ERL_NIF_LATIN1)
+    );
+
+  SCHEDULE_DIRTY_IF_LARGE(
+    mutable_dot, DOT_WORK(MX_ROWS(first_data), MX_COLS(first_data), MX_COLS(second_data))
+  );
+
+  if (!matrix_dot(alpha, first_data, second_data, result_data))
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
+
+  return enif_make_atom(env, "ok");
+}
+
+static ERL_NIF_TERM
+mutable_transpose(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  float *result_data, *matrix_data;
+
+  UNUSED_VAR(argc);
+
+  if (!get_mutable_matrix(env, argv[0], &result_data)) return enif_make_badarg(env);
+  if (!get_matrix(env, argv[1], &matrix_data)) return enif_make_badarg(env);
+
+  if (MX_ROWS(result_data) != MX_COLS(matrix_data) || MX_COLS(result_data) != MX_ROWS(matrix_data))
+    return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
+
+  SCHEDULE_DIRTY_IF_LARGE(mutable_transpose, MX_LENGTH(matrix_data));
+
+  // Only square matrices can be their own transposition.
+  if (result_data == matrix_data)
+    matrix_transpose_in_place(result_data);
+  else
+    matrix_transpose(matrix_data, result_data);
+
+  return enif_make_atom(env, "ok");
+}
+
+static ERL_NIF_TERM
+mutable_apply(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  char   function_name[16];
+  float *result_data, *matrix_data;
+
+  UNUSED_VAR(argc);
+
+  if (!get_mutable_matrix(env, argv[0], &result_data)) return enif_make_badarg(env);
+  if (!get_matrix(env, argv[1], &matrix_data)) return enif_make_badarg(env);
+  if (enif_get_atom(env, argv[2], function_name, 16, ERL_NIF_LATIN1) == 0)
+    return enif_raise_exception(env, enif_make_string(env, "Third argument must be an atom.", ERL_NIF_LATIN1));
+
+  ASSERT_SIZES_MATCH(matrix_data, result_data);
+
+  SCHEDULE_DIRTY_IF_LARGE(mutable_apply, MX_LENGTH(matrix_data));
+
+  if (matrix_apply_parallel(matrix_data, function_name, result_data) == 1)
+    return enif_make_atom(env, "ok");
+  else
+    return enif_make_badarg(env);
+}
+
+//-----------------------------------------------------------------------------
+// Concatenation
+//-----------------------------------------------------------------------------
+
+// Concatenates a list of matrices along :rows or :columns into one, allocated at once.
+// Returns badarg, if their sizes don't fit.
+static ERL_NIF_TERM
+concat(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  char          axis[16];
+  ERL_NIF_TERM  list, head, result;
+  Matrix        first, matrix, *matrices;
+  unsigned      count, index;
+  uint64_t      rows = 0, cols = 0;
+  int           along_rows;
+  float        *result_data;
+
+  UNUSED_VAR(argc);
+
+  if (!enif_get_atom(env, argv[1], axis, 16, ERL_NIF_LATIN1)) return enif_make_badarg(env);
+  if (strcmp(axis, "rows") != 0 && strcmp(axis, "columns") != 0) return enif_make_badarg(env);
+  if (!enif_get_list_length(env, argv[0], &count) || count == 0) return enif_make_badarg(env);
+
+  along_rows = strcmp(axis, "rows") == 0;
+
+  enif_get_list_cell(env, argv[0], &head, &list);
+  if (!get_matrix(env, head, &first)) return enif_make_badarg(env);
+
+  for (list = argv[0]; enif_get_list_cell(env, list, &head, &list);) {
+    if (!get_matrix(env, head, &matrix)) return enif_make_badarg(env);
+    if (along_rows ? MX_COLS(matrix) != MX_COLS(first) : MX_ROWS(matrix) != MX_ROWS(first))
+      return enif_make_badarg(env);
+
+    rows += MX_ROWS(matrix);
+    cols += MX_COLS(matrix);
+  }
+
+  if (along_rows) cols = MX_COLS(first); else rows = MX_ROWS(first);
+  if (rows > UINT32_MAX || cols > UINT32_MAX) return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(concat, rows*cols);
+
+  matrices = (Matrix *) enif_alloc(count*sizeof(Matrix));
+  if (matrices == NULL)
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
+
+  for (list = argv[0], index = 0; enif_get_list_cell(env, list, &head, &list); index++) {
+    get_matrix(env, head, &matrices[index]);
+  }
+
+  result_data = (float *) enif_make_new_binary(env, (rows*cols + 2)*sizeof(float), &result);
+  matrix_concat(matrices, count, along_rows, result_data);
+  enif_free(matrices);
+
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+// Building from lists
+//-----------------------------------------------------------------------------
+
+// Elements filled between checks of the timeslice.
+#define LIST_FILL_BATCH 4096
+
+// Matrix being filled from a list of rows or a flat list of elements. Filling yields,
+// when the timeslice is used up, and the rescheduled NIF continues from where it stopped.
+typedef struct {
+  ErlNifBinary  binary;
+  uint64_t      length;     // rows*cols
+  uint64_t      filled;     // elements written so far
+  uint32_t      rows;
+  uint32_t      cols;
+  uint32_t      rows_read;
+  uint32_t      row_filled; // elements of the current row written so far
+  int           nested;     // whether the list is a list of rows
+  int           released;   // whether the binary is handed out as the result
+} ListFill;
+
+static ErlNifResourceType *list_fill_type;
+
+static void
+list_fill_destructor(ErlNifEnv *env, void *resource) {
+  ListFill *fill = (ListFill *) resource;
+
+  UNUSED_VAR(env);
+
+  if (!fill->released) enif_release_binary(&fill->binary);
+}
+
+// Reads list element: a number or :nan, :inf or :neg_inf atom.
+static int
+get_element(ErlNifEnv *env, ERL_NIF_TERM term, float *element) {
+  double        number;
+  ErlNifSInt64  integer;
+  char          atom[8];
+
+  if (enif_get_double(env, term, &number)) {
+    *element = (float) number;
+  } else if (enif_get_int64(env, term, &integer)) {
+    *element = (float) (double) integer;
+  } else if (enif_get_atom(env, term, atom, sizeof(atom), ERL_NIF_LATIN1)) {
+    // NaN is the negative quiet one, which Matrex reads as :nan.
+    if (strcmp(atom, "nan") == 0) *element = -NAN;
+    else if (strcmp(atom, "inf") == 0) *element = INFINITY;
+    else if (strcmp(atom, "neg_inf") == 0) *element = -INFINITY;
+    else return 0;
+  } else {
+    return 0;
+  }
+
+  return 1;
+}
+
+// Takes the fill resource, the rows left and the elements of the current row left.
+static ERL_NIF_TERM
+fill_from_list(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  ListFill     *fill;
+  ERL_NIF_TERM  rows = argv[1], row = argv[2], head, result, next_argv[3];
+  float        *data;
+  ErlNifTime    start = enif_monotonic_time(ERL_NIF_USEC);
+  uint32_t      batch = 0;
+  int           percent;
+
+  UNUSED_VAR(argc);
+
+  if (!enif_get_resource(env, argv[0], list_fill_type, (void **) &fill)) return enif_make_badarg(env);
+
+  data = (float *) fill->binary.data;
+
+  while (1) {
+    if (enif_get_list_cell(env, row, &head, &row)) {
+      if (fill->filled == fill->length) return enif_make_badarg(env);
+      if (fill->nested && fill->row_filled == fill->cols) return enif_make_badarg(env);
+      if (!get_element(env, head, &data[2 + fill->filled])) return enif_make_badarg(env);
+
+      fill->filled += 1;
+      fill->row_filled += 1;
+    } else {
+      if (!enif_is_empty_list(env, row)) return enif_make_badarg(env);
+      if (fill->nested && fill->rows_read > 0 && fill->row_filled != fill->cols) return enif_make_badarg(env);
+      if (!enif_get_list_cell(env, rows, &row, &rows)) break;
+
+      fill->rows_read += 1;
+      fill->row_filled = 0;
+    }
+
+    if (++batch == LIST_FILL_BATCH) {
+      percent = (int) ((enif_monotonic_time(ERL_NIF_USEC) - start)/10);
+
+      if (enif_consume_timeslice(env, percent < 1 ? 1 : (percent > 100 ? 100 : percent))) {
+        next_argv[0] = argv[0];
+        next_argv[1] = rows;
+        next_argv[2] = row;
+
+        return enif_schedule_nif(env, "from_list", 0, fill_from_list, 3, next_argv);
+      }
+
+      start = enif_monotonic_time(ERL_NIF_USEC);
+      batch = 0;
+    }
+  }
+
+  if (!enif_is_empty_list(env, rows) || fill->filled != fill->length) return enif_make_badarg(env);
+  if (fill->nested && fill->rows_read != fill->rows) return enif_make_badarg(env);
+
+  result = enif_make_binary(env, &fill->binary);
+  fill->released = 1;
+
+  return result;
+}
+
+// Writes a list of elements into mutable matrix starting from flat `offset`.
+static ERL_NIF_TERM
+mutable_write_list(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  ERL_NIF_TERM  list, head;
+  ErlNifUInt64  offset;
+  unsigned      length;
+  float        *matrix_data;
+
+  UNUSED_VAR(argc);
+
+  if (!get_mutable_matrix(env, argv[0], &matrix_data)) return enif_make_badarg(env);
+  if (!enif_get_uint64(env, argv[1], &offset)) return enif_make_badarg(env);
+  if (!enif_get_list_length(env, argv[2], &length)) return enif_make_badarg(env);
+  if (offset + length > (uint64_t) MX_ROWS(matrix_data)*MX_COLS(matrix_data)) return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(mutable_write_list, length);
+
+  for (list = argv[2]; enif_get_list_cell(env, list, &head, &list); offset++) {
+    if (!get_element(env, head, &matrix_data[2 + offset])) return enif_make_badarg(env);
+  }
+
+  return enif_make_atom(env, "ok");
+}
+
+// Creates matrix of `rows`×`cols` from either a list of rows or a flat list of elements
+// without building it in Erlang, yielding on huge lists. Returns badarg, if they don't fit the size.
+static ERL_NIF_TERM
+from_list(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  ListFill     *fill;
+  ERL_NIF_TERM  head, tail, fill_argv[3];
+  uint32_t      rows, cols;
+
+  UNUSED_VAR(argc);
+
+  if (!enif_get_uint(env, argv[1], &rows)) return enif_make_badarg(env);
+  if (!enif_get_uint(env, argv[2], &cols)) return enif_make_badarg(env);
+  if (!enif_is_list(env, argv[0])) return enif_make_badarg(env);
+
+  fill = (ListFill *) enif_alloc_resource(list_fill_type, sizeof(ListFill));
+  memset(fill, 0, sizeof(ListFill));
+
+  fill->released = 1;
+  fill->rows = rows;
+  fill->cols = cols;
+  fill->length = (uint64_t) rows*cols;
+  fill->nested = enif_get_list_cell(env, argv[0], &head, &tail) && enif_is_list(env, head);
+
+  if (!enif_alloc_binary((fill->length + 2)*sizeof(float), &fill->binary)) {
+    enif_release_resource(fill);
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
+  }
+
+  fill->released = 0;
+  MX_SET_ROWS((float *) fill->binary.data, rows);
+  MX_SET_COLS((float *) fill->binary.data, cols);
+
+  fill_argv[0] = enif_make_resource(env, fill);
+  fill_argv[1] = fill->nested ? argv[0] : enif_make_list(env, 0);
+  fill_argv[2] = fill->nested ? enif_make_list(env, 0) : argv[0];
+  enif_release_resource(fill);
+
+  return fill_from_list(env, 3, fill_argv);
+}
+
+//-----------------------------------------------------------------------------
+// Memory mapped files
+//-----------------------------------------------------------------------------
+
+static ERL_NIF_TERM
+raise_file_error(ErlNifEnv *env, const char *action, const char *path) {
+  char message[PATH_MAX + 128];
+
+  snprintf(message, sizeof(message), "Failed to %s %s: %s.", action, path, strerror(errno));
+  return enif_raise_exception(env, enif_make_string(env, message, ERL_NIF_LATIN1));
+}
+
+static int
+typed_matrix_file(const void *data, const size_t size) {
+  return size >= MX_TYPED_HEADER_SIZE && ((const uint32_t *) data)[3] == MX_TYPED_MAGIC;
+}
+
+// Checks that mapped bytes are a whole float or typed matrix, as Matrex.save/2 writes them.
+static int
+valid_matrix_file(const void *data, const size_t size) {
+  const uint32_t *header = (const uint32_t *) data;
+
+  if (typed_matrix_file(data, size)) return matrix_typed_valid(data, size);
+
+  return size >= 2*sizeof(float) && (size - 2*sizeof(float)) % sizeof(float) == 0 &&
+    (uint64_t) header[0]*header[1] == (size - 2*sizeof(float))/sizeof(float);
+}
+
+// Maps .mtx file into memory: `:read_only` one is shared and returned as a binary,
+// which Matrex functions read as any other, `:copy_on_write` one is private and
+// returned as a mutable matrix resource, which writes never reach the file.
+static ERL_NIF_TERM
+mmap_file(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  ErlNifBinary  path_binary;
+  MappedFile   *file;
+  ERL_NIF_TERM  result;
+  struct stat   file_stat;
+  char          path[PATH_MAX], mode[16];
+  void         *data;
+  int           fd, writable;
+
+  UNUSED_VAR(argc);
+
+  if (!enif_inspect_binary(env, argv[0], &path_binary) || path_binary.size >= PATH_MAX ||
+      !enif_get_atom(env, argv[1], mode, sizeof(mode), ERL_NIF_LATIN1))
+    return enif_make_badarg(env);
+
+  if (strcmp(mode, "read_only") == 0) writable = 0;
+  else if (strcmp(mode, "copy_on_write") == 0) writable = 1;
+  else return enif_make_badarg(env);
+
+  memcpy(path, path_binary.data, path_binary.size);
+  path[path_binary.size] = '\0';
+
+  fd = open(path, O_RDONLY);
+  if (fd < 0) return raise_file_error(env, "open", path);
+
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    return raise_file_error(env, "read", path);
+  }
+
+  if (file_stat.st_size < (off_t) (2*sizeof(float))) {
+    close(fd);
+    return enif_raise_exception(env, enif_make_string(env, "Invalid matrix file.", ERL_NIF_LATIN1));
+  }
+
+  // The mapping outlives the descriptor, so it's closed right away.
+  data = mmap(
+    NULL, file_stat.st_size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+    writable ? MAP_PRIVATE : MAP_SHARED, fd, 0
+  );
+  close(fd);
+  if (data == MAP_FAILED) return raise_file_error(env, "map", path);
+
+  file = (MappedFile *) enif_alloc_resource(mapped_file_type, sizeof(MappedFile));
+  if (file == NULL) {
+    munmap(data, file_stat.st_size);
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
+  }
+
+  file->data = data;
+  file->size = file_stat.st_size;
+  file->writable = writable;
+
+  // Mutable matrices are float ones, so typed matrix files are mapped read-only only.
+  if (!valid_matrix_file(data, file->size) || (writable && typed_matrix_file(data, file->size))) {
+    enif_release_resource(file);
+    return enif_raise_exception(env, enif_make_string(env, "Invalid matrix file.", ERL_NIF_LATIN1));
+  }
+
+  if (writable)
+    result = enif_make_resource(env, file);
+  else
+    result = enif_make_resource_binary(env, file, data, file->size);
+
+  enif_release_resource(file);
+
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+// CSV reading and writing
+//-----------------------------------------------------------------------------
+
+// Reader of matrix text, fed chunk by chunk. Read matrix is handed out as a binary,
+// which keeps the reader alive and which must not change after that.
+typedef struct {
+  CsvReader reader;
+  int       finished;
+} CsvReaderResource;
+
+static ErlNifResourceType *csv_reader_type;
+
+static void
+csv_reader_destructor(ErlNifEnv *env, void *resource) {
+  UNUSED_VAR(env);
+
+  matrix_csv_reader_free(&((CsvReaderResource *) resource)->reader);
+}
+
+static ERL_NIF_TERM
+csv_error(ErlNifEnv *env, const CsvReader *reader) {
+  ERL_NIF_TERM  message;
+  char          text[CSV_TOKEN_MAX + 64];
+  size_t        length;
+
+  switch (reader->error) {
+    case CSV_INVALID_ELEMENT:
+      snprintf(text, sizeof(text), "Unparseable matrix element value: %s", reader->token);
+      break;
+    case CSV_RAGGED_ROWS:
+      snprintf(text, sizeof(text), "Matrix rows have different lengths.");
+      break;
+    case CSV_TOO_LARGE:
+      snprintf(text, sizeof(text), "Matrix is too large.");
+      break;
+    case CSV_OUT_OF_MEMORY:
+      snprintf(text, sizeof(text), "Out of memory.");
+      break;
+    default:
+      snprintf(text, sizeof(text), "Matrix has no elements.");
+  }
+
+  length = strlen(text);
+  memcpy(enif_make_new_binary(env, length, &message), text, length);
+
+  return enif_make_tuple2(env, enif_make_atom(env, "error"), message);
+}
+
+static ERL_NIF_TERM
+csv_reader_new(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  CsvReaderResource *resource;
+  ERL_NIF_TERM       result;
+
+  UNUSED_VAR(argc);
+  UNUSED_VAR(argv);
+
+  resource = (CsvReaderResource *) enif_alloc_resource(csv_reader_type, sizeof(CsvReaderResource));
+  if (resource == NULL)
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
+
+  matrix_csv_reader_init(&resource->reader);
+  resource->finished = 0;
+
+  result = enif_make_resource(env, resource);
+  enif_release_resource(resource);
+
+  return result;
+}
+
+static ERL_NIF_TERM
+csv_read(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  CsvReaderResource *resource;
+  ErlNifBinary       chunk;
+
+  UNUSED_VAR(argc);
+
+  if (!enif_get_resource(env, argv[0], csv_reader_type, (void **) &resource) || resource->finished ||
+      !enif_inspect_binary(env, argv[1], &chunk))
+    return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(csv_read, chunk.size);
+
+  if (!matrix_csv_read(&resource->reader, (const char *) chunk.data, chunk.size))
+    return csv_error(env, &resource->reader);
+
+  return enif_make_atom(env, "ok");
+}
+
+static ERL_NIF_TERM
+csv_finish(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  CsvReaderResource *resource;
+  Matrix             matrix;
+
+  UNUSED_VAR(argc);
+
+  if (!enif_get_resource(env, argv[0], csv_reader_type, (void **) &resource) || resource->finished)
+    return enif_make_badarg(env);
+
+  matrix = matrix_csv_finish(&resource->reader);
+  if (matrix == NULL) return csv_error(env, &resource->reader);
+
+  resource->finished = 1;
+
+  return enif_make_resource_binary(env, resource, matrix, sizeof(float) * MX_LENGTH(matrix));
+}
+
+// Formats `rows` rows of the matrix, starting from `from_row`, as comma separated lines.
+static ERL_NIF_TERM
+csv_write(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  ErlNifBinary  result;
+  Matrix        matrix;
+  uint32_t      from_row, rows;
+  uint64_t      length;
+
+  UNUSED_VAR(argc);
+
+  if (!get_matrix(env, argv[0], &matrix) ||
+      !enif_get_uint(env, argv[1], &from_row) || !enif_get_uint(env, argv[2], &rows) ||
+      (uint64_t) from_row + rows > MX_ROWS(matrix))
+    return enif_make_badarg(env);
+
+  // Formatting an element takes about as long as touching a dozen of them.
+  SCHEDULE_DIRTY_IF_LARGE(csv_write, (uint64_t) rows*MX_COLS(matrix)*CSV_ELEMENT_MAX);
+
+  if (!enif_alloc_binary((uint64_t) rows*(MX_COLS(matrix)*CSV_ELEMENT_MAX + 1), &result))
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
+
+  length = matrix_csv_write(matrix, from_row, rows, (char *) result.data);
+  enif_realloc_binary(&result, length);
+
+  return enif_make_binary(env, &result);
+}
+
+//-----------------------------------------------------------------------------
+// Streamed matrix files
+//-----------------------------------------------------------------------------
+
+// Matrix file fed chunk by chunk, e.g. as it's inflated. As CSV reader, it's alive,
+// while the binary with the matrix, which it hands out, is.
+typedef struct {
+  MatrixStream stream;
+  int          finished;
+} StreamResource;
+
+static ErlNifResourceType *stream_type;
+
+static void
+stream_destructor(ErlNifEnv *env, void *resource) {
+  UNUSED_VAR(env);
+
+  matrix_stream_free(&((StreamResource *) resource)->stream);
+}
+
+static ERL_NIF_TERM
+raise_invalid_file(ErlNifEnv *env) {
+  return enif_raise_exception(env, enif_make_string(env, "Invalid matrix file.", ERL_NIF_LATIN1));
+}
+
+// Takes format, :mtx or :idx, and whether to convert IDX integers to floats and to normalize them.
+static ERL_NIF_TERM
+stream_new(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  StreamResource *resource;
+  ERL_NIF_TERM    result;
+  char            format[4], to_float[6], normalize[6];
+
+  UNUSED_VAR(argc);
+
+  if (!enif_get_atom(env, argv[0], format, sizeof(format), ERL_NIF_LATIN1) ||
+      (strcmp(format, "mtx") != 0 && strcmp(format, "idx") != 0) ||
+      !enif_get_atom(env, argv[1], to_float, sizeof(to_float), ERL_NIF_LATIN1) ||
+      !enif_get_atom(env, argv[2], normalize, sizeof(normalize), ERL_NIF_LATIN1))
+    return enif_make_badarg(env);
+
+  resource = (StreamResource *) enif_alloc_resource(stream_type, sizeof(StreamResource));
+  if (resource == NULL)
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
+
+  matrix_stream_init(
+    &resource->stream, strcmp(format, "mtx") == 0 ? STREAM_MTX : STREAM_IDX,
+    strcmp(to_float, "true") == 0, strcmp(normalize, "true") == 0
+  );
+  resource->finished = 0;
+
+  result = enif_make_resource(env, resource);
+  enif_release_resource(resource);
+
+  return result;
+}
+
+static ERL_NIF_TERM
+stream_write(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  StreamResource *resource;
+  ErlNifBinary    chunk;
+
+  UNUSED_VAR(argc);
+
+  if (!enif_get_resource(env, argv[0], stream_type, (void **) &resource) || resource->finished ||
+      !enif_inspect_binary(env, argv[1], &chunk))
+    return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(stream_write, chunk.size);
+
+  if (!matrix_stream_write(&resource->stream, chunk.data, chunk.size)) return raise_invalid_file(env);
+
+  return enif_make_atom(env, "ok");
+}
+
+static ERL_NIF_TERM
+stream_finish(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  StreamResource *resource;
+  uint64_t        size;
+  void           *matrix;
+
+  UNUSED_VAR(argc);
+
+  if (!enif_get_resource(env, argv[0], stream_type, (void **) &resource) || resource->finished)
+    return enif_make_badarg(env);
+
+  // Normalization is one more pass over the whole matrix.
+  SCHEDULE_DIRTY_IF_LARGE(stream_finish, resource->stream.normalize ? resource->stream.result_size : 0);
+
+  matrix = matrix_stream_finish(&resource->stream, &size);
+  if (matrix == NULL) return raise_invalid_file(env);
+
+  resource->finished = 1;
+
+  return enif_make_resource_binary(env, resource, matrix, size);
+}
+
+//-----------------------------------------------------------------------------
+// Matrix views
+//-----------------------------------------------------------------------------
+
+// Reads either a whole matrix binary or a {matrix, offset, rows, cols, stride} view tuple,
+// checking that the view lies within the matrix.
+static int
+get_view(ErlNifEnv *env, ERL_NIF_TERM term, MatrixView *view) {
+  ErlNifBinary        matrix;
+  const ERL_NIF_TERM *elements;
+  int32_t             arity;
+  ErlNifUInt64        offset, rows, cols, stride;
+  uint64_t            total;
+  float              *matrix_data;
+
+  if (enif_inspect_binary(env, term, &matrix)) {
+    if (matrix.size < 2*sizeof(float)) return 0;
+    *view = matrix_view_of((float *) matrix.data);
+    return 1;
+  }
+
+  if (!enif_get_tuple(env, term, &arity, &elements) || arity != 5 ||
+      !enif_inspect_binary(env, elements[0], &matrix) || matrix.size < 2*sizeof(float) ||
+      !enif_get_uint64(env, elements[1], &offset) ||
+      !enif_get_uint64(env, elements[2], &rows) ||
+      !enif_get_uint64(env, elements[3], &cols) ||
+      !enif_get_uint64(env, elements[4], &stride))
+    return 0;
+
+  matrix_data = (float *) matrix.data;
+  total       = (uint64_t) MX_ROWS(matrix_data)*MX_COLS(matrix_data);
+
+  // Last row must end within the matrix, checked without overflowing uint64.
+  if (rows == 0 || cols == 0 || cols > stride || rows > UINT32_MAX ||
+      offset >= total || cols > total - offset || rows - 1 > (total - offset - cols)/stride)
+    return 0;
+
+  view->data   = matrix_data + 2 + offset;
+  view->rows   = rows;
+  view->cols   = cols;
+  view->stride = stride;
+
+  return 1;
+}
+
+static ERL_NIF_TERM
+view_to_binary(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  MatrixView    view;
+  ERL_NIF_TERM  result;
+  float        *result_data;
+  size_t        result_size;
+
+  UNUSED_VAR(argc);
+
+  if (!get_view(env, argv[0], &view)) return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(view_to_binary, (uint64_t) view.rows*view.cols);
+
+  result_size = sizeof(float) * ((uint64_t) view.rows*view.cols + 2);
+  result_data = (float *) enif_make_new_binary(env, result_size, &result);
+
+  matrix_view_copy(view, result_data);
+
+  return result;
+}
+
+static ERL_NIF_TERM
+view_sum(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  MatrixView view;
+
+  UNUSED_VAR(argc);
+
+  if (!get_view(env, argv[0], &view)) return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(view_sum, (uint64_t) view.rows*view.cols);
+
+  return make_cell_value(env, matrix_view_sum(view));
+}
+
+static ERL_NIF_TERM
+view_add(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  MatrixView    first, second;
+  ERL_NIF_TERM  result;
+  float        *result_data;
+  float         alpha, beta;
+  size_t        result_size;
+
+  UNUSED_VAR(argc);
+
+  if (!get_view(env, argv[0], &first)) return enif_make_badarg(env);
+  if (!get_view(env, argv[1], &second)) return enif_make_badarg(env);
+  alpha = get_scalar(env, argv[2]);
+  beta = get_scalar(env, argv[3]);
+
+  if (first.rows != second.rows || first.cols != second.cols)
+    return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
+
+  SCHEDULE_DIRTY_IF_LARGE(view_add, (uint64_t) first.rows*first.cols);
+
+  result_size = sizeof(float) * ((uint64_t) first.rows*first.cols + 2);
+  result_data = (float *) enif_make_new_binary(env, result_size, &result);
+
+  matrix_view_add(first, second, alpha, beta, result_data);
+
+  return result;
+}
+
+static ERL_NIF_TERM
+view_dot(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  MatrixView    first, second;
+  ERL_NIF_TERM  result;
+  float        *result_data;
+  float         alpha;
+  size_t        result_size;
+
+  UNUSED_VAR(argc);
+
+  if (!get_view(env, argv[0], &first)) return enif_make_badarg(env);
+  if (!get_view(env, argv[1], &second)) return enif_make_badarg(env);
+  alpha = get_scalar(env, argv[2]);
+
+  if (first.cols != second.rows)
+    return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
+
+  SCHEDULE_DIRTY_IF_LARGE(view_dot, DOT_WORK(first.rows, first.cols, second.cols));
+
+  result_size = sizeof(float) * ((uint64_t) first.rows*second.cols + 2);
+  result_data = (float *) enif_make_new_binary(env, result_size, &result);
+
+  if (!matrix_view_dot(alpha, first, second, result_data))
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
+
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+// Fused elementwise expressions
+//-----------------------------------------------------------------------------
+
+// Reads one instruction: {:load, index}, {:scalar, number}, {:apply, function} or
+// one of :add, :subtract, :multiply, :divide and :neg atoms.
+static int
+get_instruction(ErlNifEnv *env, ERL_NIF_TERM term, expression_instruction_t *instruction) {
+  const ERL_NIF_TERM *tuple;
+  int32_t             arity;
+  char                name[16];
+  uint32_t            index;
+
+  memset(instruction, 0, sizeof(*instruction));
+
+  if (enif_get_atom(env, term, name, 16, ERL_NIF_LATIN1)) {
+    if (strcmp(name, "add") == 0)           instruction->opcode = EXPRESSION_ADD;
+    else if (strcmp(name, "subtract") == 0) instruction->opcode = EXPRESSION_SUBTRACT;
+    else if (strcmp(name, "multiply") == 0) instruction->opcode = EXPRESSION_MULTIPLY;
+    else if (strcmp(name, "divide") == 0)   instruction->opcode = EXPRESSION_DIVIDE;
+    else if (strcmp(name, "neg") == 0)      instruction->opcode = EXPRESSION_NEG;
+    else return 0;
+
+    return 1;
+  }
+
+  if (!enif_get_tuple(env, term, &arity, &tuple) || arity != 2) return 0;
+  if (!enif_get_atom(env, tuple[0], name, 16, ERL_NIF_LATIN1)) return 0;
+
+  if (strcmp(name, "load") == 0 && enif_get_uint(env, tuple[1], &index)) {
+    instruction->opcode  = EXPRESSION_LOAD;
+    instruction->operand = index;
+  } else if (strcmp(name, "scalar") == 0 && enif_is_number(env, tuple[1])) {
+    instruction->opcode = EXPRESSION_SCALAR;
+    instruction->scalar = get_scalar(env, tuple[1]);
+  } else if (strcmp(name, "apply") == 0 && enif_get_atom(env, tuple[1], name, 16, ERL_NIF_LATIN1)) {
+    instruction->opcode    = EXPRESSION_APPLY;
+    instruction->func      = math_func_from_name(name);
+    instruction->simd_func = matrix_simd_math(name);
+
+    if (instruction->func == NULL) return 0;
+  } else {
+    return 0;
+  }
+
+  return 1;
+}
+
+static ERL_NIF_TERM
+eval_expression(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  expression_instruction_t program[EXPRESSION_MAX_LENGTH];
+  Matrix                   operands[EXPRESSION_MAX_LENGTH];
+  uint32_t                 length = 0, operands_count = 0;
+  ERL_NIF_TERM             list, head, result;
+  float                   *result_data;
+  size_t                   result_size;
+
+  UNUSED_VAR(argc);
+
+  for (list = argv[0]; enif_get_list_cell(env, list, &head, &list); length += 1) {
+    if (length == EXPRESSION_MAX_LENGTH || !get_instruction(env, head, &program[length])) return enif_make_badarg(env);
+  }
+
+  for (list = argv[1]; enif_get_list_cell(env, list, &head, &list); operands_count += 1) {
+    if (operands_count == EXPRESSION_MAX_LENGTH || !get_matrix(env, head, &operands[operands_count]))
+      return enif_make_badarg(env);
+    if (operands_count > 0) ASSERT_SIZES_MATCH(operands[0], operands[operands_count]);
+  }
+
+  if (operands_count == 0) return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(eval_expression, (uint64_t) MX_LENGTH(operands[0])*length);
+
+  result_size = sizeof(float) * MX_LENGTH(operands[0]);
+  result_data = (float *) enif_make_new_binary(env, result_size, &result);
+
+  if (matrix_expression_eval(program, length, operands, operands_count, result_data) == 1)
+    return result;
+  else
+    return enif_make_badarg(env);
+}
+
+//-----------------------------------------------------------------------------
+// Typed matrices
+//-----------------------------------------------------------------------------
+
+#define ASSERT_TYPES_MATCH(m1, m2) if ((m1)->type != (m2)->type) \
+    return enif_raise_exception(env, enif_make_string(env, "Matrices types mismatch.", ERL_NIF_LATIN1));
+
+#define ASSERT_TYPED_SIZE(rows, cols, type) if (matrix_typed_byte_size(rows, cols, type) == 0) \
+    return enif_raise_exception(env, enif_make_string(env, "Matrix is too large.", ERL_NIF_LATIN1));
+
+// Reads typed matrix binary, checking its header.
+static int
+get_typed(ErlNifEnv *env, ERL_NIF_TERM term, TypedMatrix *matrix) {
+  ErlNifBinary binary;
+
+  if (!enif_inspect_binary(env, term, &binary) || !matrix_typed_valid(binary.data, binary.size)) return 0;
+
+  *matrix = (TypedMatrix) binary.data;
+  return 1;
+}
+
+// Reads element type atom, e.g. :float64.
+static int
+get_type(ErlNifEnv *env, ERL_NIF_TERM term, matrix_type_t *type) {
+  char name[16];
+  int  found;
+
+  if (!enif_get_atom(env, term, name, 16, ERL_NIF_LATIN1)) return 0;
+  if ((found = matrix_type_from_name(name)) < 0) return 0;
+
+  *type = (matrix_type_t) found;
+  return 1;
+}
+
+static TypedMatrix
+make_typed(ErlNifEnv *env, const uint32_t rows, const uint32_t cols, const matrix_type_t type, ERL_NIF_TERM *term) {
+  TypedMatrix result = (TypedMatrix) enif_make_new_binary(env, matrix_typed_byte_size(rows, cols, type), term);
+
+  matrix_typed_init(result, rows, cols, type);
+  return result;
+}
+
+// Integer type elements are returned as integers.
+static inline ERL_NIF_TERM
+make_typed_value(ErlNifEnv* env, const matrix_type_t type, const double value) {
+  if (isfinite(value) && matrix_type_is_integer(type))
+    return enif_make_int64(env, (int64_t) value);
+  else if (isfinite(value))
+    return enif_make_double(env, value);
+  else if (isnan(value))
+    return enif_make_atom(env, "nan");
+  else if (value > 0)
+    return enif_make_atom(env, "inf");
+  else
+    return enif_make_atom(env, "neg_inf");
+}
+
+static ERL_NIF_TERM
+typed_new(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  uint32_t      rows, cols;
+  matrix_type_t type;
+  ERL_NIF_TERM  result;
+
+  if (!enif_get_uint(env, argv[0], &rows) || !enif_get_uint(env, argv[1], &cols)) return enif_make_badarg(env);
+  if (!get_type(env, argv[2], &type) || !enif_is_number(env, argv[3])) return enif_make_badarg(env);
+  ASSERT_TYPED_SIZE(rows, cols, type);
+
+  SCHEDULE_DIRTY_IF_LARGE(typed_new, (uint64_t) rows*cols);
+
+  matrix_typed_fill(make_typed(env, rows, cols, type, &result), get_scalar(env, argv[3]));
+
+  return result;
+}
+
+static ERL_NIF_TERM
+typed_eye(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  uint32_t      size;
+  matrix_type_t type;
+  ERL_NIF_TERM  result;
+
+  if (!enif_get_uint(env, argv[0], &size) || !get_type(env, argv[1], &type)) return enif_make_badarg(env);
+  if (!enif_is_number(env, argv[2])) return enif_make_badarg(env);
+  ASSERT_TYPED_SIZE(size, size, type);
+
+  SCHEDULE_DIRTY_IF_LARGE(typed_eye, (uint64_t) size*size);
+
+  matrix_typed_eye(make_typed(env, size, size, type, &result), get_scalar(env, argv[2]));
+
+  return result;
+}
+
+static ERL_NIF_TERM
+typed_from_matrex(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  Matrix        matrix;
+  matrix_type_t type;
+  ERL_NIF_TERM  result;
+
+  if (!get_matrix(env, argv[0], &matrix) || !get_type(env, argv[1], &type)) return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(typed_from_matrex, MX_LENGTH(matrix));
+
+  matrix_typed_from_matrex(matrix, make_typed(env, MX_ROWS(matrix), MX_COLS(matrix), type, &result));
+
+  return result;
+}
+
+static ERL_NIF_TERM
+typed_to_matrex(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  TypedMatrix  matrix;
+  ERL_NIF_TERM result;
+  float       *result_data;
+
+  if (!get_typed(env, argv[0], &matrix)) return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(typed_to_matrex, MX_TYPED_COUNT(matrix));
+
+  result_data = (float *) enif_make_new_binary(env, sizeof(float) * (MX_TYPED_COUNT(matrix) + 2), &result);
+
+  matrix_typed_to_matrex(matrix, result_data);
+
+  return result;
+}
+
+static ERL_NIF_TERM
+typed_convert(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  TypedMatrix   matrix;
+  matrix_type_t type;
+  ERL_NIF_TERM  result;
+
+  if (!get_typed(env, argv[0], &matrix) || !get_type(env, argv[1], &type)) return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(typed_convert, MX_TYPED_COUNT(matrix));
+
+  matrix_typed_convert(matrix, make_typed(env, matrix->rows, matrix->cols, type, &result));
+
+  return result;
+}
+
+// Elementwise operation on two typed matrices or a typed matrix and a number, in any order.
+static ERL_NIF_TERM
+typed_operate(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  TypedMatrix        first, second;
+  matrix_operation_t operation;
+  char               name[16];
+  ERL_NIF_TERM       result;
+
+  if (!enif_get_atom(env, argv[2], name, 16, ERL_NIF_LATIN1)) return enif_make_badarg(env);
+
+  if (strcmp(name, "add") == 0)           operation = MX_ADD;
+  else if (strcmp(name, "subtract") == 0) operation = MX_SUBTRACT;
+  else if (strcmp(name, "multiply") == 0) operation = MX_MULTIPLY;
+  else if (strcmp(name, "divide") == 0)   operation = MX_DIVIDE;
+  else return enif_make_badarg(env);
+
+  if (get_typed(env, argv[0], &first) && get_typed(env, argv[1], &second)) {
+    ASSERT_TYPES_MATCH(first, second);
+    if (first->rows != second->rows || first->cols != second->cols)
+      return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
+
+    SCHEDULE_DIRTY_IF_LARGE(typed_operate, MX_TYPED_COUNT(first));
+
+    matrix_typed_operate(operation, first, second, make_typed(env, first->rows, first->cols, first->type, &result));
+  } else if (get_typed(env, argv[0], &first) && enif_is_number(env, argv[1])) {
+    SCHEDULE_DIRTY_IF_LARGE(typed_operate, MX_TYPED_COUNT(first));
+
+    matrix_typed_operate_scalar(
+      operation, first, get_scalar(env, argv[1]), 0, make_typed(env, first->rows, first->cols, first->type, &result)
+    );
+  } else if (enif_is_number(env, argv[0]) && get_typed(env, argv[1], &second)) {
+    SCHEDULE_DIRTY_IF_LARGE(typed_operate, MX_TYPED_COUNT(second));
+
+    matrix_typed_operate_scalar(
+      operation, second, get_scalar(env, argv[0]), 1, make_typed(env, second->rows, second->cols, second->type, &result)
+    );
+  } else {
+    return enif_make_badarg(env);
+  }
+
+  return result;
+}
+
+static ERL_NIF_TERM
+typed_apply(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  TypedMatrix  matrix;
+  char         function_name[16];
+  ERL_NIF_TERM result;
+
+  if (!get_typed(env, argv[0], &matrix)) return enif_make_badarg(env);
+  if (!enif_get_atom(env, argv[1], function_name, 16, ERL_NIF_LATIN1)) return enif_make_badarg(env);
+  if (math_func_from_name(function_name) == NULL) return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(typed_apply, MX_TYPED_COUNT(matrix));
+
+  matrix_typed_apply(matrix, function_name, make_typed(env, matrix->rows, matrix->cols, matrix->type, &result));
+
+  return result;
+}
+
+static ERL_NIF_TERM
+typed_dot(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  TypedMatrix  first, second;
+  ERL_NIF_TERM result;
+
+  if (!get_typed(env, argv[0], &first) || !get_typed(env, argv[1], &second)) return enif_make_badarg(env);
+  if (!enif_is_number(env, argv[2])) return enif_make_badarg(env);
+
+  ASSERT_TYPES_MATCH(first, second);
+  if (first->cols != second->rows)
+    return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
+  ASSERT_TYPED_SIZE(first->rows, second->cols, first->type);
+
+  SCHEDULE_DIRTY_IF_LARGE(typed_dot, DOT_WORK(first->rows, first->cols, second->cols));
+
+  if (!matrix_typed_dot(
+    get_scalar(env, argv[2]), first, second, make_typed(env, first->rows, second->cols, first->type, &result)
+  ))
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
+
+  return result;
+}
+
+// Reads scales of rows or columns: a number, the same for all of them, or a float matrix of `count` elements.
+static int
+get_scales(
+  ErlNifEnv *env, ERL_NIF_TERM term, const uint64_t count, float *single, const float **scales, uint64_t *step
+) {
+  Matrix matrix;
+
+  if (enif_is_number(env, term)) {
+    *single = get_scalar(env, term);
+    *scales = single;
+    *step   = 0;
+    return 1;
+  }
+
+  if (!get_matrix(env, term, &matrix) || (uint64_t) MX_ROWS(matrix)*MX_COLS(matrix) != count) return 0;
+
+  *scales = matrix + 2;
+  *step   = 1;
+  return 1;
+}
+
+// Product of int8 matrices: int32 one or, when scales of the rows of the first matrix and of the columns
+// of the second one are given, float32 one.
+static ERL_NIF_TERM
+typed_quantized_dot(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  TypedMatrix  first, second;
+  float        first_scale = 1, second_scale = 1;
+  const float *first_scales = &first_scale, *second_scales = &second_scale;
+  uint64_t     first_step = 0, second_step = 0;
+  int          scaled = !enif_is_identical(argv[2], enif_make_atom(env, "nil"));
+  ERL_NIF_TERM result;
+
+  if (!get_typed(env, argv[0], &first) || !get_typed(env, argv[1], &second)) return enif_make_badarg(env);
+  if (first->type != MX_INT8 || second->type != MX_INT8)
+    return enif_raise_exception(env, enif_make_string(env, "Matrices types mismatch.", ERL_NIF_LATIN1));
+  if (first->cols != second->rows)
+    return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
+  if (first->cols > QUANTIZED_MAX_INNER) return enif_make_badarg(env);
+  ASSERT_TYPED_SIZE(first->rows, second->cols, scaled ? MX_FLOAT32 : MX_INT32);
+  if (scaled && (
+    !get_scales(env, argv[2], first->rows, &first_scale, &first_scales, &first_step) ||
+    !get_scales(env, argv[3], second->cols, &second_scale, &second_scales, &second_step)
+  ))
+    return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(typed_quantized_dot, DOT_WORK(first->rows, first->cols, second->cols));
+
+  if (!matrix_typed_quantized_dot(
+    first, second, first_scales, first_step, second_scales, second_step,
+    make_typed(env, first->rows, second->cols, scaled ? MX_FLOAT32 : MX_INT32, &result)
+  ))
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
+
+  return result;
+}
+
+static ERL_NIF_TERM
+typed_transpose(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  TypedMatrix  matrix;
+  ERL_NIF_TERM result;
+
+  if (!get_typed(env, argv[0], &matrix)) return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(typed_transpose, MX_TYPED_COUNT(matrix));
+
+  matrix_typed_transpose(matrix, make_typed(env, matrix->cols, matrix->rows, matrix->type, &result));
+
+  return result;
+}
+
+static ERL_NIF_TERM
+typed_reduce(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  TypedMatrix matrix;
+  char        name[16];
+
+  if (!get_typed(env, argv[0], &matrix)) return enif_make_badarg(env);
+  if (!enif_get_atom(env, argv[1], name, 16, ERL_NIF_LATIN1)) return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(typed_reduce, MX_TYPED_COUNT(matrix));
+
+  if (strcmp(name, "sum") == 0) return make_typed_value(env, matrix->type, matrix_typed_sum(matrix));
+  if (strcmp(name, "max") == 0) return make_typed_value(env, matrix->type, matrix_typed_max(matrix));
+  if (strcmp(name, "min") == 0) return make_typed_value(env, matrix->type, matrix_typed_min(matrix));
+
+  return enif_make_badarg(env);
+}
+
+static ERL_NIF_TERM
+typed_cholesky(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  TypedMatrix  matrix;
+  ERL_NIF_TERM result;
+
+  if (!get_typed(env, argv[0], &matrix)) return enif_make_badarg(env);
+  if (matrix->rows != matrix->cols)
+    return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
+
+  SCHEDULE_DIRTY_IF_LARGE(typed_cholesky, DOT_WORK(matrix->rows, matrix->rows, matrix->rows) / 3);
+
+  if (!matrix_typed_cholesky(matrix, make_typed(env, matrix->rows, matrix->cols, matrix->type, &result)))
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
+
+  return result;
+}
+
+static ERL_NIF_TERM
+typed_forward_substitute(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  TypedMatrix  matrix, beta;
+  ERL_NIF_TERM result;
+
+  if (!get_typed(env, argv[0], &matrix) || !get_typed(env, argv[1], &beta)) return enif_make_badarg(env);
+
+  ASSERT_TYPES_MATCH(matrix, beta);
+  if (matrix->rows != matrix->cols || beta->rows != matrix->rows || beta->cols != 1)
+    return enif_raise_exception(env, enif_make_string(env, "Matrices sizes mismatch.", ERL_NIF_LATIN1));
+
+  SCHEDULE_DIRTY_IF_LARGE(typed_forward_substitute, MX_TYPED_COUNT(matrix));
+
+  if (!matrix_typed_solve(matrix, beta, make_typed(env, matrix->rows, 1, matrix->type, &result)))
+    return enif_raise_exception(env, enif_make_string(env, "Out of memory.", ERL_NIF_LATIN1));
+
+  return result;
+}
+
+// All elements as a flat list, widened to double.
+static ERL_NIF_TERM
+typed_to_list(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  TypedMatrix  matrix;
+  ERL_NIF_TERM result;
+  double       block[256];
+  uint64_t     count;
+
+  if (!get_typed(env, argv[0], &matrix)) return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(typed_to_list, MX_TYPED_COUNT(matrix));
+
+  count  = MX_TYPED_COUNT(matrix);
+  result = enif_make_list(env, 0);
+
+  // Built from the end, a block of elements at a time.
+  for (uint64_t to = count; to > 0;) {
+    const uint64_t from = to > 256 ? to - 256 : 0;
+
+    matrix_typed_read(matrix, from, to - from, block);
+
+    for (uint64_t index = to; index > from; index -= 1)
+      result = enif_make_list_cell(env, make_typed_value(env, matrix->type, block[index - 1 - from]), result);
+
+    to = from;
+  }
+
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+// IDX datasets
+//-----------------------------------------------------------------------------
+
+// Decodes IDX data into a float matrix, when the second argument is `true` or elements are floats,
+// or into a typed one of integers otherwise. Converted to float, elements are normalized into [0, 1],
+// when the third argument is `true`.
+static ERL_NIF_TERM
+idx_decode(ErlNifEnv *env, int32_t argc, const ERL_NIF_TERM *argv) {
+  ErlNifBinary  data;
+  IdxData       idx;
+  ERL_NIF_TERM  result;
+  Matrix        matrix;
+  char          to_float[6], normalize[6];
+  matrix_type_t type;
+
+  UNUSED_VAR(argc);
+
+  if (!enif_inspect_binary(env, argv[0], &data) || !matrix_idx_parse(data.data, data.size, &idx) ||
+      !enif_get_atom(env, argv[1], to_float, sizeof(to_float), ERL_NIF_LATIN1) ||
+      !enif_get_atom(env, argv[2], normalize, sizeof(normalize), ERL_NIF_LATIN1))
+    return enif_make_badarg(env);
+
+  SCHEDULE_DIRTY_IF_LARGE(idx_decode, (uint64_t) idx.rows*idx.cols);
+
+  if (strcmp(to_float, "true") == 0 || !matrix_idx_is_integer(idx.type)) {
+    matrix = (Matrix) enif_make_new_binary(env, sizeof(float)*((uint64_t) idx.rows*idx.cols + 2), &result);
+    matrix_idx_to_float(&idx, strcmp(normalize, "true") == 0, matrix);
+    return result;
+  }
+
+  type = matrix_idx_integer_type(idx.type);
+  matrix_idx_to_integers(&idx, MX_TYPED_DATA(make_typed(env, idx.rows, idx.cols, type, &result)));
+
+  return result;
+}
+
+static ErlNifFunc nif_functions[] = {
+  {"add",                  4, add,                  0},
+  {"add_scalar",           2, add_scalar,           0},
+  {"apply_math",           2, apply_math,           0},
+  {"apply_parallel_math",  2, apply_parallel_math,  0},
+  {"argmax",               1, argmax,               0},
+  {"chunk_to_list",        3, chunk_to_list,        0},
+  {"column_to_list",       2, column_to_list,       0},
+  {"concat",               2, concat,               0},
+  {"concat_columns",       2, concat_columns,       0},
+  {"csv_finish",           1, csv_finish,           0},
+  {"csv_read",             2, csv_read,             0},
+  {"csv_reader_new",       0, csv_reader_new,       0},
+  {"csv_write",            3, csv_write,            0},
+  {"power",                2, power,                0},
+  {"divide",               2, divide,               0},
+  {"divide_scalar",        2, divide_scalar,        0},
+  {"divide_by_scalar",     2, divide_by_scalar,     0},
+  {"dot",                  2, dot,                  0},
+  {"dot_and_add",          3, dot_and_add,          0},
+  {"dot_and_apply",        3, dot_and_apply,        0},
+  {"dot_nt",               2, dot_nt,               0},
+  {"dot_tn",               3, dot_tn,               0},
+  {"cholesky",             1, cholesky,             0},
+  {"forward_substitute",                2, forward_substitute,                0},
+  {"eval_expression",      2, eval_expression,      0},
+  {"eye",                  2, eye,                  0},
+  {"diagonal",             1, diagonal,             0},
+  {"fill",                 3, fill,                 0},
+  {"find",                 2, find,                 0},
+  {"from_list",            3, from_list,            0},
+  {"from_range",           4, from_range,           0},
+  {"idx_decode",           3, idx_decode,           0},
+  {"max",                  1, max,                  0},
+  {"min",                  1, minimum,              0},
+  {"max_finite",           1, max_finite,           0},
+  {"min_finite",           1, min_finite,           0},
+  {"mmap_file",            2, mmap_file,            ERL_NIF_DIRTY_JOB_IO_BOUND},
+  {"multiply",             2, multiply,             0},
+  {"multiply_with_scalar", 2, multiply_with_scalar, 0},
+  {"mutable_add",          5, mutable_add,          0},
+  {"mutable_apply",        3, mutable_apply,        0},
+  {"mutable_dot",          4, mutable_dot,          0},
+  {"mutable_multiply",     3, mutable_multiply,     0},
+  {"mutable_new",          1, mutable_new,          0},
+  {"mutable_size",         1, mutable_size,         0},
+  {"mutable_to_binary",    1, mutable_to_binary,    0},
+  {"mutable_transpose",    2, mutable_transpose,    0},
+  {"mutable_write_list",   3, mutable_write_list,   0},
+  {"neg",                  1, neg,                  0},
+  {"normalize",            1, normalize,            0},
+  {"random",               4, random_matrix,        0},
+  {"reduce_columns",       2, reduce_columns,       0},
+  {"reduce_rows",          2, reduce_rows,          0},
+  {"resize",               2, resize,               0},
+  {"row_to_list",          2, row_to_list,          0},
+  {"set",                  4, set,                  0},
+  {"set_column",           3, set_column,           0},
+  {"set_dirty_threshold",  1, set_dirty_threshold,  0},
+  {"set_dot_workers",      1, set_dot_workers,      0},
+  {"set_simd",             1, set_simd,             0},
+  {"submatrix",            5, submatrix,            0},
+  {"subtract",             2, subtract,             0},
+  {"subtract_from_scalar", 2, subtract_from_scalar, 0},
+  {"stream_finish",        1, stream_finish,        0},
+  {"stream_new",           3, stream_new,           0},
+  {"stream_write",         2, stream_write,         0},
+  {"sum",                  1, sum,                  0},
+  {"sum",                  2, sum,                  0},
+  {"to_list",              1, to_list,              0},
+  {"to_list_of_lists",     1, to_list_of_lists,     0},
+  {"transpose",            1, transpose,            0},
+  {"typed_apply",          2, typed_apply,          0},
+  {"typed_cholesky",       1, typed_cholesky,       0},
+  {"typed_convert",        2, typed_convert,        0},
+  {"typed_dot",            3, typed_dot,            0},
+  {"typed_eye",            3, typed_eye,            0},
+  {"typed_forward_substitute", 2, typed_forward_substitute, 0},
+  {"typed_from_matrex",    2, typed_from_matrex,    0},
+  {"typed_new",            4, typed_new,            0},
+  {"typed_operate",        3, typed_operate,        0},
+  {"typed_quantized_dot",  4, typed_quantized_dot,  0},
+  {"typed_reduce",         2, typed_reduce,         0},
+  {"typed_to_list",        1, typed_to_list,        0},
+  {"typed_to_matrex",      1, typed_to_matrex,      0},
+  {"typed_transpose",      1, typed_transpose,      0},
+  {"view_add",             4, view_add,             0},
+  {"view_dot",             3, view_dot,             0},
+  {"view_sum",             1, view_sum,             0},
+  {"view_to_binary",       1, view_to_binary,       0},
+  {"zeros",                2, zeros,                0}
+};
+
+// Reads unsigned integer setting from load_info map. Returns 0, if it's not there.
+static int
+get_load_setting(ErlNifEnv* env, ERL_NIF_TERM load_info, const char* name, uint64_t* setting) {
+  ERL_NIF_TERM value;
+  unsigned long number;
+
+  if (!enif_is_map(env, load_info) ||
+      !enif_get_map_value(env, load_info, enif_make_atom(env, name), &value) ||
+      !enif_get_uint64(env, value, &number))
+    return 0;
+
+  *setting = number;
+  return 1;
+}
+
+// Used for RNG initialization, reading settings, passed in load_info map,
+// opening resource types and starting the thread pool.
+int
+load(ErlNifEnv* env, void** priv_data, ERL_NIF_TERM load_info) {
+  uint64_t workers = 0, dot_workers;
+  ERL_NIF_TERM value;
+  char isa[16];
+
+  // Silence "unused var" warnings.
+  (void)(priv_data);
+
+  get_load_setting(env, load_info, "dirty_threshold", &dirty_threshold);
+  get_load_setting(env, load_info, "workers", &workers);
+  if (get_load_setting(env, load_info, "dot_workers", &dot_workers))
+    matrix_gemm_set_max_workers(dot_workers);
+
+  // Fall back to the best supported instruction set, if the one from settings is not.
+  if (!enif_is_map(env, load_info) ||
+      !enif_get_map_value(env, load_info, enif_make_atom(env, "simd"), &value) ||
+      !enif_get_atom(env, value, isa, 16, ERL_NIF_LATIN1) ||
+      !matrix_simd_select(isa))
+    matrix_simd_select("auto");
+
+  // Takes over the type from the old library instance on upgrade, so existing resources stay valid.
+  mutable_matrix_type = enif_open_resource_type(
+    env, NULL, "mutable_matrix", NULL, ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER, NULL
+  );
+  if (mutable_matrix_type == NULL) return 1;
+
+  mapped_file_type = enif_open_resource_type(
+    env, NULL, "mapped_file", mapped_file_destructor, ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER, NULL
+  );
+  if (mapped_file_type == NULL) return 1;
+
+  csv_reader_type = enif_open_resource_type(
+    env, NULL, "csv_reader", csv_reader_destructor, ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER, NULL
+  );
+  if (csv_reader_type == NULL) return 1;
+
+  list_fill_type = enif_open_resource_type(
+    env, NULL, "list_fill", list_fill_destructor, ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER, NULL
+  );
+  if (list_fill_type == NULL) return 1;
+
+  stream_type = enif_open_resource_type(
+    env, NULL, "matrix_stream", stream_destructor, ERL_NIF_RT_CREATE | ERL_NIF_RT_TAKEOVER, NULL
+  );
+  if (stream_type == NULL) return 1;
+
+  matrix_random_init(((uint64_t) time(NULL) << 32) ^ (uint64_t) clock());
+
+  return thread_pool_start(workers);
+}
+
+// New library instance has its own static data, so it is initialized the same way.
+int
+upgrade(ErlNifEnv* env, void** priv_data, void** old_priv_data, ERL_NIF_TERM load_info) {
+  // Silence "unused var" warnings.
+  (void)(old_priv_data);
+
+  return load(env, priv_data, load_info);
+}
+
+void
+unload(ErlNifEnv* env, void* priv_data) {
+  // Silence "unused var" warnings.
+  (void)(env);
+  (void)(priv_data);
+
+  thread_pool_stop();
+}
+
+ERL_NIF_INIT(Elixir.Matrex.NIFs, nif_functions, load, NULL, upgrade, unload)
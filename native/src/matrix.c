@@ -1,4 +1,6 @@
 #include "../include/matrix.h"
+#include "../include/matrix_simd.h"
+#include "../include/thread_pool.h"
 
 void
 matrix_clone(Matrix destination, Matrix source) {
@@ -43,17 +45,83 @@ matrix_equal(const Matrix first, const Matrix second) {
   return 1;
 }
 
+int
+matrix_broadcastable(const Matrix first, const Matrix second) {
+  return (MX_ROWS(first) == MX_ROWS(second) || MX_ROWS(first) == 1 || MX_ROWS(second) == 1) &&
+    (MX_COLS(first) == MX_COLS(second) || MX_COLS(first) == 1 || MX_COLS(second) == 1);
+}
+
+// Dimension of the result: the larger one, when the other is 1, but empty, when either is.
+static inline uint64_t
+broadcast_dimension(const uint64_t first, const uint64_t second) {
+  if (first == 0 || second == 0) return 0;
+
+  return first > second ? first : second;
+}
+
+uint64_t
+matrix_broadcast_length(const Matrix first, const Matrix second) {
+  return broadcast_dimension(MX_ROWS(first), MX_ROWS(second))*broadcast_dimension(MX_COLS(first), MX_COLS(second)) + 2;
+}
+
+static inline int
+same_size(const Matrix first, const Matrix second) {
+  return MX_ROWS(first) == MX_ROWS(second) && MX_COLS(first) == MX_COLS(second);
+}
+
+// Strip of operand elements for the given row and columns of the result. Operand rows are repeated
+// by pointing to the same data again, operand columns are repeated by filling the buffer with their element.
+static inline const float *
+broadcast_strip(const Matrix matrix, const uint64_t row, const uint64_t col, const uint64_t width, float *buffer) {
+  const float *data = matrix + 2 + (MX_ROWS(matrix) == 1 ? 0 : row*MX_COLS(matrix));
+
+  if (MX_COLS(matrix) > 1 || width == 1) return data + col;
+
+  for (uint64_t index = 0; index < width; index += 1) buffer[index] = data[0];
+
+  return buffer;
+}
+
+static void
+broadcast(const Matrix first, const Matrix second, const simd_binary_t kernel,
+  const float alpha, const float beta, Matrix result) {
+  const uint64_t rows = broadcast_dimension(MX_ROWS(first), MX_ROWS(second));
+  const uint64_t cols = broadcast_dimension(MX_COLS(first), MX_COLS(second));
+  float          first_buffer[BROADCAST_STRIP], second_buffer[BROADCAST_STRIP];
+
+  MX_SET_ROWS(result, rows);
+  MX_SET_COLS(result, cols);
+
+  // An empty operand has no elements to repeat.
+  if (rows == 0 || cols == 0) return;
+
+  for (uint64_t row = 0; row < rows; row += 1) {
+    for (uint64_t col = 0; col < cols; col += BROADCAST_STRIP) {
+      const uint64_t width = cols - col < BROADCAST_STRIP ? cols - col : BROADCAST_STRIP;
+
+      kernel(
+        broadcast_strip(first, row, col, width, first_buffer),
+        broadcast_strip(second, row, col, width, second_buffer),
+        alpha, beta, result + 2 + row*cols + col, width
+      );
+    }
+  }
+}
+
 void
 matrix_add(const Matrix first, const Matrix second,
   const float alpha, const float beta, Matrix result) {
     uint64_t data_size = MX_LENGTH(first);
 
+    if (!same_size(first, second)) {
+      broadcast(first, second, matrix_simd->add, alpha, beta, result);
+      return;
+    }
+
     MX_SET_ROWS(result, MX_ROWS(first));
     MX_SET_COLS(result, MX_COLS(first));
 
-    for (uint64_t index = 2; index < data_size; index += 1) {
-      result[index] = alpha*first[index] + beta*second[index];
-    }
+    matrix_simd->add(first + 2, second + 2, alpha, beta, result + 2, data_size - 2);
 }
 
 
@@ -66,9 +134,7 @@ matrix_add_scalar(
   MX_SET_ROWS(result, MX_ROWS(matrix));
   MX_SET_COLS(result, MX_COLS(matrix));
 
-  for (uint64_t index = 2; index < data_size; index += 1) {
-    result[index] = matrix[index] + scalar;
-  }
+  matrix_simd->add_scalar(matrix + 2, scalar, result + 2, data_size - 2);
 }
 
 float sigmoidf(float x) {
@@ -141,12 +207,18 @@ int
 matrix_apply(const Matrix matrix, char* function_name, Matrix result) {
   const uint64_t data_size = MX_LENGTH(matrix);
   const math_func_ptr_t func = math_func_from_name(function_name);
+  const simd_unary_t simd_func = matrix_simd_math(function_name);
 
   if (func == NULL) return 0;
 
   MX_SET_ROWS(result, MX_ROWS(matrix));
   MX_SET_COLS(result, MX_COLS(matrix));
 
+  if (simd_func != NULL) {
+    simd_func(matrix + 2, 0, result + 2, data_size - 2);
+    return 1;
+  }
+
   for (uint64_t index = 2; index < data_size; index += 1) {
     result[index] = func(matrix[index]);
   }
@@ -154,17 +226,176 @@ matrix_apply(const Matrix matrix, char* function_name, Matrix result) {
   return 1;
 }
 
+typedef struct {
+  Matrix          matrix;
+  Matrix          result;
+  math_func_ptr_t func;
+  simd_unary_t    simd_func;
+} apply_args_t;
+
+static void
+apply_chunk(void *args, uint64_t from, uint64_t to) {
+  const apply_args_t *apply = (const apply_args_t *)args;
+
+  if (apply->simd_func != NULL) {
+    apply->simd_func(apply->matrix + 2 + from, 0, apply->result + 2 + from, to - from);
+    return;
+  }
+
+  for (uint64_t index = 2 + from; index < 2 + to; index += 1) {
+    apply->result[index] = apply->func(apply->matrix[index]);
+  }
+}
+
+// Same as matrix_apply(), but splits the work between thread pool workers.
+int
+matrix_apply_parallel(const Matrix matrix, char* function_name, Matrix result) {
+  const math_func_ptr_t func = math_func_from_name(function_name);
+  apply_args_t args = { matrix, result, func, matrix_simd_math(function_name) };
+
+  if (func == NULL) return 0;
+
+  MX_SET_ROWS(result, MX_ROWS(matrix));
+  MX_SET_COLS(result, MX_COLS(matrix));
+
+  thread_pool_run(apply_chunk, &args, MX_LENGTH(matrix) - 2, APPLY_PARALLEL_GRAIN);
+
+  return 1;
+}
+
+// Reductions split data into blocks, which depend only on the size of the data, and combine
+// results of the blocks in order. So they return the same result with any number of workers.
+typedef struct {
+  const float     *data;
+  uint64_t         size;
+  uint64_t         block;
+  float            initial;        // initial extreme value for the first block
+  float            rest_initial;   // and for the rest of them, or the value to find
+  simd_sum_t       sum;
+  simd_sum_kahan_t sum_kahan;
+  simd_extremum_t  extremum;
+  simd_argmax_t    argmax;
+  simd_find_t      find;
+  double          *sums;
+  double          *compensations;  // of the blocks, when summed by sum_kahan
+  float           *extremes;
+  uint64_t        *indices;
+  uint64_t         found;          // index of the first found element, updated atomically
+} reduce_args_t;
+
+static inline uint64_t
+reduce_blocks(reduce_args_t *reduce, const Matrix matrix) {
+  const uint64_t size  = MX_LENGTH(matrix) - 2;
+  const uint64_t block = (size + REDUCE_MAX_BLOCKS - 1) / REDUCE_MAX_BLOCKS;
+
+  reduce->data  = matrix + 2;
+  reduce->size  = size;
+  reduce->block = block < REDUCE_BLOCK ? REDUCE_BLOCK : block;
+
+  return (size + reduce->block - 1) / reduce->block;
+}
+
+static inline uint64_t
+block_length(const reduce_args_t *reduce, const uint64_t block) {
+  const uint64_t rest = reduce->size - block*reduce->block;
+
+  return rest < reduce->block ? rest : reduce->block;
+}
+
+static void
+sum_blocks(void *args, uint64_t from, uint64_t to) {
+  reduce_args_t *reduce = (reduce_args_t *)args;
+
+  for (uint64_t block = from; block < to; block += 1) {
+    const float   *data = reduce->data + block*reduce->block;
+    const uint64_t length = block_length(reduce, block);
+
+    if (reduce->sum_kahan)
+      reduce->sums[block] = reduce->sum_kahan(data, length, &reduce->compensations[block]);
+    else
+      reduce->sums[block] = reduce->sum(data, length);
+  }
+}
+
+static void
+extremum_blocks(void *args, uint64_t from, uint64_t to) {
+  reduce_args_t *reduce = (reduce_args_t *)args;
+
+  for (uint64_t block = from; block < to; block += 1) {
+    reduce->extremes[block] = reduce->extremum(
+      reduce->data + block*reduce->block, block == 0 ? reduce->initial : reduce->rest_initial,
+      block_length(reduce, block)
+    );
+  }
+}
+
+static void
+argmax_blocks(void *args, uint64_t from, uint64_t to) {
+  reduce_args_t *reduce = (reduce_args_t *)args;
+
+  for (uint64_t block = from; block < to; block += 1) {
+    reduce->indices[block] = block*reduce->block + reduce->argmax(
+      reduce->data + block*reduce->block, block == 0 ? reduce->initial : reduce->rest_initial,
+      block_length(reduce, block), &reduce->extremes[block]
+    );
+  }
+}
+
+// Blocks past an element, already found by another worker, are skipped.
+static void
+find_blocks(void *args, uint64_t from, uint64_t to) {
+  reduce_args_t *reduce = (reduce_args_t *)args;
+
+  for (uint64_t block = from; block < to; block += 1) {
+    const uint64_t start  = block*reduce->block;
+    const uint64_t length = block_length(reduce, block);
+    uint64_t       found  = __atomic_load_n(&reduce->found, __ATOMIC_RELAXED);
+    uint64_t       index;
+
+    if (start >= found) return;
+
+    index = reduce->find(reduce->data + start, reduce->rest_initial, length);
+    if (index == length) continue;
+
+    while (start + index < found &&
+           !__atomic_compare_exchange_n(&reduce->found, &found, start + index, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return;
+  }
+}
+
+// Extreme value of the whole matrix, computed by the given kernel. Partial results of blocks
+// are combined by the same kernel, starting from the first block result.
+static float
+matrix_extremum(const Matrix matrix, const simd_extremum_t extremum, const float initial, const float rest_initial) {
+  float          extremes[REDUCE_MAX_BLOCKS];
+  reduce_args_t  args = { .extremum = extremum, .initial = initial, .rest_initial = rest_initial, .extremes = extremes };
+  const uint64_t blocks = reduce_blocks(&args, matrix);
+
+  if (blocks == 0) return initial;
+
+  thread_pool_run(extremum_blocks, &args, blocks, 1);
+
+  return extremum(extremes, extremes[0], blocks);
+}
+
 int32_t
 matrix_argmax(const Matrix matrix) {
-  const int64_t data_size = MX_LENGTH(matrix);
-  uint64_t argmax    = 2;
-
-  for (int64_t index = 3; index < data_size; index += 1) {
-    if (matrix[argmax] < matrix[index]) {
-      argmax = index;
-    }
+  float          extremes[REDUCE_MAX_BLOCKS];
+  uint64_t       indices[REDUCE_MAX_BLOCKS];
+  reduce_args_t  args = {
+    .argmax = matrix_simd->argmax, .initial = matrix[2], .rest_initial = -INFINITY,
+    .extremes = extremes, .indices = indices
+  };
+  const uint64_t blocks = reduce_blocks(&args, matrix);
+  uint64_t       argmax = 0;
+
+  thread_pool_run(argmax_blocks, &args, blocks, 1);
+
+  for (uint64_t block = 1; block < blocks; block += 1) {
+    if (extremes[argmax] < extremes[block]) argmax = block;
   }
-  return argmax - 2;
+
+  return blocks == 0 ? 0 : indices[argmax];
 }
 
 
@@ -181,6 +412,40 @@ matrix_concat_columns(const Matrix first, const Matrix second, Matrix result) {
   }
 }
 
+void
+matrix_concat(const Matrix *matrices, const uint32_t count, const int along_rows, Matrix result) {
+  float    *position = &result[2];
+  uint64_t  result_rows = MX_ROWS(matrices[0]), result_cols = MX_COLS(matrices[0]);
+
+  if (along_rows) {
+    result_rows = 0;
+
+    for (uint32_t index = 0; index < count; index++) {
+      const uint64_t length = (uint64_t) MX_ROWS(matrices[index])*MX_COLS(matrices[index]);
+
+      memcpy(position, &matrices[index][2], length*sizeof(float));
+      position += length;
+      result_rows += MX_ROWS(matrices[index]);
+    }
+  } else {
+    result_cols = 0;
+
+    for (uint32_t index = 0; index < count; index++) result_cols += MX_COLS(matrices[index]);
+
+    for (uint64_t row = 0; row < result_rows; row++) {
+      for (uint32_t index = 0; index < count; index++) {
+        const uint64_t cols = MX_COLS(matrices[index]);
+
+        memcpy(position, &matrices[index][2 + row*cols], cols*sizeof(float));
+        position += cols;
+      }
+    }
+  }
+
+  MX_SET_ROWS(result, result_rows);
+  MX_SET_COLS(result, result_cols);
+}
+
 void
 matrix_pow(const float scalar, const Matrix matrix, Matrix result) {
   const int64_t data_size = MX_LENGTH(matrix);
@@ -197,12 +462,15 @@ void
 matrix_divide(const Matrix first, const Matrix second, Matrix result) {
   const int64_t data_size = MX_LENGTH(first);
 
+  if (!same_size(first, second)) {
+    broadcast(first, second, matrix_simd->divide, 1, 1, result);
+    return;
+  }
+
   MX_SET_ROWS(result, MX_ROWS(first));
   MX_SET_COLS(result, MX_COLS(first));
 
-  for (int64_t index = 2; index < data_size; index += 1) {
-    result[index] = first[index] / second[index];
-  }
+  matrix_simd->divide(first + 2, second + 2, 1, 1, result + 2, data_size - 2);
 }
 
 void
@@ -212,9 +480,7 @@ matrix_divide_scalar(const float scalar, const Matrix divisor, Matrix result) {
   MX_SET_ROWS(result, MX_ROWS(divisor));
   MX_SET_COLS(result, MX_COLS(divisor));
 
-  for (int64_t index = 2; index < data_size; index += 1) {
-    result[index] = scalar / divisor[index];
-  }
+  matrix_simd->divide_scalar(divisor + 2, scalar, result + 2, data_size - 2);
 }
 
 void
@@ -224,9 +490,7 @@ matrix_divide_by_scalar(const Matrix dividend, const float scalar, Matrix result
   MX_SET_ROWS(result, MX_ROWS(dividend));
   MX_SET_COLS(result, MX_COLS(dividend));
 
-  for (uint64_t index = 2; index < data_size; index += 1) {
-    result[index] = dividend[index] / scalar;
-  }
+  matrix_simd->divide_by_scalar(dividend + 2, scalar, result + 2, data_size - 2);
 }
 
 void
@@ -264,24 +528,20 @@ matrix_fill(Matrix matrix, const float value) {
   }
 }
 
+// Finds the first element equal to value. NaN value finds the first NaN.
 int32_t
 matrix_find(const Matrix matrix, const float value) {
-  uint64_t data_size = MX_LENGTH(matrix);
+  reduce_args_t  args = { .find = matrix_simd->find, .rest_initial = value, .found = UINT64_MAX };
+  const uint64_t blocks = reduce_blocks(&args, matrix);
 
-  for (uint64_t index = 2; index < data_size; index += 1) {
-    if (matrix[index] == value) return index - 2;
-  }
-  return -1;
+  thread_pool_run(find_blocks, &args, blocks, 1);
+
+  return args.found == UINT64_MAX ? -1 : (int32_t) args.found;
 }
 
 int32_t
 matrix_find_nan(const Matrix matrix) {
-  const int64_t data_size = MX_LENGTH(matrix);
-
-  for (int64_t index = 2; index < data_size; index += 1) {
-    if (isnan(matrix[index])) return index - 2;
-  }
-  return -1;
+  return matrix_find(matrix, NAN);
 }
 
 float
@@ -342,70 +602,41 @@ matrix_inspect_internal(const Matrix matrix, int32_t indentation) {
 
 float
 matrix_max(const Matrix matrix) {
-  const uint64_t data_size = MX_LENGTH(matrix);
-  float   max       = matrix[2];
-
-  for (uint64_t index = 3; index < data_size; index += 1) {
-    if (max < matrix[index]) {
-      max = matrix[index];
-    }
-  }
-
-  return max;
+  return matrix_extremum(matrix, matrix_simd->max, matrix[2], -INFINITY);
 }
 
 float
 matrix_min(const Matrix matrix) {
-  const uint64_t data_size = MX_LENGTH(matrix);
-  float   min       = matrix[2];
-
-  for (uint64_t index = 3; index < data_size; index += 1) {
-    if (min > matrix[index]) {
-      min = matrix[index];
-    }
-  }
-
-  return min;
+  return matrix_extremum(matrix, matrix_simd->min, matrix[2], INFINITY);
 }
 
 float
 matrix_max_finite(const Matrix matrix) {
-  const uint64_t data_size = MX_LENGTH(matrix);
-  float   max       = NAN;
-
-  for (uint64_t index = 2; index < data_size; index += 1) {
-    if (isfinite(matrix[index]) && (isnan(max) || max < matrix[index])) {
-      max = matrix[index];
-    }
-  }
+  const float max = matrix_extremum(matrix, matrix_simd->max_finite, -INFINITY, -INFINITY);
 
-  return max;
+  return isinf(max) ? NAN : max;
 }
 
 float
 matrix_min_finite(const Matrix matrix) {
-  const uint64_t data_size = MX_LENGTH(matrix);
-  float   min       = NAN;
-
-  for (uint64_t index = 2; index < data_size; index += 1) {
-    if (isfinite(matrix[index]) && (isnan(min) || min > matrix[index])) {
-      min = matrix[index];
-    }
-  }
+  const float min = matrix_extremum(matrix, matrix_simd->min_finite, INFINITY, INFINITY);
 
-  return min;
+  return isinf(min) ? NAN : min;
 }
 
 void
 matrix_multiply(const Matrix first, const Matrix second, Matrix result) {
   uint64_t data_size = MX_LENGTH(first);
 
+  if (!same_size(first, second)) {
+    broadcast(first, second, matrix_simd->multiply, 1, 1, result);
+    return;
+  }
+
   MX_SET_ROWS(result, MX_ROWS(first));
   MX_SET_COLS(result, MX_COLS(first));
 
-  for (uint64_t index = 2; index < data_size; index += 1) {
-    result[index] = first[index] * second[index];
-  }
+  matrix_simd->multiply(first + 2, second + 2, 1, 1, result + 2, data_size - 2);
 }
 
 void
@@ -417,9 +648,7 @@ matrix_multiply_with_scalar(
   MX_SET_ROWS(result, MX_ROWS(matrix));
   MX_SET_COLS(result, MX_COLS(matrix));
 
-  for (uint64_t index = 2; index < data_size; index += 1) {
-    result[index] = matrix[index] * scalar;
-  }
+  matrix_simd->multiply_with_scalar(matrix + 2, scalar, result + 2, data_size - 2);
 }
 
 void
@@ -431,9 +660,7 @@ matrix_neg(
   MX_SET_ROWS(result, MX_ROWS(matrix));
   MX_SET_COLS(result, MX_COLS(matrix));
 
-  for (uint64_t index = 2; index < data_size; index += 1) {
-    result[index] = -matrix[index];
-  }
+  matrix_simd->neg(matrix + 2, 0, result + 2, data_size - 2);
 }
 
 void
@@ -452,17 +679,201 @@ matrix_normalize(const Matrix matrix, Matrix result) {
 }
 
 
-void
-matrix_random(Matrix matrix) {
-  uint64_t length = MX_LENGTH(matrix);
+typedef enum {
+  AXIS_SUM,
+  AXIS_MEAN,
+  AXIS_MAX,
+  AXIS_MIN,
+  AXIS_ARGMAX
+} axis_reduction_t;
+
+typedef struct {
+  const float      *data;
+  uint64_t          rows;
+  uint64_t          cols;
+  axis_reduction_t  reduction;
+  float            *result;
+} axis_args_t;
+
+static int
+axis_reduction_from_name(const char* name, axis_reduction_t *reduction) {
+  if (strcmp(name, "sum") == 0)         *reduction = AXIS_SUM;
+  else if (strcmp(name, "mean") == 0)   *reduction = AXIS_MEAN;
+  else if (strcmp(name, "max") == 0)    *reduction = AXIS_MAX;
+  else if (strcmp(name, "min") == 0)    *reduction = AXIS_MIN;
+  else if (strcmp(name, "argmax") == 0) *reduction = AXIS_ARGMAX;
+  else return 0;
 
-  // RNG is initialized in ELR_NIF_INIT load function.
+  return 1;
+}
 
-  for (uint64_t index = 2; index < length; index += 1) {
-    matrix[index] = (float)random()/(float)RAND_MAX;
+// Rows shorter than this are reduced by plain loops, which cost less than SIMD kernel calls.
+#define AXIS_SHORT_ROW 32
+
+static float
+reduce_short_row(const float *data, const uint64_t cols, const axis_reduction_t reduction) {
+  double   sum = 0.0;
+  float    extreme = data[0];
+  uint64_t index = 0;
+
+  switch (reduction) {
+    case AXIS_SUM:
+    case AXIS_MEAN:
+      for (uint64_t col = 0; col < cols; col += 1) sum += data[col];
+      return reduction == AXIS_SUM ? sum : sum / cols;
+    case AXIS_MAX:
+      for (uint64_t col = 1; col < cols; col += 1) extreme = extreme < data[col] ? data[col] : extreme;
+      return extreme;
+    case AXIS_MIN:
+      for (uint64_t col = 1; col < cols; col += 1) extreme = extreme > data[col] ? data[col] : extreme;
+      return extreme;
+    case AXIS_ARGMAX:
+      for (uint64_t col = 1; col < cols; col += 1) {
+        if (extreme < data[col]) {
+          extreme = data[col];
+          index   = col;
+        }
+      }
+      return index + 1;
+  }
+
+  return 0;
+}
+
+// Rows are contiguous, so each of them is reduced by a SIMD kernel.
+static void
+reduce_rows_chunk(void *args, uint64_t from, uint64_t to) {
+  const axis_args_t *axis = (const axis_args_t *)args;
+  float              max;
+
+  for (uint64_t row = from; row < to; row += 1) {
+    const float *data = axis->data + row*axis->cols;
+
+    if (axis->cols < AXIS_SHORT_ROW) {
+      axis->result[row] = reduce_short_row(data, axis->cols, axis->reduction);
+      continue;
+    }
+
+    switch (axis->reduction) {
+      case AXIS_SUM:
+        axis->result[row] = matrix_simd->sum(data, axis->cols);
+        break;
+      case AXIS_MEAN:
+        axis->result[row] = matrix_simd->sum(data, axis->cols) / axis->cols;
+        break;
+      case AXIS_MAX:
+        axis->result[row] = matrix_simd->max(data, data[0], axis->cols);
+        break;
+      case AXIS_MIN:
+        axis->result[row] = matrix_simd->min(data, data[0], axis->cols);
+        break;
+      case AXIS_ARGMAX:
+        axis->result[row] = matrix_simd->argmax(data, data[0], axis->cols, &max) + 1;
+        break;
+    }
+  }
+}
+
+// Column strips are accumulated in local arrays, which inner loops over strip width vectorize.
+static void
+reduce_strip(const axis_args_t *axis, const uint64_t first, const uint64_t width) {
+  double   sums[AXIS_STRIP];
+  float    extremes[AXIS_STRIP];
+  uint32_t indices[AXIS_STRIP];
+  float   *result = axis->result + first;
+
+  for (uint64_t col = 0; col < width; col += 1) {
+    sums[col]     = 0.0;
+    extremes[col] = axis->data[first + col];
+    indices[col]  = 0;
+  }
+
+  for (uint64_t row = 0; row < axis->rows; row += 1) {
+    const float *data = axis->data + row*axis->cols + first;
+
+    switch (axis->reduction) {
+      case AXIS_SUM:
+      case AXIS_MEAN:
+        for (uint64_t col = 0; col < width; col += 1) sums[col] += data[col];
+        break;
+      case AXIS_MAX:
+        for (uint64_t col = 0; col < width; col += 1) extremes[col] = extremes[col] < data[col] ? data[col] : extremes[col];
+        break;
+      case AXIS_MIN:
+        for (uint64_t col = 0; col < width; col += 1) extremes[col] = extremes[col] > data[col] ? data[col] : extremes[col];
+        break;
+      case AXIS_ARGMAX:
+        for (uint64_t col = 0; col < width; col += 1) {
+          const int32_t greater = extremes[col] < data[col];
+
+          extremes[col] = greater ? data[col] : extremes[col];
+          indices[col]  = greater ? (uint32_t)row : indices[col];
+        }
+        break;
+    }
+  }
+
+  for (uint64_t col = 0; col < width; col += 1) {
+    switch (axis->reduction) {
+      case AXIS_SUM:    result[col] = sums[col]; break;
+      case AXIS_MEAN:   result[col] = sums[col] / axis->rows; break;
+      case AXIS_MAX:
+      case AXIS_MIN:    result[col] = extremes[col]; break;
+      case AXIS_ARGMAX: result[col] = indices[col] + 1; break;
+    }
   }
 }
 
+static void
+reduce_columns_chunk(void *args, uint64_t from, uint64_t to) {
+  const axis_args_t *axis = (const axis_args_t *)args;
+
+  for (uint64_t strip = from; strip < to; strip += 1) {
+    const uint64_t first = strip*AXIS_STRIP;
+
+    reduce_strip(axis, first, axis->cols - first < AXIS_STRIP ? axis->cols - first : AXIS_STRIP);
+  }
+}
+
+int
+matrix_reduce_rows(const Matrix matrix, const char* reduction_name, Matrix result) {
+  axis_args_t args = { matrix + 2, MX_ROWS(matrix), MX_COLS(matrix), AXIS_SUM, result + 2 };
+
+  if (!axis_reduction_from_name(reduction_name, &args.reduction)) return 0;
+
+  MX_SET_ROWS(result, args.rows);
+  MX_SET_COLS(result, 1);
+
+  if (args.cols == 0) {
+    for (uint64_t row = 0; row < args.rows; row += 1) args.result[row] = 0;
+    return 1;
+  }
+
+  thread_pool_run(reduce_rows_chunk, &args, args.rows, AXIS_PARALLEL_GRAIN / args.cols + 1);
+
+  return 1;
+}
+
+int
+matrix_reduce_columns(const Matrix matrix, const char* reduction_name, Matrix result) {
+  axis_args_t    args = { matrix + 2, MX_ROWS(matrix), MX_COLS(matrix), AXIS_SUM, result + 2 };
+  const uint64_t strips = (args.cols + AXIS_STRIP - 1) / AXIS_STRIP;
+
+  if (!axis_reduction_from_name(reduction_name, &args.reduction)) return 0;
+
+  MX_SET_ROWS(result, 1);
+  MX_SET_COLS(result, args.cols);
+
+  if (args.rows == 0) {
+    for (uint64_t col = 0; col < args.cols; col += 1) args.result[col] = 0;
+    return 1;
+  }
+
+  thread_pool_run(reduce_columns_chunk, &args, strips, AXIS_PARALLEL_GRAIN / (args.rows*AXIS_STRIP) + 1);
+
+  return 1;
+}
+
 void
 matrix_resize(const Matrix matrix, const int32_t new_rows, const int32_t new_cols, Matrix result) {
   MX_SET_ROWS(result, new_rows);
@@ -520,12 +931,15 @@ void
 matrix_subtract(const Matrix first, const Matrix second, Matrix result) {
   uint64_t data_size = MX_LENGTH(first);
 
+  if (!same_size(first, second)) {
+    broadcast(first, second, matrix_simd->subtract, 1, 1, result);
+    return;
+  }
+
   MX_SET_ROWS(result, MX_ROWS(first));
   MX_SET_COLS(result, MX_COLS(first));
 
-  for (uint64_t index = 2; index < data_size; index += 1) {
-    result[index] = first[index] - second[index];
-  }
+  matrix_simd->subtract(first + 2, second + 2, 1, 1, result + 2, data_size - 2);
 }
 
 void
@@ -535,38 +949,261 @@ matrix_subtract_from_scalar(const float scalar, const Matrix matrix, Matrix resu
   MX_SET_ROWS(result, MX_ROWS(matrix));
   MX_SET_COLS(result, MX_COLS(matrix));
 
-  for (uint64_t index = 2; index < data_size; index += 1) {
-    result[index] = scalar - matrix[index];
-  }
+  matrix_simd->subtract_from_scalar(matrix + 2, scalar, result + 2, data_size - 2);
 }
 
+// Adds up sums of blocks by halves, so rounding errors grow with the logarithm of their number.
+static double
+pairwise_sum(const double *sums, const uint64_t count) {
+  if (count == 0) return 0.0;
+  if (count == 1) return sums[0];
+
+  return pairwise_sum(sums, count / 2) + pairwise_sum(sums + count / 2, count - count / 2);
+}
+
+// Sums blocks in double precision vector lanes, then adds up block sums pairwise.
 double
 matrix_sum(const Matrix matrix) {
-  uint64_t data_size = MX_LENGTH(matrix);
-  double   sum       = 0.0;
+  double         sums[REDUCE_MAX_BLOCKS];
+  reduce_args_t  args = { .sum = matrix_simd->sum, .sums = sums };
+  const uint64_t blocks = reduce_blocks(&args, matrix);
 
-  for (uint64_t index = 2; index < data_size; index += 1) {
-    sum += matrix[index];
+  thread_pool_run(sum_blocks, &args, blocks, 1);
+
+  return pairwise_sum(sums, blocks);
+}
+
+// Compensated summation, accurate to the last bit of the double result in most cases.
+// Compensations of the blocks are added up apart from their sums, and to the total only at the end.
+double
+matrix_sum_kahan(const Matrix matrix) {
+  double         sums[REDUCE_MAX_BLOCKS], compensations[REDUCE_MAX_BLOCKS];
+  reduce_args_t  args = { .sum_kahan = matrix_simd->sum_kahan, .sums = sums, .compensations = compensations };
+  const uint64_t blocks = reduce_blocks(&args, matrix);
+  double         total = 0.0, compensation = 0.0;
+
+  thread_pool_run(sum_blocks, &args, blocks, 1);
+
+  for (uint64_t block = 0; block < blocks; block += 1) {
+    const double next = total + sums[block];
+
+    compensation += fabs(total) >= fabs(sums[block]) ? (total - next) + sums[block] : (sums[block] - next) + total;
+    compensation += compensations[block];
+    total = next;
   }
 
-  return sum;
+  return total + compensation;
 }
 
-void
-matrix_transpose(const Matrix matrix, Matrix result) {
-  MX_SET_ROWS(result, MX_COLS(matrix));
-  MX_SET_COLS(result, MX_ROWS(matrix));
+// Transposes 4×4 block in registers. SSE2 and NEON have native shuffles of this width.
+static inline __attribute__((always_inline)) void
+transpose_block_4x4(const float *source, const uint64_t source_stride, float *target, const uint64_t target_stride) {
+  typedef float v4sf __attribute__((vector_size(16), aligned(4), may_alias));
+  typedef int32_t v4si __attribute__((vector_size(16)));
+  const v4si low = {0, 4, 1, 5}, high = {2, 6, 3, 7}, low_pairs = {0, 1, 4, 5}, high_pairs = {2, 3, 6, 7};
+
+  const v4sf r0 = *(const v4sf *)(source);
+  const v4sf r1 = *(const v4sf *)(source + source_stride);
+  const v4sf r2 = *(const v4sf *)(source + 2*source_stride);
+  const v4sf r3 = *(const v4sf *)(source + 3*source_stride);
+
+  const v4sf t0 = __builtin_shuffle(r0, r1, low), t1 = __builtin_shuffle(r0, r1, high);
+  const v4sf t2 = __builtin_shuffle(r2, r3, low), t3 = __builtin_shuffle(r2, r3, high);
+
+  *(v4sf *)(target)                   = __builtin_shuffle(t0, t2, low_pairs);
+  *(v4sf *)(target + target_stride)   = __builtin_shuffle(t0, t2, high_pairs);
+  *(v4sf *)(target + 2*target_stride) = __builtin_shuffle(t1, t3, low_pairs);
+  *(v4sf *)(target + 3*target_stride) = __builtin_shuffle(t1, t3, high_pairs);
+}
+
+// Transposes 8×8 block in registers: interleaves pairs of rows, then pairs of pairs,
+// then swaps 128-bit halves. Only worth it with 256-bit registers.
+static inline __attribute__((always_inline)) void
+transpose_block_8x8(const float *source, const uint64_t source_stride, float *target, const uint64_t target_stride) {
+  typedef float v8sf __attribute__((vector_size(32), aligned(4), may_alias));
+  typedef int32_t v8si __attribute__((vector_size(32)));
+  const v8si low = {0, 8, 1, 9, 4, 12, 5, 13}, high = {2, 10, 3, 11, 6, 14, 7, 15};
+  const v8si low_pairs = {0, 1, 8, 9, 4, 5, 12, 13}, high_pairs = {2, 3, 10, 11, 6, 7, 14, 15};
+  const v8si low_halves = {0, 1, 2, 3, 8, 9, 10, 11}, high_halves = {4, 5, 6, 7, 12, 13, 14, 15};
+  v8sf r[8], t[8], u[8];
+
+  for (int i = 0; i < 8; i += 1) r[i] = *(const v8sf *)(source + i*source_stride);
+
+  for (int i = 0; i < 8; i += 2) {
+    t[i]     = __builtin_shuffle(r[i], r[i + 1], low);
+    t[i + 1] = __builtin_shuffle(r[i], r[i + 1], high);
+  }
+
+  for (int i = 0; i < 8; i += 4) {
+    u[i]     = __builtin_shuffle(t[i],     t[i + 2], low_pairs);
+    u[i + 1] = __builtin_shuffle(t[i],     t[i + 2], high_pairs);
+    u[i + 2] = __builtin_shuffle(t[i + 1], t[i + 3], low_pairs);
+    u[i + 3] = __builtin_shuffle(t[i + 1], t[i + 3], high_pairs);
+  }
+
+  for (int i = 0; i < 4; i += 1) {
+    *(v8sf *)(target + i*target_stride)       = __builtin_shuffle(u[i], u[i + 4], low_halves);
+    *(v8sf *)(target + (i + 4)*target_stride) = __builtin_shuffle(u[i], u[i + 4], high_halves);
+  }
+}
+
+typedef void (*transpose_tile_t)(
+  const float *source, const uint64_t source_stride, float *target, const uint64_t target_stride,
+  const uint64_t rows, const uint64_t cols
+);
+
+// Transposes rows × cols tile, block by block. Edges, not filling a whole block, are copied one by one.
+static inline __attribute__((always_inline)) void
+transpose_tile_body(
+  const float *source, const uint64_t source_stride, float *target, const uint64_t target_stride,
+  const uint64_t rows, const uint64_t cols, const uint64_t block
+) {
+  uint64_t row = 0;
+
+  for (; row + block <= rows; row += block) {
+    uint64_t col = 0;
+
+    for (; col + block <= cols; col += block) {
+      const float *from = source + row*source_stride + col;
+      float       *to   = target + col*target_stride + row;
+
+      if (block == 8)
+        transpose_block_8x8(from, source_stride, to, target_stride);
+      else
+        transpose_block_4x4(from, source_stride, to, target_stride);
+    }
+
+    for (; col < cols; col += 1)
+      for (uint64_t r = row; r < row + block; r += 1)
+        target[col*target_stride + r] = source[r*source_stride + col];
+  }
+
+  for (; row < rows; row += 1)
+    for (uint64_t col = 0; col < cols; col += 1)
+      target[col*target_stride + row] = source[row*source_stride + col];
+}
+
+static void
+transpose_tile_generic(
+  const float *source, const uint64_t source_stride, float *target, const uint64_t target_stride,
+  const uint64_t rows, const uint64_t cols
+) {
+  transpose_tile_body(source, source_stride, target, target_stride, rows, cols, 4);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("avx2"))) static void
+transpose_tile_avx2(
+  const float *source, const uint64_t source_stride, float *target, const uint64_t target_stride,
+  const uint64_t rows, const uint64_t cols
+) {
+  transpose_tile_body(source, source_stride, target, target_stride, rows, cols, 8);
+}
+
+static transpose_tile_t
+select_transpose_tile(void) {
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2"))
+    return transpose_tile_avx2;
+
+  return transpose_tile_generic;
+}
+
+#else
+
+static transpose_tile_t
+select_transpose_tile(void) {
+  return transpose_tile_generic;
+}
+
+#endif
+
+typedef struct {
+  const float      *source;
+  float            *target;
+  uint64_t          rows;
+  uint64_t          cols;
+  transpose_tile_t  transpose_tile;
+} transpose_args_t;
+
+static inline uint64_t
+tile_size(const uint64_t tile, const uint64_t length) {
+  return length - tile*TRANSPOSE_TILE < TRANSPOSE_TILE ? length - tile*TRANSPOSE_TILE : TRANSPOSE_TILE;
+}
+
+// Transposes rows of tiles [from, to) of the source.
+static void
+transpose_chunk(void *args, uint64_t from, uint64_t to) {
+  const transpose_args_t *transpose = (const transpose_args_t *)args;
+  const uint64_t rows = transpose->rows, cols = transpose->cols;
 
-  for (uint64_t row = 0; row < MX_ROWS(matrix); row += 1) {
-    for (uint64_t column = 0; column < MX_COLS(matrix); column += 1) {
-      uint64_t result_index = column * MX_COLS(result) + row    + 2;
-      uint64_t matrix_index = row *    MX_COLS(matrix) + column + 2;
+  for (uint64_t tile_row = from; tile_row < to; tile_row += 1) {
+    for (uint64_t tile_col = 0; tile_col*TRANSPOSE_TILE < cols; tile_col += 1) {
+      const uint64_t row = tile_row*TRANSPOSE_TILE, col = tile_col*TRANSPOSE_TILE;
 
-      result[result_index] = matrix[matrix_index];
+      transpose->transpose_tile(
+        transpose->source + row*cols + col, cols, transpose->target + col*rows + row, rows,
+        tile_size(tile_row, rows), tile_size(tile_col, cols)
+      );
     }
   }
 }
 
+// Transposes tiles on and right of the diagonal of square matrix, swapping each with its mirror tile.
+// Rows of tiles [from, to) of different chunks touch disjoint pairs of tiles.
+static void
+transpose_in_place_chunk(void *args, uint64_t from, uint64_t to) {
+  const transpose_args_t *transpose = (const transpose_args_t *)args;
+  const uint64_t size = transpose->rows;
+  float *matrix = transpose->target;
+  float  buffer[TRANSPOSE_TILE*TRANSPOSE_TILE];
+
+  for (uint64_t tile_row = from; tile_row < to; tile_row += 1) {
+    for (uint64_t tile_col = tile_row; tile_col*TRANSPOSE_TILE < size; tile_col += 1) {
+      const uint64_t row = tile_row*TRANSPOSE_TILE, col = tile_col*TRANSPOSE_TILE;
+      const uint64_t rows = tile_size(tile_row, size), cols = tile_size(tile_col, size);
+      float *tile = matrix + row*size + col, *mirror = matrix + col*size + row;
+
+      transpose->transpose_tile(tile, size, buffer, rows, rows, cols);
+      if (tile != mirror) transpose->transpose_tile(mirror, size, tile, size, cols, rows);
+
+      for (uint64_t r = 0; r < cols; r += 1)
+        memcpy(mirror + r*size, buffer + r*rows, rows*sizeof(float));
+    }
+  }
+}
+
+void
+matrix_transpose(const Matrix matrix, Matrix result) {
+  const uint64_t rows = MX_ROWS(matrix), cols = MX_COLS(matrix);
+  transpose_args_t args = { matrix + 2, result + 2, rows, cols, select_transpose_tile() };
+
+  MX_SET_ROWS(result, cols);
+  MX_SET_COLS(result, rows);
+
+  if (cols == 0) return;
+
+  thread_pool_run(
+    transpose_chunk, &args, (rows + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE,
+    TRANSPOSE_PARALLEL_GRAIN / (TRANSPOSE_TILE*cols) + 1
+  );
+}
+
+void
+matrix_transpose_in_place(Matrix matrix) {
+  const uint64_t size = MX_ROWS(matrix);
+  transpose_args_t args = { matrix + 2, matrix + 2, size, size, select_transpose_tile() };
+
+  if (size == 0) return;
+
+  thread_pool_run(
+    transpose_in_place_chunk, &args, (size + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE,
+    TRANSPOSE_PARALLEL_GRAIN / (TRANSPOSE_TILE*size) + 1
+  );
+}
+
 
 void
 matrix_zeros(Matrix matrix) {
@@ -0,0 +1,401 @@
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/matrix_csv.h"
+
+/*
+
+Matrix text reading and writing.
+
+Elements are parsed the way fast_float does it for most of them: up to 19 significant digits are
+accumulated into an integer mantissa and, when it fits into double's 53 bits and the decimal exponent
+is within ±22, where powers of ten are exact doubles, a single multiplication or division rounds
+the result correctly. Longer or more extreme elements fall back to strtod().
+
+Writing tries 6 to 9 significant digits, rounding the float to them, and keeps the first text,
+which reads back into the same float. Six digits and less always fit in normal float precision,
+so when there's a shorter round-trip text, rounding to six digits and stripping trailing zeros
+finds it, and nine digits always round-trip. Subnormals start from one digit.
+
+*/
+
+#define CSV_INITIAL_CAPACITY 1024
+#define CSV_MANTISSA_DIGITS 19
+
+static const double powers_of_ten[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const uint64_t integer_powers_of_ten[] = {
+  1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+static inline int
+is_digit(const char c) {
+  return c >= '0' && c <= '9';
+}
+
+static inline int
+element_separator(const char c) {
+  return c == ',' || c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline int
+row_separator(const char c) {
+  return c == '\n' || c == ';';
+}
+
+static inline int
+separator(const char c) {
+  return element_separator(c) || row_separator(c);
+}
+
+// Returns special value length, when text is one of them.
+// NaN is the negative quiet one, which x86 arithmetic produces and Matrex reads as :nan.
+static int
+parse_special(const char *text, const uint32_t length, float *value) {
+  if (length == 3 && memcmp(text, "NaN", 3) == 0) *value = -NAN;
+  else if (length == 3 && memcmp(text, "Inf", 3) == 0) *value = INFINITY;
+  else if (length == 4 && memcmp(text, "+Inf", 4) == 0) *value = INFINITY;
+  else if (length == 4 && memcmp(text, "-Inf", 4) == 0) *value = -INFINITY;
+  else if (length == 6 && memcmp(text, "NegInf", 6) == 0) *value = -INFINITY;
+  else return 0;
+
+  return 1;
+}
+
+int
+matrix_csv_parse_float(const char *text, const uint32_t length, float *value) {
+  const char *position = text, *end = text + length;
+  uint64_t    mantissa = 0;
+  int64_t     exponent = 0, exponent_value = 0;
+  int32_t     digits = 0;
+  int         negative = 0, exponent_negative = 0, truncated = 0, any_digit = 0;
+  double      result;
+  char        buffer[CSV_TOKEN_MAX + 1];
+
+  if (length == 0 || length > CSV_TOKEN_MAX) return 0;
+  if (parse_special(text, length, value)) return 1;
+
+  if (*position == '+' || *position == '-') negative = *position++ == '-';
+
+  // Leading zeros don't count as significant digits, digits past the mantissa only scale it.
+  for (; position < end && is_digit(*position); position++) {
+    any_digit = 1;
+    if (digits < CSV_MANTISSA_DIGITS) {
+      mantissa = mantissa*10 + (*position - '0');
+      if (mantissa != 0) digits++;
+    } else {
+      exponent++;
+      truncated |= *position != '0';
+    }
+  }
+
+  if (position < end && *position == '.') {
+    for (position++; position < end && is_digit(*position); position++) {
+      any_digit = 1;
+      if (digits < CSV_MANTISSA_DIGITS) {
+        mantissa = mantissa*10 + (*position - '0');
+        if (mantissa != 0) digits++;
+        exponent--;
+      } else {
+        truncated |= *position != '0';
+      }
+    }
+  }
+
+  if (!any_digit) return 0;
+
+  if (position < end && (*position == 'e' || *position == 'E')) {
+    position++;
+    if (position < end && (*position == '+' || *position == '-'))
+      exponent_negative = *position++ == '-';
+    if (position == end || !is_digit(*position)) return 0;
+
+    for (; position < end && is_digit(*position); position++)
+      if (exponent_value < 100000) exponent_value = exponent_value*10 + (*position - '0');
+
+    exponent += exponent_negative ? -exponent_value : exponent_value;
+  }
+
+  if (position != end) return 0;
+
+  if (mantissa == 0) {
+    result = 0.0;
+  } else if (!truncated && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+    result = exponent < 0 ?
+      (double) mantissa / powers_of_ten[-exponent] : (double) mantissa * powers_of_ten[exponent];
+  } else {
+    memcpy(buffer, text, length);
+    buffer[length] = '\0';
+    result = fabs(strtod(buffer, NULL));
+  }
+
+  *value = (float) (negative ? -result : result);
+  return 1;
+}
+
+// magnitude * 10^power, exact when power is within ±22 and the product fits into double.
+static double
+scale(double magnitude, int32_t power) {
+  for (; power > 22; power -= 22) magnitude *= powers_of_ten[22];
+  for (; power < -22; power += 22) magnitude /= powers_of_ten[22];
+
+  return power < 0 ? magnitude / powers_of_ten[-power] : magnitude * powers_of_ten[power];
+}
+
+// Writes `count` significant digits with the first one at 10^exponent, as fixed point number
+// for exponents from -4 to 8 and in scientific notation otherwise, like %g does.
+static uint32_t
+write_digits(const char *digits, const int32_t count, const int32_t exponent, const int negative, char *out) {
+  uint32_t length = 0;
+  int32_t  index, absolute_exponent;
+  char     exponent_digits[4];
+
+  if (negative) out[length++] = '-';
+
+  if (exponent >= 0 && exponent <= 8) {
+    for (index = 0; index <= exponent; index++) out[length++] = index < count ? digits[index] : '0';
+    if (count > exponent + 1) {
+      out[length++] = '.';
+      for (; index < count; index++) out[length++] = digits[index];
+    }
+  } else if (exponent < 0 && exponent >= -4) {
+    out[length++] = '0';
+    out[length++] = '.';
+    for (index = -1; index > exponent; index--) out[length++] = '0';
+    for (index = 0; index < count; index++) out[length++] = digits[index];
+  } else {
+    out[length++] = digits[0];
+    if (count > 1) {
+      out[length++] = '.';
+      for (index = 1; index < count; index++) out[length++] = digits[index];
+    }
+    out[length++] = 'e';
+    if (exponent < 0) out[length++] = '-';
+
+    absolute_exponent = abs(exponent);
+    for (index = 0; absolute_exponent > 0 || index == 0; absolute_exponent /= 10)
+      exponent_digits[index++] = '0' + absolute_exponent % 10;
+    while (index > 0) out[length++] = exponent_digits[--index];
+  }
+
+  return length;
+}
+
+uint32_t
+matrix_csv_format_float(const float value, char *out) {
+  double   magnitude = fabs((double) value);
+  uint64_t rounded;
+  int32_t  exponent, digits_exponent, precision, count, index;
+  uint32_t length;
+  float    parsed;
+  char     digits[10];
+
+  if (isnan(value)) {
+    memcpy(out, "NaN", 3);
+    return 3;
+  }
+
+  if (isinf(value)) {
+    memcpy(out, value > 0 ? "Inf" : "-Inf", value > 0 ? 3 : 4);
+    return value > 0 ? 3 : 4;
+  }
+
+  // Zeros are saved without fraction part to save space.
+  if (value == 0) {
+    out[0] = '0';
+    return 1;
+  }
+
+  // Decimal exponent of the first significant digit, log10() may be one off near powers of ten.
+  exponent = (int32_t) floor(log10(magnitude));
+  if (scale(magnitude, -exponent) >= 10.0) exponent++;
+  else if (scale(magnitude, -exponent) < 1.0) exponent--;
+
+  // Subnormals have fewer significant bits, so their shortest text may be shorter than six digits.
+  for (precision = magnitude < FLT_MIN ? 1 : 6; precision <= 9; precision++) {
+    rounded = (uint64_t) (scale(magnitude, precision - 1 - exponent) + 0.5);
+    digits_exponent = exponent;
+
+    // Rounding up to the next power of ten.
+    if (rounded >= integer_powers_of_ten[precision]) {
+      rounded /= 10;
+      digits_exponent++;
+    }
+
+    for (count = precision; count > 1 && rounded % 10 == 0; count--) rounded /= 10;
+    for (index = count - 1; index >= 0; index--, rounded /= 10) digits[index] = '0' + rounded % 10;
+
+    length = write_digits(digits, count, digits_exponent, value < 0, out);
+    if (matrix_csv_parse_float(out, length, &parsed) && parsed == value) return length;
+  }
+
+  // Double rounding of the scaled value may miss by one in the last digit, printf never does.
+  return snprintf(out, CSV_ELEMENT_MAX, "%.8e", (double) value);
+}
+
+uint64_t
+matrix_csv_write(const Matrix matrix, const uint32_t from_row, const uint32_t rows, char *out) {
+  const uint64_t cols = MX_COLS(matrix);
+  const float   *data = &matrix[2] + (uint64_t) from_row*cols;
+  uint64_t       length = 0, row, col;
+
+  for (row = 0; row < rows; row++) {
+    for (col = 0; col < cols; col++) {
+      length += matrix_csv_format_float(data[row*cols + col], out + length);
+      out[length++] = col + 1 < cols ? ',' : '\n';
+    }
+  }
+
+  return length;
+}
+
+void
+matrix_csv_reader_init(CsvReader *reader) {
+  memset(reader, 0, sizeof(CsvReader));
+
+  // Room for the header.
+  reader->length = 2;
+}
+
+static int
+fail(CsvReader *reader, const csv_error_t error) {
+  reader->error = error;
+  return 0;
+}
+
+static int
+read_element(CsvReader *reader, const char *text, const uint32_t length) {
+  uint64_t capacity;
+  float   *values;
+  float    value;
+
+  if (!matrix_csv_parse_float(text, length, &value)) {
+    reader->token_length = length < CSV_TOKEN_MAX ? length : CSV_TOKEN_MAX;
+    memmove(reader->token, text, reader->token_length);
+    reader->token[reader->token_length] = '\0';
+    return fail(reader, CSV_INVALID_ELEMENT);
+  }
+
+  if (reader->rows > 0 && reader->row_cols == reader->cols) return fail(reader, CSV_RAGGED_ROWS);
+  if (reader->row_cols == UINT32_MAX) return fail(reader, CSV_TOO_LARGE);
+
+  if (reader->length >= reader->capacity) {
+    capacity = reader->capacity == 0 ? CSV_INITIAL_CAPACITY : 2*reader->capacity;
+    values = (float *) realloc(reader->values, capacity*sizeof(float));
+    if (values == NULL) return fail(reader, CSV_OUT_OF_MEMORY);
+
+    reader->values = values;
+    reader->capacity = capacity;
+  }
+
+  reader->values[reader->length++] = value;
+  reader->row_cols++;
+
+  return 1;
+}
+
+static int
+read_row_end(CsvReader *reader) {
+  if (reader->row_cols == 0) return 1;
+
+  if (reader->rows == 0) reader->cols = reader->row_cols;
+  else if (reader->row_cols != reader->cols) return fail(reader, CSV_RAGGED_ROWS);
+
+  if (reader->rows == UINT32_MAX) return fail(reader, CSV_TOO_LARGE);
+
+  reader->rows++;
+  reader->row_cols = 0;
+
+  return 1;
+}
+
+int
+matrix_csv_read(CsvReader *reader, const char *text, const uint64_t size) {
+  uint64_t position = 0, start;
+  uint32_t length;
+
+  if (reader->error != CSV_OK) return 0;
+
+  // Completes the element, which the previous chunk ended with.
+  if (reader->token_length > 0) {
+    for (; position < size && !separator(text[position]); position++) {
+      if (reader->token_length == CSV_TOKEN_MAX) return read_element(reader, reader->token, CSV_TOKEN_MAX + 1);
+      reader->token[reader->token_length++] = text[position];
+    }
+    if (position == size) return 1;
+
+    length = reader->token_length;
+    reader->token_length = 0;
+    if (!read_element(reader, reader->token, length)) return 0;
+  }
+
+  while (position < size) {
+    if (row_separator(text[position])) {
+      if (!read_row_end(reader)) return 0;
+      position++;
+      continue;
+    }
+
+    if (element_separator(text[position])) {
+      position++;
+      continue;
+    }
+
+    start = position;
+    while (position < size && !separator(text[position])) position++;
+
+    length = position - start > CSV_TOKEN_MAX ? CSV_TOKEN_MAX + 1 : position - start;
+
+    // The element may continue in the next chunk.
+    if (position == size && length <= CSV_TOKEN_MAX) {
+      memcpy(reader->token, text + start, length);
+      reader->token_length = length;
+      return 1;
+    }
+
+    if (!read_element(reader, text + start, length)) return 0;
+  }
+
+  return 1;
+}
+
+Matrix
+matrix_csv_finish(CsvReader *reader) {
+  uint32_t length = reader->token_length;
+  float   *values;
+
+  if (reader->error != CSV_OK) return NULL;
+
+  reader->token_length = 0;
+  if (length > 0 && !read_element(reader, reader->token, length)) return NULL;
+  if (!read_row_end(reader)) return NULL;
+
+  if (reader->rows == 0) {
+    fail(reader, CSV_EMPTY);
+    return NULL;
+  }
+
+  // Gives the unused capacity back.
+  values = (float *) realloc(reader->values, reader->length*sizeof(float));
+  if (values != NULL) {
+    reader->values = values;
+    reader->capacity = reader->length;
+  }
+
+  MX_SET_ROWS(reader->values, reader->rows);
+  MX_SET_COLS(reader->values, reader->cols);
+
+  return reader->values;
+}
+
+void
+matrix_csv_reader_free(CsvReader *reader) {
+  free(reader->values);
+  reader->values = NULL;
+}
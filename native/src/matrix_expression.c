@@ -0,0 +1,205 @@
+#include <string.h>
+
+#include "../include/matrix_expression.h"
+#include "../include/thread_pool.h"
+
+// Stack value: a block of matrix elements or a scalar, when `data` is NULL.
+typedef struct {
+  const float *data;
+  float        scalar;
+} expression_value_t;
+
+typedef struct {
+  const expression_instruction_t *program;
+  uint32_t                        length;
+  const Matrix                   *operands;
+  uint64_t                        size;
+  float                          *result;
+} expression_args_t;
+
+// Checks that the program never pops from empty stack, fits in EXPRESSION_MAX_DEPTH values
+// and leaves exactly one matrix value on the stack.
+static int
+expression_valid(
+  const expression_instruction_t *program, const uint32_t length, const uint32_t operands_count
+) {
+  int      is_matrix[EXPRESSION_MAX_DEPTH];
+  uint32_t depth = 0;
+
+  if (length == 0 || length > EXPRESSION_MAX_LENGTH) return 0;
+
+  for (uint32_t index = 0; index < length; index += 1) {
+    switch (program[index].opcode) {
+      case EXPRESSION_LOAD:
+      case EXPRESSION_SCALAR:
+        if (depth == EXPRESSION_MAX_DEPTH) return 0;
+        if (program[index].opcode == EXPRESSION_LOAD && program[index].operand >= operands_count) return 0;
+
+        is_matrix[depth] = program[index].opcode == EXPRESSION_LOAD;
+        depth += 1;
+        break;
+      case EXPRESSION_ADD:
+      case EXPRESSION_SUBTRACT:
+      case EXPRESSION_MULTIPLY:
+      case EXPRESSION_DIVIDE:
+        if (depth < 2) return 0;
+
+        depth -= 1;
+        is_matrix[depth - 1] = is_matrix[depth - 1] || is_matrix[depth];
+        break;
+      case EXPRESSION_NEG:
+      case EXPRESSION_APPLY:
+        if (depth < 1) return 0;
+        if (program[index].opcode == EXPRESSION_APPLY && program[index].func == NULL) return 0;
+        break;
+      default:
+        return 0;
+    }
+  }
+
+  return depth == 1 && is_matrix[0];
+}
+
+static float
+scalar_binary(const expression_opcode_t opcode, const float a, const float b) {
+  switch (opcode) {
+    case EXPRESSION_ADD:      return a + b;
+    case EXPRESSION_SUBTRACT: return a - b;
+    case EXPRESSION_MULTIPLY: return a * b;
+    default:                  return a / b;
+  }
+}
+
+// Writes result of binary operation on a block into `out`. Operations with scalars use the same
+// kernels as the corresponding Matrex functions do, so results are the same, as if computed step by step.
+static void
+block_binary(
+  const expression_opcode_t opcode, const expression_value_t a, const expression_value_t b,
+  float *out, const uint64_t width
+) {
+  if (a.data != NULL && b.data != NULL) {
+    switch (opcode) {
+      case EXPRESSION_ADD:      matrix_simd->add(a.data, b.data, 1, 1, out, width); break;
+      case EXPRESSION_SUBTRACT: matrix_simd->subtract(a.data, b.data, 1, 1, out, width); break;
+      case EXPRESSION_MULTIPLY: matrix_simd->multiply(a.data, b.data, 1, 1, out, width); break;
+      default:                  matrix_simd->divide(a.data, b.data, 1, 1, out, width); break;
+    }
+  } else if (a.data != NULL) {
+    switch (opcode) {
+      case EXPRESSION_ADD:      matrix_simd->add_scalar(a.data, b.scalar, out, width); break;
+      case EXPRESSION_SUBTRACT: matrix_simd->add_scalar(a.data, -b.scalar, out, width); break;
+      case EXPRESSION_MULTIPLY: matrix_simd->multiply_with_scalar(a.data, b.scalar, out, width); break;
+      default:                  matrix_simd->divide_by_scalar(a.data, b.scalar, out, width); break;
+    }
+  } else {
+    switch (opcode) {
+      case EXPRESSION_ADD:      matrix_simd->add_scalar(b.data, a.scalar, out, width); break;
+      case EXPRESSION_SUBTRACT: matrix_simd->subtract_from_scalar(b.data, a.scalar, out, width); break;
+      case EXPRESSION_MULTIPLY: matrix_simd->multiply_with_scalar(b.data, a.scalar, out, width); break;
+      default:                  matrix_simd->divide_scalar(b.data, a.scalar, out, width); break;
+    }
+  }
+}
+
+static void
+block_unary(const expression_instruction_t *instruction, const float *data, float *out, const uint64_t width) {
+  if (instruction->opcode == EXPRESSION_NEG) {
+    matrix_simd->neg(data, 0, out, width);
+  } else if (instruction->simd_func != NULL) {
+    instruction->simd_func(data, 0, out, width);
+  } else {
+    for (uint64_t index = 0; index < width; index += 1) out[index] = instruction->func(data[index]);
+  }
+}
+
+// Runs the program on each block. Value at stack position N is computed into register N,
+// and the last instruction writes directly into the result.
+static void
+eval_blocks(void *args, uint64_t from, uint64_t to) {
+  const expression_args_t *expression = (const expression_args_t *)args;
+  float                    registers[EXPRESSION_MAX_DEPTH][EXPRESSION_BLOCK];
+  expression_value_t       stack[EXPRESSION_MAX_DEPTH];
+
+  for (uint64_t block = from; block < to; block += 1) {
+    const uint64_t offset = block*EXPRESSION_BLOCK;
+    const uint64_t width  = expression->size - offset < EXPRESSION_BLOCK ? expression->size - offset : EXPRESSION_BLOCK;
+    float         *result = expression->result + offset;
+    uint32_t       depth  = 0;
+
+    for (uint32_t index = 0; index < expression->length; index += 1) {
+      const expression_instruction_t *instruction = &expression->program[index];
+      const int                       last = index + 1 == expression->length;
+      expression_value_t             *top;
+
+      switch (instruction->opcode) {
+        case EXPRESSION_LOAD:
+          stack[depth].data = expression->operands[instruction->operand] + 2 + offset;
+          depth += 1;
+          break;
+        case EXPRESSION_SCALAR:
+          stack[depth].data   = NULL;
+          stack[depth].scalar = instruction->scalar;
+          depth += 1;
+          break;
+        case EXPRESSION_NEG:
+        case EXPRESSION_APPLY:
+          top = &stack[depth - 1];
+
+          if (top->data == NULL) {
+            top->scalar = instruction->opcode == EXPRESSION_NEG ? -top->scalar : instruction->func(top->scalar);
+          } else {
+            float *out = last ? result : registers[depth - 1];
+
+            block_unary(instruction, top->data, out, width);
+            top->data = out;
+          }
+          break;
+        default:
+          depth -= 1;
+          top = &stack[depth - 1];
+
+          if (top->data == NULL && stack[depth].data == NULL) {
+            top->scalar = scalar_binary(instruction->opcode, top->scalar, stack[depth].scalar);
+          } else {
+            float *out = last ? result : registers[depth - 1];
+
+            block_binary(instruction->opcode, *top, stack[depth], out, width);
+            top->data = out;
+          }
+          break;
+      }
+    }
+
+    // Programs, which end with loading an operand, only copy it.
+    if (stack[0].data != result) memcpy(result, stack[0].data, width*sizeof(float));
+  }
+}
+
+int
+matrix_expression_eval(
+  const expression_instruction_t *program, const uint32_t length,
+  const Matrix *operands, const uint32_t operands_count, Matrix result
+) {
+  expression_args_t args;
+  uint64_t          blocks;
+
+  if (!expression_valid(program, length, operands_count)) return 0;
+
+  for (uint32_t index = 1; index < operands_count; index += 1) {
+    if (MX_ROWS(operands[index]) != MX_ROWS(operands[0]) || MX_COLS(operands[index]) != MX_COLS(operands[0])) return 0;
+  }
+
+  MX_SET_ROWS(result, MX_ROWS(operands[0]));
+  MX_SET_COLS(result, MX_COLS(operands[0]));
+
+  args.program  = program;
+  args.length   = length;
+  args.operands = operands;
+  args.size     = MX_LENGTH(operands[0]) - 2;
+  args.result   = result + 2;
+  blocks        = (args.size + EXPRESSION_BLOCK - 1) / EXPRESSION_BLOCK;
+
+  thread_pool_run(eval_blocks, &args, blocks, EXPRESSION_PARALLEL_GRAIN / EXPRESSION_BLOCK);
+
+  return 1;
+}
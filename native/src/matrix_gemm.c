@@ -0,0 +1,382 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/matrix_gemm.h"
+#include "../include/thread_pool.h"
+
+/*
+
+Cache-blocked matrix multiplication, following the GotoBLAS/BLIS scheme.
+
+Columns of the result are split into blocks of GEMM_NC, the inner dimension into blocks of GEMM_KC,
+and rows into blocks of GEMM_MC. Each GEMM_KC × GEMM_NC block of the second matrix is packed
+into GEMM_NR wide column panels, which stay in L3 cache, and each GEMM_MC × GEMM_KC block
+of the first matrix is packed into GEMM_MR high row panels, which stay in L2.
+The micro kernel then multiplies a pair of panels, keeping GEMM_MR × GEMM_NR block of the result
+in registers, and reads both panels sequentially.
+
+Packing also takes care of transposition, so all dot variants share the same kernel.
+
+Big products are split into GEMM_MC × GEMM_TILE_COLS tiles of the result, which are computed
+on the thread pool, each chunk of tiles with its own packing buffers.
+
+*/
+
+#define GEMM_MR 6
+#define GEMM_NR 16
+#define GEMM_MC 144
+#define GEMM_KC 256
+#define GEMM_NC 4080
+
+#define GEMM_ALIGNMENT 64
+
+// Width of the result tiles, computed in parallel, and the number of multiply-adds,
+// starting from which it's worth splitting the work between threads.
+#define GEMM_TILE_COLS 512
+#define GEMM_PARALLEL_WORK (128*128*128)
+
+typedef float v8sf __attribute__((vector_size(32)));
+typedef float v8sf_unaligned __attribute__((vector_size(32), aligned(4)));
+
+typedef void (*micro_kernel_t)(
+  const uint64_t kc, const float *a, const float *b, float *c, const uint64_t c_stride,
+  const uint64_t mr, const uint64_t nr, const float alpha, const int accumulate
+);
+
+// Computes GEMM_MR × GEMM_NR block of the result from packed panels.
+// Only top left mr × nr part of it is stored, for the blocks at the edges of the result.
+static inline __attribute__((always_inline)) void
+micro_kernel_body(
+  const uint64_t kc, const float *a, const float *b, float *c, const uint64_t c_stride,
+  const uint64_t mr, const uint64_t nr, const float alpha, const int accumulate
+) {
+  v8sf sums[GEMM_MR][2] = {{{0}}};
+
+  for (uint64_t k = 0; k < kc; k += 1) {
+    const v8sf b0 = *(const v8sf *)b;
+    const v8sf b1 = *(const v8sf *)(b + 8);
+
+    for (int i = 0; i < GEMM_MR; i += 1) {
+      const v8sf a_i = (v8sf){} + a[i];
+
+      sums[i][0] += a_i * b0;
+      sums[i][1] += a_i * b1;
+    }
+
+    a += GEMM_MR;
+    b += GEMM_NR;
+  }
+
+  if (mr == GEMM_MR && nr == GEMM_NR) {
+    for (int i = 0; i < GEMM_MR; i += 1) {
+      v8sf_unaligned *row = (v8sf_unaligned *)(c + i*c_stride);
+
+      if (accumulate) {
+        row[0] += alpha * sums[i][0];
+        row[1] += alpha * sums[i][1];
+      } else {
+        row[0] = alpha * sums[i][0];
+        row[1] = alpha * sums[i][1];
+      }
+    }
+  } else {
+    float block[GEMM_MR][GEMM_NR] __attribute__((aligned(32)));
+
+    for (int i = 0; i < GEMM_MR; i += 1) {
+      *(v8sf *)&block[i][0] = alpha * sums[i][0];
+      *(v8sf *)&block[i][8] = alpha * sums[i][1];
+    }
+
+    for (uint64_t i = 0; i < mr; i += 1)
+      for (uint64_t j = 0; j < nr; j += 1)
+        c[i*c_stride + j] = accumulate ? c[i*c_stride + j] + block[i][j] : block[i][j];
+  }
+}
+
+static void
+micro_kernel_generic(
+  const uint64_t kc, const float *a, const float *b, float *c, const uint64_t c_stride,
+  const uint64_t mr, const uint64_t nr, const float alpha, const int accumulate
+) {
+  micro_kernel_body(kc, a, b, c, c_stride, mr, nr, alpha, accumulate);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("avx2,fma"))) static void
+micro_kernel_avx2(
+  const uint64_t kc, const float *a, const float *b, float *c, const uint64_t c_stride,
+  const uint64_t mr, const uint64_t nr, const float alpha, const int accumulate
+) {
+  micro_kernel_body(kc, a, b, c, c_stride, mr, nr, alpha, accumulate);
+}
+
+static micro_kernel_t
+select_micro_kernel(void) {
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return micro_kernel_avx2;
+
+  return micro_kernel_generic;
+}
+
+#else
+
+static micro_kernel_t
+select_micro_kernel(void) {
+  return micro_kernel_generic;
+}
+
+#endif
+
+// Packs mc × kc block of the first matrix into GEMM_MR high row panels, padding the last one with zeros.
+// Element (i, k) of the block is at a[i*row_step + k*column_step].
+static void
+pack_first(
+  const uint64_t mc, const uint64_t kc, const float *a,
+  const uint64_t row_step, const uint64_t column_step, float *packed
+) {
+  for (uint64_t panel = 0; panel < mc; panel += GEMM_MR) {
+    const uint64_t height = mc - panel < GEMM_MR ? mc - panel : GEMM_MR;
+    const float *rows = a + panel*row_step;
+
+    for (uint64_t k = 0; k < kc; k += 1) {
+      uint64_t i = 0;
+
+      for (; i < height; i += 1)
+        *packed++ = rows[i*row_step + k*column_step];
+      for (; i < GEMM_MR; i += 1)
+        *packed++ = 0;
+    }
+  }
+}
+
+// Packs kc × nc block of the second matrix into GEMM_NR wide column panels, padding the last one with zeros.
+// Element (k, j) of the block is at b[k*row_step + j*column_step].
+static void
+pack_second(
+  const uint64_t kc, const uint64_t nc, const float *b,
+  const uint64_t row_step, const uint64_t column_step, float *packed
+) {
+  for (uint64_t panel = 0; panel < nc; panel += GEMM_NR) {
+    const uint64_t width = nc - panel < GEMM_NR ? nc - panel : GEMM_NR;
+    const float *columns = b + panel*column_step;
+
+    for (uint64_t k = 0; k < kc; k += 1) {
+      const float *row = columns + k*row_step;
+      uint64_t j = 0;
+
+      if (column_step == 1 && width == GEMM_NR) {
+        memcpy(packed, row, GEMM_NR*sizeof(float));
+        packed += GEMM_NR;
+        continue;
+      }
+
+      for (; j < width; j += 1)
+        *packed++ = row[j*column_step];
+      for (; j < GEMM_NR; j += 1)
+        *packed++ = 0;
+    }
+  }
+}
+
+static uint64_t
+round_up(const uint64_t value, const uint64_t step) {
+  return (value + step - 1) / step * step;
+}
+
+typedef struct {
+  micro_kernel_t  micro_kernel;
+  uint64_t        rows, cols, inner;
+  float           alpha;
+  const float    *first;
+  uint64_t        first_row_step, first_column_step;
+  const float    *second;
+  uint64_t        second_row_step, second_column_step;
+  float          *result;
+  uint64_t        result_stride;
+  // The result is split into tiles, which are computed independently.
+  uint64_t        tile_rows, tile_cols, column_tiles;
+  int             failed;  // set by chunks of tiles, which couldn't allocate their packing buffers
+} gemm_args_t;
+
+static micro_kernel_t micro_kernel = NULL;
+
+// Maximum number of threads, which all GEMM calls together take from the pool. Zero means all of them.
+static uint32_t max_workers = 0;
+static uint32_t busy_workers = 0;
+
+// Computes rows × cols block of the result, starting at (row_from, col_from).
+static void
+gemm_block(
+  const gemm_args_t *args,
+  const uint64_t row_from, const uint64_t rows, const uint64_t col_from, const uint64_t cols,
+  float *packed_first, float *packed_second
+) {
+  const uint64_t inner = args->inner;
+
+  for (uint64_t jc = col_from; jc < col_from + cols; jc += GEMM_NC) {
+    const uint64_t nc = col_from + cols - jc < GEMM_NC ? col_from + cols - jc : GEMM_NC;
+
+    for (uint64_t pc = 0; pc < inner; pc += GEMM_KC) {
+      const uint64_t kc = inner - pc < GEMM_KC ? inner - pc : GEMM_KC;
+
+      pack_second(
+        kc, nc, args->second + pc*args->second_row_step + jc*args->second_column_step,
+        args->second_row_step, args->second_column_step, packed_second
+      );
+
+      for (uint64_t ic = row_from; ic < row_from + rows; ic += GEMM_MC) {
+        const uint64_t mc = row_from + rows - ic < GEMM_MC ? row_from + rows - ic : GEMM_MC;
+
+        pack_first(
+          mc, kc, args->first + ic*args->first_row_step + pc*args->first_column_step,
+          args->first_row_step, args->first_column_step, packed_first
+        );
+
+        for (uint64_t jr = 0; jr < nc; jr += GEMM_NR) {
+          const uint64_t nr = nc - jr < GEMM_NR ? nc - jr : GEMM_NR;
+
+          for (uint64_t ir = 0; ir < mc; ir += GEMM_MR) {
+            const uint64_t mr = mc - ir < GEMM_MR ? mc - ir : GEMM_MR;
+
+            args->micro_kernel(
+              kc, packed_first + ir*kc, packed_second + jr*kc,
+              args->result + (ic + ir)*args->result_stride + jc + jr, args->result_stride,
+              mr, nr, args->alpha, pc > 0
+            );
+          }
+        }
+      }
+    }
+  }
+}
+
+// Thread pool task: computes tiles [from, to) with its own packing buffers.
+static void
+gemm_tiles(void *task_args, uint64_t from, uint64_t to) {
+  const gemm_args_t *args = (const gemm_args_t *)task_args;
+  float *packed_first, *packed_second;
+
+  const uint64_t mc_max = args->tile_rows < GEMM_MC ? round_up(args->tile_rows, GEMM_MR) : GEMM_MC;
+  const uint64_t kc_max = args->inner < GEMM_KC ? args->inner : GEMM_KC;
+  const uint64_t nc_max = args->tile_cols < GEMM_NC ? round_up(args->tile_cols, GEMM_NR) : GEMM_NC;
+
+  if (posix_memalign((void **)&packed_first, GEMM_ALIGNMENT, mc_max*kc_max*sizeof(float)) != 0) {
+    __atomic_store_n(&((gemm_args_t *)task_args)->failed, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  if (posix_memalign((void **)&packed_second, GEMM_ALIGNMENT, kc_max*nc_max*sizeof(float)) != 0) {
+    free(packed_first);
+    __atomic_store_n(&((gemm_args_t *)task_args)->failed, 1, __ATOMIC_RELAXED);
+    return;
+  }
+
+  for (uint64_t tile = from; tile < to; tile += 1) {
+    const uint64_t row_from = tile / args->column_tiles * args->tile_rows;
+    const uint64_t col_from = tile % args->column_tiles * args->tile_cols;
+    const uint64_t rows = args->rows - row_from < args->tile_rows ? args->rows - row_from : args->tile_rows;
+    const uint64_t cols = args->cols - col_from < args->tile_cols ? args->cols - col_from : args->tile_cols;
+
+    gemm_block(args, row_from, rows, col_from, cols, packed_first, packed_second);
+  }
+
+  free(packed_first);
+  free(packed_second);
+}
+
+// Takes up to `wanted` pool workers out of those, not used by other GEMM calls at the moment.
+static uint32_t
+reserve_workers(const uint32_t wanted) {
+  const uint32_t pool_size = thread_pool_size();
+  const uint32_t limit = max_workers > 0 && max_workers < pool_size ? max_workers : pool_size;
+  uint32_t busy = __atomic_load_n(&busy_workers, __ATOMIC_RELAXED);
+  uint32_t reserved;
+
+  do {
+    const uint32_t available = limit > busy ? limit - busy : 0;
+
+    reserved = wanted < available ? wanted : available;
+    if (reserved == 0) return 0;
+  } while (!__atomic_compare_exchange_n(
+    &busy_workers, &busy, busy + reserved, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED
+  ));
+
+  return reserved;
+}
+
+// Zero lets GEMM use all pool workers, otherwise it's the number of threads besides the calling ones,
+// that all concurrent GEMM calls may use together.
+void
+matrix_gemm_set_max_workers(const uint32_t workers) {
+  __atomic_store_n(&max_workers, workers, __ATOMIC_RELAXED);
+}
+
+int
+matrix_gemm(
+  const int transpose_first, const int transpose_second,
+  const uint64_t rows, const uint64_t cols, const uint64_t inner,
+  const float alpha,
+  const float *first, const uint64_t first_stride,
+  const float *second, const uint64_t second_stride,
+  float *result, const uint64_t result_stride
+) {
+  gemm_args_t args;
+  uint64_t tiles;
+  uint32_t workers = 0;
+
+  if (rows == 0 || cols == 0) return 1;
+
+  if (inner == 0) {
+    for (uint64_t row = 0; row < rows; row += 1)
+      memset(result + row*result_stride, 0, cols*sizeof(float));
+    return 1;
+  }
+
+  args.micro_kernel = __atomic_load_n(&micro_kernel, __ATOMIC_RELAXED);
+  if (args.micro_kernel == NULL) {
+    args.micro_kernel = select_micro_kernel();
+    __atomic_store_n(&micro_kernel, args.micro_kernel, __ATOMIC_RELAXED);
+  }
+
+  args.rows = rows;
+  args.cols = cols;
+  args.inner = inner;
+  args.alpha = alpha;
+  args.first = first;
+  args.second = second;
+  args.result = result;
+  args.result_stride = result_stride;
+  args.failed = 0;
+
+  // Steps to the next row and to the next column of op(first) and op(second).
+  args.first_row_step = transpose_first ? 1 : first_stride;
+  args.first_column_step = transpose_first ? first_stride : 1;
+  args.second_row_step = transpose_second ? 1 : second_stride;
+  args.second_column_step = transpose_second ? second_stride : 1;
+
+  args.tile_rows = GEMM_MC;
+  args.tile_cols = GEMM_TILE_COLS;
+  args.column_tiles = (cols + GEMM_TILE_COLS - 1) / GEMM_TILE_COLS;
+  tiles = (rows + GEMM_MC - 1) / GEMM_MC * args.column_tiles;
+
+  if (rows * cols * inner >= GEMM_PARALLEL_WORK && tiles > 1)
+    workers = reserve_workers(tiles - 1 < UINT32_MAX ? tiles - 1 : UINT32_MAX);
+
+  if (workers == 0) {
+    // The whole result is one tile, so that blocks of the second matrix are packed only once.
+    args.tile_rows = rows;
+    args.tile_cols = cols;
+    args.column_tiles = 1;
+    gemm_tiles(&args, 0, 1);
+    return !args.failed;
+  }
+
+  // One chunk of tiles per thread, so that no more than `workers` pool threads join the calling one.
+  thread_pool_run(gemm_tiles, &args, tiles, (tiles + workers) / (workers + 1));
+
+  __atomic_sub_fetch(&busy_workers, workers, __ATOMIC_ACQ_REL);
+
+  return !args.failed;
+}
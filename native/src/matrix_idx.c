@@ -0,0 +1,237 @@
+#include <math.h>
+#include <string.h>
+
+#include "../include/matrix_idx.h"
+
+/*
+
+IDX datasets decoding, e.g. of MNIST images and labels.
+
+Each element type has its own conversion loop, so that byte swapping and widening to float,
+done by plain C expressions, are vectorized by compilers.
+Normalization takes one more pass over the elements to find their range,
+which is cheap for bytes, the most common case, as they take a quarter of the result size.
+
+*/
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define FROM_BIG_ENDIAN_16(value) (value)
+#define FROM_BIG_ENDIAN_32(value) (value)
+#define FROM_BIG_ENDIAN_64(value) (value)
+#else
+#define FROM_BIG_ENDIAN_16(value) __builtin_bswap16(value)
+#define FROM_BIG_ENDIAN_32(value) __builtin_bswap32(value)
+#define FROM_BIG_ENDIAN_64(value) __builtin_bswap64(value)
+#endif
+
+uint32_t
+matrix_idx_type_size(const idx_type_t type) {
+  switch (type) {
+    case IDX_UNSIGNED_BYTE:
+    case IDX_SIGNED_BYTE:
+      return 1;
+    case IDX_SHORT:
+      return 2;
+    case IDX_INTEGER:
+    case IDX_FLOAT:
+      return 4;
+    case IDX_DOUBLE:
+      return 8;
+  }
+
+  return 0;
+}
+
+static inline uint32_t
+read_big_endian_32(const uint8_t *data) {
+  uint32_t value;
+
+  memcpy(&value, data, sizeof(value));
+  return FROM_BIG_ENDIAN_32(value);
+}
+
+static inline float
+read_unsigned_byte(const uint8_t *elements, const uint64_t index) {
+  return elements[index];
+}
+
+static inline float
+read_signed_byte(const uint8_t *elements, const uint64_t index) {
+  return (int8_t) elements[index];
+}
+
+static inline int16_t
+read_short_integer(const uint8_t *elements, const uint64_t index) {
+  uint16_t value;
+
+  memcpy(&value, elements + index*sizeof(value), sizeof(value));
+  return (int16_t) FROM_BIG_ENDIAN_16(value);
+}
+
+static inline float
+read_short(const uint8_t *elements, const uint64_t index) {
+  return read_short_integer(elements, index);
+}
+
+static inline int32_t
+read_integer_value(const uint8_t *elements, const uint64_t index) {
+  return (int32_t) read_big_endian_32(elements + index*sizeof(int32_t));
+}
+
+static inline float
+read_integer(const uint8_t *elements, const uint64_t index) {
+  return read_integer_value(elements, index);
+}
+
+static inline float
+read_float(const uint8_t *elements, const uint64_t index) {
+  uint32_t bits = read_big_endian_32(elements + index*sizeof(float));
+  float    value;
+
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static inline float
+read_double(const uint8_t *elements, const uint64_t index) {
+  uint64_t bits;
+  double   value;
+
+  memcpy(&bits, elements + index*sizeof(bits), sizeof(bits));
+  bits = FROM_BIG_ENDIAN_64(bits);
+  memcpy(&value, &bits, sizeof(value));
+  return (float) value;
+}
+
+// Conversion into float is monotonic, so the range of converted elements is that of elements.
+#define IDX_TO_FLOAT(name)                                                                       \
+  static void                                                                                    \
+  name##_to_float(const uint8_t *elements, const uint64_t count, const int normalize, float *out) { \
+    float    min = INFINITY, max = -INFINITY, value, range;                                      \
+    uint64_t index;                                                                              \
+                                                                                                 \
+    if (!normalize) {                                                                            \
+      for (index = 0; index < count; index++) out[index] = read_##name(elements, index);        \
+      return;                                                                                    \
+    }                                                                                            \
+                                                                                                 \
+    for (index = 0; index < count; index++) {                                                    \
+      value = read_##name(elements, index);                                                      \
+      min = value < min ? value : min;                                                           \
+      max = value > max ? value : max;                                                           \
+    }                                                                                            \
+                                                                                                 \
+    range = max - min;                                                                           \
+    for (index = 0; index < count; index++) out[index] = (read_##name(elements, index) - min)/range; \
+  }
+
+IDX_TO_FLOAT(unsigned_byte)
+IDX_TO_FLOAT(signed_byte)
+IDX_TO_FLOAT(short)
+IDX_TO_FLOAT(integer)
+IDX_TO_FLOAT(float)
+IDX_TO_FLOAT(double)
+
+int
+matrix_idx_parse_header(const uint8_t *data, const uint64_t size, IdxData *idx) {
+  uint64_t cols = 1;
+  uint32_t dimensions, index;
+
+  if (size < 4 || data[0] != 0 || data[1] != 0 || matrix_idx_type_size(data[2]) == 0 || data[3] == 0) return 0;
+
+  dimensions = data[3];
+  if (size < matrix_idx_header_size(data)) return 0;
+
+  for (index = 1; index < dimensions; index++) {
+    cols *= read_big_endian_32(data + 4 + 4*index);
+    if (cols > UINT32_MAX) return 0;
+  }
+
+  idx->type = data[2];
+  idx->rows = read_big_endian_32(data + 4);
+  idx->cols = cols;
+  idx->elements = data + matrix_idx_header_size(data);
+
+  return 1;
+}
+
+int
+matrix_idx_parse(const uint8_t *data, const uint64_t size, IdxData *idx) {
+  if (!matrix_idx_parse_header(data, size, idx)) return 0;
+
+  return (size - matrix_idx_header_size(data))/matrix_idx_type_size(idx->type) >= (uint64_t) idx->rows*idx->cols;
+}
+
+uint64_t
+matrix_idx_header_size(const uint8_t *data) {
+  return 4 + 4*(uint64_t) data[3];
+}
+
+int
+matrix_idx_is_integer(const idx_type_t type) {
+  return type != IDX_FLOAT && type != IDX_DOUBLE;
+}
+
+matrix_type_t
+matrix_idx_integer_type(const idx_type_t type) {
+  if (type == IDX_UNSIGNED_BYTE) return MX_UINT8;
+  if (type == IDX_SIGNED_BYTE) return MX_INT8;
+
+  return MX_INT32;
+}
+
+static void
+to_float(const idx_type_t type, const uint8_t *elements, const uint64_t count, const int normalize, float *out) {
+  switch (type) {
+    case IDX_UNSIGNED_BYTE: unsigned_byte_to_float(elements, count, normalize, out); break;
+    case IDX_SIGNED_BYTE:   signed_byte_to_float(elements, count, normalize, out); break;
+    case IDX_SHORT:         short_to_float(elements, count, normalize, out); break;
+    case IDX_INTEGER:       integer_to_float(elements, count, normalize, out); break;
+    case IDX_FLOAT:         float_to_float(elements, count, normalize, out); break;
+    case IDX_DOUBLE:        double_to_float(elements, count, normalize, out); break;
+  }
+}
+
+static void
+to_integers(const idx_type_t type, const uint8_t *elements, const uint64_t count, void *result) {
+  int32_t  *out = (int32_t *) result;
+  uint64_t  index;
+
+  switch (type) {
+    case IDX_UNSIGNED_BYTE:
+    case IDX_SIGNED_BYTE:
+      memcpy(result, elements, count);
+      break;
+    case IDX_SHORT:
+      for (index = 0; index < count; index++) out[index] = read_short_integer(elements, index);
+      break;
+    case IDX_INTEGER:
+      for (index = 0; index < count; index++) out[index] = read_integer_value(elements, index);
+      break;
+    default:
+      break;
+  }
+}
+
+void
+matrix_idx_to_float(const IdxData *idx, const int normalize, Matrix result) {
+  MX_SET_ROWS(result, idx->rows);
+  MX_SET_COLS(result, idx->cols);
+
+  to_float(idx->type, idx->elements, (uint64_t) idx->rows*idx->cols, normalize, &result[2]);
+}
+
+void
+matrix_idx_to_integers(const IdxData *idx, void *result) {
+  to_integers(idx->type, idx->elements, (uint64_t) idx->rows*idx->cols, result);
+}
+
+void
+matrix_idx_convert(
+  const idx_type_t type, const uint8_t *elements, const uint64_t count, const int float_result, void *out
+) {
+  if (float_result || !matrix_idx_is_integer(type))
+    to_float(type, elements, count, 0, (float *) out);
+  else
+    to_integers(type, elements, count, out);
+}
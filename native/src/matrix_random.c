@@ -0,0 +1,149 @@
+#include <math.h>
+
+#include "../include/matrix_random.h"
+#include "../include/matrix_simd.h"
+#include "../include/thread_pool.h"
+
+/*
+
+Random matrices from Philox4x32-10 counter-based generator (Salmon et al., "Parallel random
+numbers: as easy as 1, 2, 3"). Its output for a counter is a keyed bijection of it, so there is
+no state to share or to lock: element i takes a word of block i/4, and any range of elements
+is generated independently of others. Blocks are generated by the SIMD kernel of the selected
+instruction set into a buffer on the stack, and then converted to the distribution.
+
+Normal elements are made by Box-Muller transform of word pairs of the same block. Truncated normal
+ones, which fall out of two standard deviations (about 4.6% of them), are resampled from blocks
+of further streams of their own counter, so the result still depends only on the seed.
+
+*/
+
+// Elements generated into a buffer at once. Multiple of 4 words of a block.
+#define RANDOM_CHUNK 1024
+
+#define RANDOM_PARALLEL_GRAIN 65536
+
+#define RANDOM_TRUNCATION 2.0f
+
+// Advanced by every call of matrix_random_seed().
+static uint64_t seed_sequence;
+
+typedef struct {
+  Matrix                    matrix;
+  const RandomDistribution *distribution;
+  uint64_t                  seed;
+} random_args_t;
+
+void
+matrix_random_init(const uint64_t entropy) {
+  __atomic_store_n(&seed_sequence, entropy, __ATOMIC_RELAXED);
+}
+
+// SplitMix64 of the sequence, so that consecutive seeds give unrelated keys.
+uint64_t
+matrix_random_seed(void) {
+  uint64_t seed = __atomic_add_fetch(&seed_sequence, 0x9E3779B97F4A7C15ULL, __ATOMIC_RELAXED);
+
+  seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+  return seed ^ (seed >> 31);
+}
+
+// Uniform in [0, 1) or, when `open_zero` is set, in (0, 1], from 24 high bits of the word.
+static inline float
+unit_float(const uint32_t bits, const uint32_t open_zero) {
+  return (float) ((bits >> 8) + open_zero) * 0x1p-24f;
+}
+
+// Standard normal pair from two words.
+static inline void
+box_muller(const uint32_t first, const uint32_t second, float *z0, float *z1) {
+  const float radius = sqrtf(-2.0f*logf(unit_float(first, 1)));
+  const float angle = 6.28318530717958648f*unit_float(second, 0);
+
+  *z0 = radius*cosf(angle);
+  *z1 = radius*sinf(angle);
+}
+
+// Standard normal value within the truncation for the element, drawn from its own blocks.
+static float
+resample_truncated(const uint64_t seed, const uint64_t index) {
+  uint32_t bits[4];
+  float    z[4];
+
+  for (uint32_t stream = 1; ; stream += 1) {
+    matrix_simd->philox(index, stream, seed, bits, 1);
+    box_muller(bits[0], bits[1], &z[0], &z[1]);
+    box_muller(bits[2], bits[3], &z[2], &z[3]);
+
+    for (int word = 0; word < 4; word += 1) {
+      if (fabsf(z[word]) <= RANDOM_TRUNCATION) return z[word];
+    }
+  }
+}
+
+// Converts `count` words, a multiple of 4, to elements of the distribution.
+static void
+convert_chunk(const RandomDistribution *distribution, const uint32_t *bits, const uint64_t count, float *values) {
+  const float first = distribution->first, second = distribution->second;
+
+  switch (distribution->type) {
+    case RANDOM_UNIFORM:
+      for (uint64_t index = 0; index < count; index += 1) {
+        values[index] = first + (second - first)*unit_float(bits[index], 0);
+      }
+      break;
+
+    case RANDOM_NORMAL:
+    case RANDOM_TRUNCATED_NORMAL:
+      for (uint64_t index = 0; index < count; index += 2) {
+        box_muller(bits[index], bits[index + 1], &values[index], &values[index + 1]);
+      }
+      break;
+
+    case RANDOM_BERNOULLI: {
+      // Probability as a fraction of 2^32, so that 1 takes every word.
+      const uint64_t threshold = (uint64_t) ldexp(fmin(fmax(first, 0.0), 1.0), 32);
+
+      for (uint64_t index = 0; index < count; index += 1) {
+        values[index] = bits[index] < threshold ? 1.0f : 0.0f;
+      }
+      break;
+    }
+  }
+}
+
+static void
+random_chunk(void *args, uint64_t from, uint64_t to) {
+  const random_args_t      *random = (const random_args_t *) args;
+  const RandomDistribution *distribution = random->distribution;
+  uint32_t                  bits[RANDOM_CHUNK];
+  float                     values[RANDOM_CHUNK];
+
+  // Chunks start at block boundaries, elements before `from` are generated and skipped.
+  for (uint64_t start = from - from % 4; start < to; start += RANDOM_CHUNK) {
+    const uint64_t end = start + RANDOM_CHUNK < to ? start + RANDOM_CHUNK : to;
+    const uint64_t blocks = (end - start + 3) / 4;
+
+    matrix_simd->philox(start / 4, 0, random->seed, bits, blocks);
+    convert_chunk(distribution, bits, 4*blocks, values);
+
+    for (uint64_t index = start < from ? from : start; index < end; index += 1) {
+      float value = values[index - start];
+
+      if (distribution->type == RANDOM_TRUNCATED_NORMAL && fabsf(value) > RANDOM_TRUNCATION)
+        value = resample_truncated(random->seed, index);
+      if (distribution->type == RANDOM_NORMAL || distribution->type == RANDOM_TRUNCATED_NORMAL)
+        value = distribution->first + distribution->second*value;
+
+      random->matrix[2 + index] = value;
+    }
+  }
+}
+
+void
+matrix_random(Matrix matrix, const RandomDistribution *distribution, const uint64_t seed) {
+  random_args_t args = { matrix, distribution, seed };
+
+  thread_pool_run(random_chunk, &args, (uint64_t) MX_ROWS(matrix)*MX_COLS(matrix), RANDOM_PARALLEL_GRAIN);
+}
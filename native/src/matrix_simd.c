@@ -0,0 +1,122 @@
+#include <math.h>
+#include <string.h>
+
+#include "../include/matrix_simd.h"
+
+/*
+
+Elementwise and reduction kernels, built for several instruction sets from one template
+with GCC vector extensions. The best set, supported by the CPU, is selected once,
+when the NIF library is loaded, so the same binary runs at full speed on old and new CPUs.
+
+*/
+
+#define SIMD_CONCAT(name, isa) SIMD_CONCAT_EXPANDED(name, isa)
+#define SIMD_CONCAT_EXPANDED(name, isa) name##_##isa
+#define SIMD_STRING(isa) SIMD_STRING_EXPANDED(isa)
+#define SIMD_STRING_EXPANDED(isa) #isa
+
+#define SIMD_ISA generic
+#define SIMD_WIDTH 1
+#define SIMD_TARGET
+#define SIMD_SQRT(x) ((SIMD_VECTOR){ sqrtf((x)[0]) })
+#include "../include/matrix_simd_template.h"
+#undef SIMD_ISA
+#undef SIMD_WIDTH
+#undef SIMD_TARGET
+#undef SIMD_SQRT
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+#define SIMD_ISA sse2
+#define SIMD_WIDTH 4
+#define SIMD_TARGET __attribute__((target("sse2")))
+#define SIMD_SQRT(x) ((SIMD_VECTOR)_mm_sqrt_ps((__m128)(x)))
+#include "../include/matrix_simd_template.h"
+#undef SIMD_ISA
+#undef SIMD_WIDTH
+#undef SIMD_TARGET
+#undef SIMD_SQRT
+
+#define SIMD_ISA avx2
+#define SIMD_WIDTH 8
+#define SIMD_TARGET __attribute__((target("avx2,fma")))
+#define SIMD_SQRT(x) ((SIMD_VECTOR)_mm256_sqrt_ps((__m256)(x)))
+#include "../include/matrix_simd_template.h"
+#undef SIMD_ISA
+#undef SIMD_WIDTH
+#undef SIMD_TARGET
+#undef SIMD_SQRT
+
+#define SIMD_ISA avx512
+#define SIMD_WIDTH 16
+#define SIMD_TARGET __attribute__((target("avx512f")))
+#define SIMD_SQRT(x) ((SIMD_VECTOR)_mm512_sqrt_ps((__m512)(x)))
+#include "../include/matrix_simd_template.h"
+#undef SIMD_ISA
+#undef SIMD_WIDTH
+#undef SIMD_TARGET
+#undef SIMD_SQRT
+
+#endif
+
+const simd_kernels_t *matrix_simd = &kernels_generic;
+
+static int
+is_supported(const simd_kernels_t *kernels) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+
+  if (kernels == &kernels_sse2) return __builtin_cpu_supports("sse2");
+  if (kernels == &kernels_avx2) return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  if (kernels == &kernels_avx512) return __builtin_cpu_supports("avx512f");
+#endif
+
+  return kernels == &kernels_generic;
+}
+
+int
+matrix_simd_select(const char *isa) {
+  // From the best to the worst.
+  static const simd_kernels_t *all_kernels[] = {
+#if defined(__x86_64__) || defined(__i386__)
+    &kernels_avx512,
+    &kernels_avx2,
+    &kernels_sse2,
+#endif
+    &kernels_generic
+  };
+  const uint64_t count = sizeof(all_kernels) / sizeof(all_kernels[0]);
+
+  for (uint64_t index = 0; index < count; index += 1) {
+    const simd_kernels_t *kernels = all_kernels[index];
+
+    if ((strcmp(isa, "auto") == 0 || strcmp(isa, kernels->isa) == 0) && is_supported(kernels)) {
+      __atomic_store_n(&matrix_simd, kernels, __ATOMIC_RELAXED);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+simd_unary_t
+matrix_simd_math(const char *name) {
+  const simd_kernels_t *kernels = __atomic_load_n(&matrix_simd, __ATOMIC_RELAXED);
+
+  if (strcmp(name, "exp") == 0)
+    return kernels->exp;
+  if (strcmp(name, "log") == 0)
+    return kernels->log;
+  if (strcmp(name, "sigmoid") == 0)
+    return kernels->sigmoid;
+  if (strcmp(name, "tanh") == 0)
+    return kernels->tanh;
+  if (strcmp(name, "erf") == 0)
+    return kernels->erf;
+  if (strcmp(name, "sqrt") == 0)
+    return kernels->sqrt;
+  return NULL;
+}
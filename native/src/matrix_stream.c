@@ -0,0 +1,198 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/matrix_stream.h"
+#include "../include/matrix_typed.h"
+
+static int
+fail(MatrixStream *stream) {
+  stream->failed = 1;
+  return 0;
+}
+
+void
+matrix_stream_init(MatrixStream *stream, const stream_format_t format, const int float_result, const int normalize) {
+  memset(stream, 0, sizeof(MatrixStream));
+
+  stream->format = format;
+  stream->float_result = float_result;
+  stream->normalize = normalize;
+}
+
+// Header length, which is enough to allocate the result: the typed matrix header, which also
+// tells it from the float one, or the whole IDX header, which length is in its first four bytes.
+static uint64_t
+header_needed(const MatrixStream *stream) {
+  if (stream->format == STREAM_MTX) return MX_TYPED_HEADER_SIZE;
+
+  return stream->header_length < 4 ? 4 : matrix_idx_header_size(stream->header);
+}
+
+static int
+allocate_mtx(MatrixStream *stream) {
+  const TypedHeader *header = (const TypedHeader *) stream->header;
+
+  if (header->magic == MX_TYPED_MAGIC) {
+    if (header->type >= MX_TYPES_COUNT) return fail(stream);
+    stream->result_size = matrix_typed_byte_size(header->rows, header->cols, header->type);
+  } else {
+    const uint64_t count = (uint64_t) header->rows*header->cols;
+
+    if (count > UINT64_MAX/sizeof(float) - 2) return fail(stream);
+    stream->result_size = (count + 2)*sizeof(float);
+  }
+
+  if (stream->result_size < MX_TYPED_HEADER_SIZE) return fail(stream);
+
+  stream->result = (uint8_t *) malloc(stream->result_size);
+  if (stream->result == NULL) return fail(stream);
+
+  memcpy(stream->result, stream->header, MX_TYPED_HEADER_SIZE);
+  stream->written = MX_TYPED_HEADER_SIZE;
+
+  return 1;
+}
+
+static int
+allocate_idx(MatrixStream *stream) {
+  IdxData       *idx = &stream->idx;
+  matrix_type_t  type;
+
+  if (!matrix_idx_parse_header(stream->header, stream->header_length, idx)) return fail(stream);
+
+  stream->float_result = stream->float_result || !matrix_idx_is_integer(idx->type);
+  type = stream->float_result ? MX_FLOAT32 : matrix_idx_integer_type(idx->type);
+
+  stream->elements_offset = stream->float_result ? 2*sizeof(float) : MX_TYPED_HEADER_SIZE;
+  stream->element_size = matrix_type_size(type);
+  stream->result_size = stream->float_result ?
+    ((uint64_t) idx->rows*idx->cols + 2)*sizeof(float) : matrix_typed_byte_size(idx->rows, idx->cols, type);
+
+  stream->result = (uint8_t *) malloc(stream->result_size);
+  if (stream->result == NULL) return fail(stream);
+
+  if (stream->float_result) {
+    MX_SET_ROWS((Matrix) stream->result, idx->rows);
+    MX_SET_COLS((Matrix) stream->result, idx->cols);
+  } else {
+    matrix_typed_init((TypedMatrix) stream->result, idx->rows, idx->cols, type);
+  }
+
+  return 1;
+}
+
+// Collects the header and allocates the result, once it's complete. Returns the number of bytes taken.
+static uint64_t
+write_header(MatrixStream *stream, const uint8_t *data, const uint64_t size) {
+  uint64_t taken = 0, needed, length;
+
+  while (stream->result == NULL && taken < size) {
+    needed = header_needed(stream);
+    length = needed - stream->header_length < size - taken ? needed - stream->header_length : size - taken;
+
+    memcpy(stream->header + stream->header_length, data + taken, length);
+    stream->header_length += length;
+    taken += length;
+
+    if (stream->header_length < needed || needed < header_needed(stream)) continue;
+    if (!(stream->format == STREAM_MTX ? allocate_mtx(stream) : allocate_idx(stream))) return taken;
+  }
+
+  return taken;
+}
+
+static void
+convert(MatrixStream *stream, const uint8_t *elements, const uint64_t count) {
+  matrix_idx_convert(
+    stream->idx.type, elements, count, stream->float_result,
+    stream->result + stream->elements_offset + stream->written*stream->element_size
+  );
+  stream->written += count;
+}
+
+// Converts whole elements, keeping the bytes of the one, which continues in the next chunk.
+static int
+write_elements(MatrixStream *stream, const uint8_t *data, uint64_t size) {
+  const uint32_t element_size = matrix_idx_type_size(stream->idx.type);
+  const uint64_t count = (uint64_t) stream->idx.rows*stream->idx.cols;
+  uint64_t       length;
+
+  if (stream->partial_length > 0 && stream->written < count) {
+    length = element_size - stream->partial_length < size ? element_size - stream->partial_length : size;
+
+    memcpy(stream->partial + stream->partial_length, data, length);
+    stream->partial_length += length;
+    data += length;
+    size -= length;
+
+    if (stream->partial_length < element_size) return 1;
+
+    convert(stream, stream->partial, 1);
+    stream->partial_length = 0;
+  }
+
+  length = size/element_size < count - stream->written ? size/element_size : count - stream->written;
+  convert(stream, data, length);
+
+  // Bytes after the last element are ignored, as they are, when the whole file is decoded.
+  if (stream->written < count) {
+    memcpy(stream->partial, data + length*element_size, size - length*element_size);
+    stream->partial_length = size - length*element_size;
+  }
+
+  return 1;
+}
+
+int
+matrix_stream_write(MatrixStream *stream, const uint8_t *data, const uint64_t size) {
+  uint64_t taken;
+
+  if (stream->failed) return 0;
+
+  taken = write_header(stream, data, size);
+  if (stream->failed) return 0;
+  if (taken == size) return 1;
+
+  if (stream->format == STREAM_IDX) return write_elements(stream, data + taken, size - taken);
+
+  if (size - taken > stream->result_size - stream->written) return fail(stream);
+
+  memcpy(stream->result + stream->written, data + taken, size - taken);
+  stream->written += size - taken;
+
+  return 1;
+}
+
+void *
+matrix_stream_finish(MatrixStream *stream, uint64_t *size) {
+  const TypedHeader *header = (const TypedHeader *) stream->header;
+
+  if (stream->failed) return NULL;
+
+  // Float .mtx file with less than two elements is shorter than the typed matrix header.
+  if (stream->result == NULL && stream->format == STREAM_MTX && stream->header_length >= 2*sizeof(float) &&
+      ((uint64_t) header->rows*header->cols + 2)*sizeof(float) == stream->header_length) {
+    stream->result = (uint8_t *) malloc(stream->header_length);
+    if (stream->result == NULL) return NULL;
+
+    memcpy(stream->result, stream->header, stream->header_length);
+    stream->result_size = stream->written = stream->header_length;
+  }
+
+  if (stream->result == NULL) return NULL;
+
+  if (stream->format == STREAM_MTX && stream->written != stream->result_size) return NULL;
+  if (stream->format == STREAM_IDX && stream->written != (uint64_t) stream->idx.rows*stream->idx.cols) return NULL;
+
+  if (stream->format == STREAM_IDX && stream->normalize && stream->float_result)
+    matrix_normalize((Matrix) stream->result, (Matrix) stream->result);
+
+  *size = stream->result_size;
+  return stream->result;
+}
+
+void
+matrix_stream_free(MatrixStream *stream) {
+  free(stream->result);
+  stream->result = NULL;
+}
@@ -0,0 +1,761 @@
+#include <math.h>
+#include <string.h>
+
+#include "../include/matrix_gemm.h"
+#include "../include/matrix_quantized.h"
+#include "../include/matrix_simd.h"
+#include "../include/matrix_typed.h"
+#include "../include/thread_pool.h"
+
+/*
+
+Kernels of typed matrices are built for each element type from one template,
+so that versions of an operation for different types can't drift apart.
+Arithmetic is done in TYPED_COMPUTE type, sums are accumulated in double.
+
+float16 and bfloat16 elements are only stored in 16 bits, halving memory and its traffic.
+Kernels widen them to float a block at a time, which stays in L1 cache, compute in float
+and round the results back to nearest even. Half precision floats are converted with F16C
+instructions, when the CPU has them.
+
+Integer elements are computed in float (int8 and uint8) or double (int32), which represent them exactly.
+Results are rounded to nearest even and saturated to the range of the type, NaNs become zeros.
+Product of int8 matrices with int32 sums is done by matrix_quantized_dot() instead.
+
+*/
+
+#define TYPED_CONCAT(name, type) TYPED_CONCAT_EXPANDED(name, type)
+#define TYPED_CONCAT_EXPANDED(name, type) name##_##type
+#define TYPED_STRING(type) TYPED_STRING_EXPANDED(type)
+#define TYPED_STRING_EXPANDED(type) #type
+
+#define TYPED_EACH(count, statement) \
+  for (uint64_t index = 0; index < (count); index += 1) statement
+
+#define TYPED_DOT_ROWS 64
+#define TYPED_DOT_COLS 256
+#define TYPED_DOT_INNER 128
+#define TYPED_GEMM_ROWS 256
+#define TYPED_GEMM_COLS 1024
+#define TYPED_GEMM_INNER 256
+#define TYPED_TRANSPOSE_TILE 32
+#define TYPED_BLOCK 256
+
+#define TYPED_BLOCK_SIZE(from, count) ((from) + TYPED_BLOCK < (count) ? TYPED_BLOCK : (count) - (from))
+
+typedef struct {
+  const char *name;
+  uint32_t    size;
+  void      (*read)(const void *data, const uint64_t count, double *out);
+  void      (*write)(const double *in, const uint64_t count, void *data);
+  void      (*from_floats)(const float *in, const uint64_t count, void *data);
+  void      (*to_floats)(const void *data, const uint64_t count, float *out);
+  void      (*fill)(void *data, const double value, const uint64_t count);
+  void      (*operate)(
+    const matrix_operation_t operation, const void *first, const void *second, void *result, const uint64_t count
+  );
+  void      (*operate_scalar)(
+    const matrix_operation_t operation, const void *matrix, const double scalar, const int scalar_first,
+    void *result, const uint64_t count
+  );
+  int       (*apply)(const char *function_name, const void *matrix, void *result, const uint64_t count);
+  int       (*dot)(
+    const double alpha, const void *first, const void *second, void *result,
+    const uint64_t rows, const uint64_t inner, const uint64_t cols
+  );
+  void      (*transpose)(const void *matrix, void *result, const uint64_t rows, const uint64_t cols);
+  double    (*sum)(const void *matrix, const uint64_t count);
+  double    (*max)(const void *matrix, const uint64_t count);
+  double    (*min)(const void *matrix, const uint64_t count);
+  int       (*cholesky)(const void *matrix, void *result, const uint64_t size);
+  int       (*solve)(const void *matrix, const void *beta, void *result, const uint64_t size);
+} typed_kernels_t;
+
+typedef struct {
+  double      alpha;
+  const void *first;
+  const void *second;
+  void       *result;
+  uint64_t    inner;
+  uint64_t    cols;
+  int         failed;  // set by chunks, which couldn't allocate their buffers
+} typed_dot_args_t;
+
+#ifndef MATREX_NO_BLAS
+
+#include <cblas.h>
+
+#define TYPED_BLAS_GEMM(gemm, alpha, first, second, result, rows, inner, cols) \
+  (gemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, rows, cols, inner, alpha, first, inner, second, cols, 0.0, result, cols), 1)
+
+#define TYPED_GEMM_FLOAT32(...) TYPED_BLAS_GEMM(cblas_sgemm, __VA_ARGS__)
+#define TYPED_GEMM_FLOAT64(...) TYPED_BLAS_GEMM(cblas_dgemm, __VA_ARGS__)
+
+// Adds product of float blocks to the result. Returns 0, when out of memory.
+static int
+float_block_gemm(
+  const uint64_t rows, const uint64_t cols, const uint64_t inner, const float alpha,
+  const float *first, const uint64_t first_stride, const float *second, const uint64_t second_stride,
+  float *result, const uint64_t result_stride
+) {
+  cblas_sgemm(
+    CblasRowMajor, CblasNoTrans, CblasNoTrans, rows, cols, inner,
+    alpha, first, first_stride, second, second_stride, 1.0, result, result_stride
+  );
+  return 1;
+}
+
+static int
+double_block_gemm(
+  const uint64_t rows, const uint64_t cols, const uint64_t inner, const double alpha,
+  const double *first, const uint64_t first_stride, const double *second, const uint64_t second_stride,
+  double *result, const uint64_t result_stride
+) {
+  cblas_dgemm(
+    CblasRowMajor, CblasNoTrans, CblasNoTrans, rows, cols, inner,
+    alpha, first, first_stride, second, second_stride, 1.0, result, result_stride
+  );
+  return 1;
+}
+
+#else
+
+#define TYPED_GEMM_FLOAT32(alpha, first, second, result, rows, inner, cols) \
+  matrix_gemm(0, 0, rows, cols, inner, alpha, first, inner, second, cols, result, cols)
+
+// Adds product of float blocks to the result, through a temporary one, as matrix_gemm() overwrites it.
+static int
+float_block_gemm(
+  const uint64_t rows, const uint64_t cols, const uint64_t inner, const float alpha,
+  const float *first, const uint64_t first_stride, const float *second, const uint64_t second_stride,
+  float *result, const uint64_t result_stride
+) {
+  float *product = malloc(rows*cols*sizeof(float));
+
+  if (product == NULL) return 0;
+
+  if (!matrix_gemm(0, 0, rows, cols, inner, alpha, first, first_stride, second, second_stride, product, cols)) {
+    free(product);
+    return 0;
+  }
+
+  for (uint64_t row = 0; row < rows; row += 1)
+    for (uint64_t col = 0; col < cols; col += 1) result[row*result_stride + col] += product[row*cols + col];
+
+  free(product);
+  return 1;
+}
+
+typedef struct {
+  double        alpha;
+  const double *first;
+  uint64_t      first_stride;
+  const double *second;
+  uint64_t      second_stride;
+  double       *result;
+  uint64_t      result_stride;
+  uint64_t      inner;
+  uint64_t      cols;
+} double_block_args_t;
+
+static void
+double_block_rows(void *args, uint64_t from, uint64_t to) {
+  const double_block_args_t *block = (const double_block_args_t *)args;
+
+  for (uint64_t row = from; row < to; row += 1)
+    for (uint64_t k = 0; k < block->inner; k += 1) {
+      const double  a = block->alpha*block->first[row*block->first_stride + k];
+      const double *b = block->second + k*block->second_stride;
+      double       *out = block->result + row*block->result_stride;
+
+      for (uint64_t col = 0; col < block->cols; col += 1) out[col] += a*b[col];
+    }
+}
+
+// There's no built-in double GEMM, so it's a plain loop over cache sized blocks, the caller passes,
+// split between thread pool workers by rows.
+static int
+double_block_gemm(
+  const uint64_t rows, const uint64_t cols, const uint64_t inner, const double alpha,
+  const double *first, const uint64_t first_stride, const double *second, const uint64_t second_stride,
+  double *result, const uint64_t result_stride
+) {
+  double_block_args_t args = {alpha, first, first_stride, second, second_stride, result, result_stride, inner, cols};
+  const uint64_t      row_work = inner*cols > 0 ? inner*cols : 1;
+
+  thread_pool_run(double_block_rows, &args, rows, TYPED_DOT_PARALLEL_WORK/row_work + 1);
+  return 1;
+}
+
+#endif
+
+typedef union {
+  float    value;
+  uint32_t bits;
+} float_bits_t;
+
+// Converts IEEE 754 half precision float to float, subnormals, infinities and NaNs included.
+static inline float
+half_to_float(const uint16_t half) {
+  const uint32_t     exponent_mask = 0x7c00 << 13;
+  const float_bits_t subnormal_magic = {.bits = 113 << 23};
+  float_bits_t       result = {.bits = (uint32_t)(half & 0x7fff) << 13};
+  const uint32_t     exponent = result.bits & exponent_mask;
+
+  result.bits += (127 - 15) << 23;
+
+  if (exponent == exponent_mask) {
+    result.bits += (128 - 16) << 23;
+  } else if (exponent == 0) {
+    result.bits += 1 << 23;
+    result.value -= subnormal_magic.value;
+  }
+
+  result.bits |= (uint32_t)(half & 0x8000) << 16;
+
+  return result.value;
+}
+
+// Rounds float to nearest even half precision float.
+static inline uint16_t
+float_to_half(const float value) {
+  const float_bits_t infinity = {.bits = 255 << 23};
+  const float_bits_t half_overflow = {.bits = (127 + 16) << 23};
+  const float_bits_t subnormal_magic = {.bits = ((127 - 15) + (23 - 10) + 1) << 23};
+  float_bits_t       number = {.value = value};
+  const uint32_t     sign = number.bits & 0x80000000u;
+  uint16_t           result;
+
+  number.bits ^= sign;
+
+  if (number.bits >= half_overflow.bits) {
+    result = number.bits > infinity.bits ? 0x7e00 : 0x7c00;
+  } else if (number.bits < (113 << 23)) {
+    number.value += subnormal_magic.value;
+    result = number.bits - subnormal_magic.bits;
+  } else {
+    const uint32_t odd = (number.bits >> 13) & 1;
+
+    number.bits += ((uint32_t)(15 - 127) << 23) + 0xfff + odd;
+    result = number.bits >> 13;
+  }
+
+  return result | (sign >> 16);
+}
+
+static inline float
+bfloat_to_float(const uint16_t bfloat) {
+  const float_bits_t result = {.bits = (uint32_t)bfloat << 16};
+
+  return result.value;
+}
+
+// Rounds float to nearest even bfloat16, keeping NaNs quiet.
+static inline uint16_t
+float_to_bfloat(const float value) {
+  const float_bits_t number = {.value = value};
+  const uint16_t     rounded = (number.bits + 0x7fff + ((number.bits >> 16) & 1)) >> 16;
+  const uint16_t     quiet_nan = (number.bits >> 16) | 0x40;
+
+  // Selects rather than branches, so that the conversion loop vectorizes.
+  return (number.bits & 0x7fffffff) > 0x7f800000 ? quiet_nan : rounded;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+static int
+f16c_supported(void) {
+  static int supported = -1;
+  int        result = __atomic_load_n(&supported, __ATOMIC_RELAXED);
+
+  if (result < 0) {
+    __builtin_cpu_init();
+    result = __builtin_cpu_supports("f16c") && __builtin_cpu_supports("avx");
+    __atomic_store_n(&supported, result, __ATOMIC_RELAXED);
+  }
+
+  return result;
+}
+
+// Convert eight elements at a time and return how many they converted.
+__attribute__((target("avx,f16c"))) static uint64_t
+halves_to_floats_f16c(const uint16_t *in, const uint64_t count, float *out) {
+  uint64_t index = 0;
+
+  for (; index + 8 <= count; index += 8)
+    _mm256_storeu_ps(out + index, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(in + index))));
+
+  return index;
+}
+
+__attribute__((target("avx,f16c"))) static uint64_t
+floats_to_halves_f16c(const float *in, const uint64_t count, uint16_t *out) {
+  uint64_t index = 0;
+
+  for (; index + 8 <= count; index += 8)
+    _mm_storeu_si128(
+      (__m128i *)(out + index), _mm256_cvtps_ph(_mm256_loadu_ps(in + index), _MM_FROUND_TO_NEAREST_INT)
+    );
+
+  return index;
+}
+
+#endif
+
+static void
+halves_to_floats(const uint16_t *in, const uint64_t count, float *out) {
+  uint64_t index = 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+  if (f16c_supported()) index = halves_to_floats_f16c(in, count, out);
+#endif
+
+  for (; index < count; index += 1) out[index] = half_to_float(in[index]);
+}
+
+static void
+floats_to_halves(const float *in, const uint64_t count, uint16_t *out) {
+  uint64_t index = 0;
+
+#if defined(__x86_64__) || defined(__i386__)
+  if (f16c_supported()) index = floats_to_halves_f16c(in, count, out);
+#endif
+
+  for (; index < count; index += 1) out[index] = float_to_half(in[index]);
+}
+
+static void
+bfloats_to_floats(const uint16_t *in, const uint64_t count, float *out) {
+  TYPED_EACH(count, out[index] = bfloat_to_float(in[index]));
+}
+
+static void
+floats_to_bfloats(const float *in, const uint64_t count, uint16_t *out) {
+  TYPED_EACH(count, out[index] = float_to_bfloat(in[index]));
+}
+
+// Conversions of integer type elements to compute type and back with rounding and saturation.
+#define INTEGER_CONVERSIONS(name, integer, compute, round, minimum, maximum)                \
+  static void                                                                                \
+  name##_to_compute(const integer *in, const uint64_t count, compute *out) {                 \
+    TYPED_EACH(count, out[index] = in[index]);                                               \
+  }                                                                                          \
+                                                                                             \
+  static void                                                                                \
+  compute_to_##name(const compute *in, const uint64_t count, integer *out) {                 \
+    for (uint64_t index = 0; index < count; index += 1) {                                    \
+      const compute value = round(in[index]);                                                \
+                                                                                             \
+      out[index] = value >= (maximum) ? (maximum) : value <= (minimum) ? (minimum) :         \
+        value == value ? (integer)value : 0;                                                 \
+    }                                                                                        \
+  }
+
+INTEGER_CONVERSIONS(int8, int8_t, float, rintf, INT8_MIN, INT8_MAX)
+INTEGER_CONVERSIONS(uint8, uint8_t, float, rintf, 0, UINT8_MAX)
+INTEGER_CONVERSIONS(int32, int32_t, double, rint, INT32_MIN, INT32_MAX)
+
+#define TYPED_NAME float32
+#define TYPED_STORAGE float
+#define TYPED_COMPUTE float
+#define TYPED_MATH(function) function##f
+#define TYPED_SIMD_MATH
+#define TYPED_GEMM TYPED_GEMM_FLOAT32
+#include "../include/matrix_typed_template.h"
+#undef TYPED_NAME
+#undef TYPED_STORAGE
+#undef TYPED_COMPUTE
+#undef TYPED_MATH
+#undef TYPED_SIMD_MATH
+#undef TYPED_GEMM
+
+#define TYPED_NAME float64
+#define TYPED_STORAGE double
+#define TYPED_COMPUTE double
+#define TYPED_MATH(function) function
+#ifdef TYPED_GEMM_FLOAT64
+#define TYPED_GEMM TYPED_GEMM_FLOAT64
+#endif
+#include "../include/matrix_typed_template.h"
+#undef TYPED_NAME
+#undef TYPED_STORAGE
+#undef TYPED_COMPUTE
+#undef TYPED_MATH
+#undef TYPED_GEMM
+
+#define TYPED_NAME float16
+#define TYPED_STORAGE uint16_t
+#define TYPED_COMPUTE float
+#define TYPED_LOAD_BLOCK halves_to_floats
+#define TYPED_STORE_BLOCK floats_to_halves
+#define TYPED_BLOCK_GEMM float_block_gemm
+#define TYPED_MATH(function) function##f
+#define TYPED_SIMD_MATH
+#include "../include/matrix_typed_template.h"
+#undef TYPED_NAME
+#undef TYPED_STORAGE
+#undef TYPED_COMPUTE
+#undef TYPED_LOAD_BLOCK
+#undef TYPED_STORE_BLOCK
+#undef TYPED_BLOCK_GEMM
+#undef TYPED_MATH
+#undef TYPED_SIMD_MATH
+
+#define TYPED_NAME bfloat16
+#define TYPED_STORAGE uint16_t
+#define TYPED_COMPUTE float
+#define TYPED_LOAD_BLOCK bfloats_to_floats
+#define TYPED_STORE_BLOCK floats_to_bfloats
+#define TYPED_BLOCK_GEMM float_block_gemm
+#define TYPED_MATH(function) function##f
+#define TYPED_SIMD_MATH
+#include "../include/matrix_typed_template.h"
+#undef TYPED_NAME
+#undef TYPED_STORAGE
+#undef TYPED_COMPUTE
+#undef TYPED_LOAD_BLOCK
+#undef TYPED_STORE_BLOCK
+#undef TYPED_BLOCK_GEMM
+#undef TYPED_MATH
+#undef TYPED_SIMD_MATH
+
+#define TYPED_NAME int8
+#define TYPED_STORAGE int8_t
+#define TYPED_COMPUTE float
+#define TYPED_LOAD_BLOCK int8_to_compute
+#define TYPED_STORE_BLOCK compute_to_int8
+#define TYPED_BLOCK_GEMM float_block_gemm
+#define TYPED_MATH(function) function##f
+#define TYPED_SIMD_MATH
+#include "../include/matrix_typed_template.h"
+#undef TYPED_NAME
+#undef TYPED_STORAGE
+#undef TYPED_COMPUTE
+#undef TYPED_LOAD_BLOCK
+#undef TYPED_STORE_BLOCK
+#undef TYPED_BLOCK_GEMM
+#undef TYPED_MATH
+#undef TYPED_SIMD_MATH
+
+#define TYPED_NAME uint8
+#define TYPED_STORAGE uint8_t
+#define TYPED_COMPUTE float
+#define TYPED_LOAD_BLOCK uint8_to_compute
+#define TYPED_STORE_BLOCK compute_to_uint8
+#define TYPED_BLOCK_GEMM float_block_gemm
+#define TYPED_MATH(function) function##f
+#define TYPED_SIMD_MATH
+#include "../include/matrix_typed_template.h"
+#undef TYPED_NAME
+#undef TYPED_STORAGE
+#undef TYPED_COMPUTE
+#undef TYPED_LOAD_BLOCK
+#undef TYPED_STORE_BLOCK
+#undef TYPED_BLOCK_GEMM
+#undef TYPED_MATH
+#undef TYPED_SIMD_MATH
+
+#define TYPED_NAME int32
+#define TYPED_STORAGE int32_t
+#define TYPED_COMPUTE double
+#define TYPED_LOAD_BLOCK int32_to_compute
+#define TYPED_STORE_BLOCK compute_to_int32
+#define TYPED_BLOCK_GEMM double_block_gemm
+#define TYPED_MATH(function) function
+#include "../include/matrix_typed_template.h"
+#undef TYPED_NAME
+#undef TYPED_STORAGE
+#undef TYPED_COMPUTE
+#undef TYPED_LOAD_BLOCK
+#undef TYPED_STORE_BLOCK
+#undef TYPED_BLOCK_GEMM
+#undef TYPED_MATH
+
+// Indexed by matrix_type_t.
+static const typed_kernels_t *all_kernels[MX_TYPES_COUNT] = {
+  &kernels_float32,
+  &kernels_float64,
+  &kernels_float16,
+  &kernels_bfloat16,
+  &kernels_int8,
+  &kernels_uint8,
+  &kernels_int32
+};
+
+#define KERNELS(matrix) (all_kernels[(matrix)->type])
+
+int
+matrix_type_from_name(const char *name) {
+  for (int type = 0; type < MX_TYPES_COUNT; type += 1)
+    if (strcmp(name, all_kernels[type]->name) == 0) return type;
+
+  return -1;
+}
+
+uint32_t
+matrix_type_size(const matrix_type_t type) {
+  return all_kernels[type]->size;
+}
+
+int
+matrix_type_is_integer(const matrix_type_t type) {
+  return type == MX_INT8 || type == MX_UINT8 || type == MX_INT32;
+}
+
+uint64_t
+matrix_typed_byte_size(const uint32_t rows, const uint32_t cols, const matrix_type_t type) {
+  const uint64_t count = (uint64_t)rows*(uint64_t)cols;
+
+  if (count > (UINT64_MAX - MX_TYPED_HEADER_SIZE) / matrix_type_size(type)) return 0;
+
+  return MX_TYPED_HEADER_SIZE + count*matrix_type_size(type);
+}
+
+int
+matrix_typed_valid(const void *data, const uint64_t byte_size) {
+  const TypedHeader *header = (const TypedHeader *)data;
+
+  return
+    byte_size >= MX_TYPED_HEADER_SIZE &&
+    header->magic == MX_TYPED_MAGIC &&
+    header->type < MX_TYPES_COUNT &&
+    byte_size == matrix_typed_byte_size(header->rows, header->cols, header->type);
+}
+
+void
+matrix_typed_init(TypedMatrix matrix, const uint32_t rows, const uint32_t cols, const matrix_type_t type) {
+  matrix->rows  = rows;
+  matrix->cols  = cols;
+  matrix->type  = type;
+  matrix->magic = MX_TYPED_MAGIC;
+}
+
+void
+matrix_typed_read(const TypedMatrix matrix, const uint64_t from, const uint64_t count, double *out) {
+  const typed_kernels_t *kernels = KERNELS(matrix);
+
+  kernels->read((const char *)MX_TYPED_DATA(matrix) + from*kernels->size, count, out);
+}
+
+// Converts between element types through doubles, a block at a time.
+#define CONVERT_BLOCK 256
+
+void
+matrix_typed_convert(const TypedMatrix source, TypedMatrix result) {
+  const typed_kernels_t *source_kernels = KERNELS(source);
+  const typed_kernels_t *result_kernels = KERNELS(result);
+  const uint64_t         count = MX_TYPED_COUNT(source);
+  const char            *source_data = (const char *)MX_TYPED_DATA(source);
+  char                  *result_data = (char *)MX_TYPED_DATA(result);
+  double                 block[CONVERT_BLOCK];
+
+  matrix_typed_init(result, source->rows, source->cols, result->type);
+
+  if (source->type == result->type) {
+    memcpy(result_data, source_data, count*source_kernels->size);
+    return;
+  }
+
+  for (uint64_t from = 0; from < count; from += CONVERT_BLOCK) {
+    const uint64_t size = from + CONVERT_BLOCK < count ? CONVERT_BLOCK : count - from;
+
+    source_kernels->read(source_data + from*source_kernels->size, size, block);
+    result_kernels->write(block, size, result_data + from*result_kernels->size);
+  }
+}
+
+void
+matrix_typed_from_matrex(const Matrix source, TypedMatrix result) {
+  matrix_typed_init(result, MX_ROWS(source), MX_COLS(source), result->type);
+
+  KERNELS(result)->from_floats(source + 2, MX_TYPED_COUNT(result), MX_TYPED_DATA(result));
+}
+
+void
+matrix_typed_to_matrex(const TypedMatrix source, Matrix result) {
+  MX_SET_ROWS(result, source->rows);
+  MX_SET_COLS(result, source->cols);
+
+  KERNELS(source)->to_floats(MX_TYPED_DATA(source), MX_TYPED_COUNT(source), result + 2);
+}
+
+void
+matrix_typed_fill(TypedMatrix matrix, const double value) {
+  KERNELS(matrix)->fill(MX_TYPED_DATA(matrix), value, MX_TYPED_COUNT(matrix));
+}
+
+void
+matrix_typed_eye(TypedMatrix matrix, const double value) {
+  const typed_kernels_t *kernels = KERNELS(matrix);
+  char                  *data = (char *)MX_TYPED_DATA(matrix);
+
+  kernels->fill(data, 0, MX_TYPED_COUNT(matrix));
+
+  for (uint64_t index = 0; index < matrix->rows && index < matrix->cols; index += 1)
+    kernels->fill(data + (index*matrix->cols + index)*kernels->size, value, 1);
+}
+
+typedef struct {
+  const typed_kernels_t *kernels;
+  matrix_operation_t     operation;
+  const char            *function_name;  // set for apply
+  const char            *first;
+  const char            *second;         // NULL for operations with scalar
+  double                 scalar;
+  int                    scalar_first;
+  char                  *result;
+} typed_elementwise_args_t;
+
+static void
+elementwise_chunk(void *args, uint64_t from, uint64_t to) {
+  const typed_elementwise_args_t *elementwise = (const typed_elementwise_args_t *)args;
+  const typed_kernels_t          *kernels = elementwise->kernels;
+  const uint64_t                  offset = from*kernels->size;
+
+  if (elementwise->function_name != NULL)
+    kernels->apply(elementwise->function_name, elementwise->first + offset, elementwise->result + offset, to - from);
+  else if (elementwise->second != NULL)
+    kernels->operate(
+      elementwise->operation, elementwise->first + offset, elementwise->second + offset,
+      elementwise->result + offset, to - from
+    );
+  else
+    kernels->operate_scalar(
+      elementwise->operation, elementwise->first + offset, elementwise->scalar, elementwise->scalar_first,
+      elementwise->result + offset, to - from
+    );
+}
+
+static void
+elementwise(typed_elementwise_args_t *args, const TypedMatrix matrix, TypedMatrix result) {
+  args->kernels = KERNELS(matrix);
+  args->first   = (const char *)MX_TYPED_DATA(matrix);
+  args->result  = (char *)MX_TYPED_DATA(result);
+
+  matrix_typed_init(result, matrix->rows, matrix->cols, matrix->type);
+
+  thread_pool_run(elementwise_chunk, args, MX_TYPED_COUNT(matrix), APPLY_PARALLEL_GRAIN);
+}
+
+int
+matrix_typed_operate(
+  const matrix_operation_t operation, const TypedMatrix first, const TypedMatrix second, TypedMatrix result
+) {
+  typed_elementwise_args_t args = {0};
+
+  if (first->type != second->type || first->rows != second->rows || first->cols != second->cols) return 0;
+
+  args.operation = operation;
+  args.second    = (const char *)MX_TYPED_DATA(second);
+
+  elementwise(&args, first, result);
+
+  return 1;
+}
+
+void
+matrix_typed_operate_scalar(
+  const matrix_operation_t operation, const TypedMatrix matrix, const double scalar,
+  const int scalar_first, TypedMatrix result
+) {
+  typed_elementwise_args_t args = {0};
+
+  args.operation    = operation;
+  args.scalar       = scalar;
+  args.scalar_first = scalar_first;
+
+  elementwise(&args, matrix, result);
+}
+
+int
+matrix_typed_apply(const TypedMatrix matrix, const char *function_name, TypedMatrix result) {
+  typed_elementwise_args_t args = {0};
+
+  if (math_func_from_name(function_name) == NULL) return 0;
+
+  args.function_name = function_name;
+
+  elementwise(&args, matrix, result);
+
+  return 1;
+}
+
+int
+matrix_typed_dot(const double alpha, const TypedMatrix first, const TypedMatrix second, TypedMatrix result) {
+  if (first->type != second->type || first->cols != second->rows) return 0;
+
+  matrix_typed_init(result, first->rows, second->cols, first->type);
+
+  return KERNELS(first)->dot(
+    alpha, MX_TYPED_DATA(first), MX_TYPED_DATA(second), MX_TYPED_DATA(result),
+    first->rows, first->cols, second->cols
+  );
+}
+
+int
+matrix_typed_quantized_dot(
+  const TypedMatrix first, const TypedMatrix second,
+  const float *first_scales, const uint64_t first_scales_step,
+  const float *second_scales, const uint64_t second_scales_step,
+  TypedMatrix result
+) {
+  const int scaled = result->type == MX_FLOAT32;
+
+  if (first->type != MX_INT8 || second->type != MX_INT8 || first->cols != second->rows) return 0;
+  if (!scaled && result->type != MX_INT32) return 0;
+
+  matrix_typed_init(result, first->rows, second->cols, result->type);
+
+  return matrix_quantized_dot(
+    MX_TYPED_DATA(first), MX_TYPED_DATA(second), first->rows, first->cols, second->cols,
+    first_scales, first_scales_step, second_scales, second_scales_step,
+    scaled ? NULL : MX_TYPED_DATA(result), scaled ? MX_TYPED_DATA(result) : NULL
+  );
+}
+
+void
+matrix_typed_transpose(const TypedMatrix matrix, TypedMatrix result) {
+  matrix_typed_init(result, matrix->cols, matrix->rows, matrix->type);
+
+  KERNELS(matrix)->transpose(MX_TYPED_DATA(matrix), MX_TYPED_DATA(result), matrix->rows, matrix->cols);
+}
+
+double
+matrix_typed_sum(const TypedMatrix matrix) {
+  return KERNELS(matrix)->sum(MX_TYPED_DATA(matrix), MX_TYPED_COUNT(matrix));
+}
+
+double
+matrix_typed_max(const TypedMatrix matrix) {
+  if (MX_TYPED_COUNT(matrix) == 0) return NAN;
+
+  return KERNELS(matrix)->max(MX_TYPED_DATA(matrix), MX_TYPED_COUNT(matrix));
+}
+
+double
+matrix_typed_min(const TypedMatrix matrix) {
+  if (MX_TYPED_COUNT(matrix) == 0) return NAN;
+
+  return KERNELS(matrix)->min(MX_TYPED_DATA(matrix), MX_TYPED_COUNT(matrix));
+}
+
+int
+matrix_typed_cholesky(const TypedMatrix matrix, TypedMatrix result) {
+  if (matrix->rows != matrix->cols) return 0;
+
+  matrix_typed_init(result, matrix->rows, matrix->cols, matrix->type);
+
+  return KERNELS(matrix)->cholesky(MX_TYPED_DATA(matrix), MX_TYPED_DATA(result), matrix->rows);
+}
+
+int
+matrix_typed_solve(const TypedMatrix matrix, const TypedMatrix beta, TypedMatrix result) {
+  if (matrix->type != beta->type || matrix->rows != matrix->cols || beta->rows != matrix->rows || beta->cols != 1)
+    return 0;
+
+  matrix_typed_init(result, matrix->rows, 1, matrix->type);
+
+  return KERNELS(matrix)->solve(MX_TYPED_DATA(matrix), MX_TYPED_DATA(beta), MX_TYPED_DATA(result), matrix->rows);
+}
@@ -0,0 +1,97 @@
+#include <string.h>
+
+#include "../include/matrix_view.h"
+#include "../include/matrix_simd.h"
+
+#ifndef MATREX_NO_BLAS
+#include <cblas.h>
+#else
+#include "../include/matrix_gemm.h"
+#endif
+
+MatrixView
+matrix_view_of(const Matrix matrix) {
+  const MatrixView view = { matrix + 2, MX_ROWS(matrix), MX_COLS(matrix), MX_COLS(matrix) };
+
+  return view;
+}
+
+void
+matrix_view_copy(const MatrixView view, Matrix result) {
+  MX_SET_ROWS(result, view.rows);
+  MX_SET_COLS(result, view.cols);
+
+  for (uint64_t row = 0; row < view.rows; row++) {
+    memcpy(result + 2 + row*view.cols, view.data + row*view.stride, view.cols*sizeof(float));
+  }
+}
+
+double
+matrix_view_sum(const MatrixView view) {
+  double sum = 0.0;
+
+  for (uint64_t row = 0; row < view.rows; row++) {
+    sum += matrix_simd->sum(view.data + row*view.stride, view.cols);
+  }
+
+  return sum;
+}
+
+void
+matrix_view_add(
+  const MatrixView first, const MatrixView second, const float alpha, const float beta, Matrix result
+) {
+  MX_SET_ROWS(result, first.rows);
+  MX_SET_COLS(result, first.cols);
+
+  // Rows of views are contiguous, so elementwise kernels run on them one at a time.
+  for (uint64_t row = 0; row < first.rows; row++) {
+    matrix_simd->add(
+      first.data + row*first.stride, second.data + row*second.stride, alpha, beta,
+      result + 2 + row*first.cols, first.cols
+    );
+  }
+}
+
+// Both BLAS and built-in GEMM take row strides, so views are multiplied without copying.
+// Returns 0, when out of memory.
+int
+matrix_view_dot(const float alpha, const MatrixView first, const MatrixView second, Matrix result) {
+  MX_SET_ROWS(result, first.rows);
+  MX_SET_COLS(result, second.cols);
+
+#ifndef MATREX_NO_BLAS
+  cblas_sgemm(
+    CblasRowMajor,
+    CblasNoTrans,
+    CblasNoTrans,
+    first.rows,
+    second.cols,
+    first.cols,
+    alpha,
+    first.data,
+    first.stride,
+    second.data,
+    second.stride,
+    0.0,
+    result + 2,
+    second.cols
+  );
+  return 1;
+#else
+  return matrix_gemm(
+    0,
+    0,
+    first.rows,
+    second.cols,
+    first.cols,
+    alpha,
+    first.data,
+    first.stride,
+    second.data,
+    second.stride,
+    result + 2,
+    second.cols
+  );
+#endif
+}
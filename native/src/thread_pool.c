@@ -0,0 +1,317 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../include/thread_pool.h"
+
+/*
+
+Persistent pool of worker threads, which is started once on NIF library load.
+
+Each call to thread_pool_run() splits its range into chunks and spreads them over
+per-worker queues. Workers take chunks from the back of their own queue and, when it is empty,
+steal from the front of the others'. The calling thread does not sit idle either:
+it steals chunks until there are none left and then waits for the rest to finish.
+
+Calls in progress are counted, and thread_pool_stop() waits for them before it frees the queues.
+Calls, made once the pool is stopping, run in the calling thread.
+
+*/
+
+#define MAX_WORKERS 256
+#define CHUNKS_PER_THREAD 4
+
+typedef struct {
+  thread_pool_task_t task;
+  void              *args;
+  uint64_t           remaining;
+  int                done;
+  pthread_mutex_t    lock;
+  pthread_cond_t     finished;
+} job_t;
+
+typedef struct {
+  job_t    *job;
+  uint64_t  from;
+  uint64_t  to;
+} chunk_t;
+
+typedef struct {
+  pthread_mutex_t  lock;
+  chunk_t         *items;
+  uint64_t         capacity;
+  uint64_t         head;
+  uint64_t         count;
+} queue_t;
+
+static struct {
+  pthread_t        threads[MAX_WORKERS];
+  queue_t         *queues;
+  uint32_t         size;
+  uint32_t         next_queue;
+  uint64_t         queued;
+  uint64_t         active;    // thread_pool_run() calls, which have queued their chunks
+  int              stopping;
+  pthread_mutex_t  lock;
+  pthread_cond_t   wake;
+  pthread_cond_t   idle;      // signalled, when the last active call returns while stopping
+} pool = { .lock = PTHREAD_MUTEX_INITIALIZER, .wake = PTHREAD_COND_INITIALIZER, .idle = PTHREAD_COND_INITIALIZER };
+
+static void
+queue_push(queue_t *queue, const chunk_t chunk) {
+  pthread_mutex_lock(&queue->lock);
+
+  if (queue->count == queue->capacity) {
+    const uint64_t capacity = queue->capacity ? queue->capacity * 2 : 64;
+    chunk_t *items = malloc(capacity * sizeof(chunk_t));
+
+    for (uint64_t index = 0; index < queue->count; index += 1)
+      items[index] = queue->items[(queue->head + index) % queue->capacity];
+
+    free(queue->items);
+    queue->items = items;
+    queue->capacity = capacity;
+    queue->head = 0;
+  }
+
+  queue->items[(queue->head + queue->count) % queue->capacity] = chunk;
+  queue->count += 1;
+
+  pthread_mutex_unlock(&queue->lock);
+}
+
+// Owner takes the most recently pushed chunk, thieves take the oldest one.
+static int
+queue_pop(queue_t *queue, const int steal, chunk_t *chunk) {
+  int found = 0;
+
+  pthread_mutex_lock(&queue->lock);
+
+  if (queue->count > 0) {
+    if (steal) {
+      *chunk = queue->items[queue->head];
+      queue->head = (queue->head + 1) % queue->capacity;
+    } else {
+      *chunk = queue->items[(queue->head + queue->count - 1) % queue->capacity];
+    }
+    queue->count -= 1;
+    found = 1;
+  }
+
+  pthread_mutex_unlock(&queue->lock);
+
+  return found;
+}
+
+static int
+take_chunk(const uint32_t own_queue, const uint32_t first_victim, chunk_t *chunk) {
+  const uint32_t size = pool.size;
+
+  if (own_queue < size && queue_pop(&pool.queues[own_queue], 0, chunk))
+    goto found;
+
+  for (uint32_t index = 0; index < size; index += 1) {
+    const uint32_t victim = (first_victim + index) % size;
+
+    if (victim != own_queue && queue_pop(&pool.queues[victim], 1, chunk))
+      goto found;
+  }
+
+  return 0;
+
+found:
+  __atomic_sub_fetch(&pool.queued, 1, __ATOMIC_ACQ_REL);
+  return 1;
+}
+
+static void
+run_chunk(const chunk_t chunk) {
+  job_t *job = chunk.job;
+
+  job->task(job->args, chunk.from, chunk.to);
+
+  if (__atomic_sub_fetch(&job->remaining, 1, __ATOMIC_ACQ_REL) == 0) {
+    pthread_mutex_lock(&job->lock);
+    job->done = 1;
+    pthread_cond_signal(&job->finished);
+    pthread_mutex_unlock(&job->lock);
+  }
+}
+
+static void*
+worker_loop(void *arg) {
+  const uint32_t id = (uint32_t)(uintptr_t)arg;
+  chunk_t chunk;
+
+  for (;;) {
+    if (take_chunk(id, id + 1, &chunk)) {
+      run_chunk(chunk);
+      continue;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    while (__atomic_load_n(&pool.queued, __ATOMIC_ACQUIRE) == 0 && !pool.stopping)
+      pthread_cond_wait(&pool.wake, &pool.lock);
+    const int stopping = pool.stopping;
+    pthread_mutex_unlock(&pool.lock);
+
+    if (stopping) return NULL;
+  }
+}
+
+// Wakes up and joins first `started` workers, once there are no active calls, then frees the queues.
+static void
+stop_workers(const uint32_t started) {
+  const uint32_t size = pool.size;
+
+  if (size == 0) return;
+
+  pthread_mutex_lock(&pool.lock);
+  pool.stopping = 1;
+  pthread_cond_broadcast(&pool.wake);
+  while (pool.active > 0)
+    pthread_cond_wait(&pool.idle, &pool.lock);
+  pthread_mutex_unlock(&pool.lock);
+
+  for (uint32_t index = 0; index < started; index += 1)
+    pthread_join(pool.threads[index], NULL);
+
+  __atomic_store_n(&pool.size, 0, __ATOMIC_RELEASE);
+
+  for (uint32_t index = 0; index < size; index += 1) {
+    pthread_mutex_destroy(&pool.queues[index].lock);
+    free(pool.queues[index].items);
+  }
+  free(pool.queues);
+  pool.queues = NULL;
+}
+
+// Starts the pool. With zero workers uses one thread less, than the number of online CPUs,
+// because the calling thread takes part in the work too.
+int
+thread_pool_start(uint32_t workers) {
+  if (pool.size > 0) return 0;
+
+  if (workers == 0) {
+    const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    workers = cpus > 1 ? cpus - 1 : 0;
+  }
+  if (workers > MAX_WORKERS) workers = MAX_WORKERS;
+  if (workers == 0) return 0;
+
+  pool.queues = calloc(workers, sizeof(queue_t));
+  for (uint32_t index = 0; index < workers; index += 1)
+    pthread_mutex_init(&pool.queues[index].lock, NULL);
+
+  pool.stopping = 0;
+  pool.queued = 0;
+  pool.active = 0;
+  __atomic_store_n(&pool.size, workers, __ATOMIC_RELEASE);
+
+  for (uint32_t index = 0; index < workers; index += 1) {
+    if (pthread_create(&pool.threads[index], NULL, worker_loop, (void*)(uintptr_t)index) != 0) {
+      // Stop those, which have started, and run everything in the calling thread.
+      stop_workers(index);
+      break;
+    }
+  }
+
+  return 0;
+}
+
+// Waits for calls in progress to finish. Later ones run in the calling thread.
+void
+thread_pool_stop(void) {
+  stop_workers(pool.size);
+}
+
+uint32_t
+thread_pool_size(void) {
+  return __atomic_load_n(&pool.size, __ATOMIC_ACQUIRE);
+}
+
+// Counts the call as active, unless the pool is stopping or stopped. Returns the number of workers then.
+static uint32_t
+enter_pool(void) {
+  uint32_t workers = 0;
+
+  pthread_mutex_lock(&pool.lock);
+  if (!pool.stopping && pool.size > 0) {
+    workers = pool.size;
+    pool.active += 1;
+  }
+  pthread_mutex_unlock(&pool.lock);
+
+  return workers;
+}
+
+static void
+leave_pool(void) {
+  pthread_mutex_lock(&pool.lock);
+  pool.active -= 1;
+  if (pool.active == 0 && pool.stopping)
+    pthread_cond_broadcast(&pool.idle);
+  pthread_mutex_unlock(&pool.lock);
+}
+
+// Calls task on [0, size) range split into chunks of at least `grain` elements
+// and returns, when all of them are done.
+void
+thread_pool_run(thread_pool_task_t task, void *args, uint64_t size, uint64_t grain) {
+  uint32_t workers;
+  uint64_t chunks, chunk_size;
+  job_t job;
+  chunk_t chunk;
+
+  if (size == 0) return;
+  if (grain == 0) grain = 1;
+
+  chunks = (size + grain - 1) / grain;
+
+  workers = chunks > 1 ? enter_pool() : 0;
+  if (workers == 0) {
+    task(args, 0, size);
+    return;
+  }
+
+  if (chunks > (uint64_t)(workers + 1) * CHUNKS_PER_THREAD)
+    chunks = (uint64_t)(workers + 1) * CHUNKS_PER_THREAD;
+
+  chunk_size = (size + chunks - 1) / chunks;
+  chunks = (size + chunk_size - 1) / chunk_size;
+
+  job.task = task;
+  job.args = args;
+  job.remaining = chunks;
+  job.done = 0;
+  pthread_mutex_init(&job.lock, NULL);
+  pthread_cond_init(&job.finished, NULL);
+
+  const uint32_t first_queue = __atomic_fetch_add(&pool.next_queue, 1, __ATOMIC_RELAXED) % workers;
+
+  __atomic_add_fetch(&pool.queued, chunks, __ATOMIC_ACQ_REL);
+
+  for (uint64_t index = 0; index < chunks; index += 1) {
+    const uint64_t from = index * chunk_size;
+    const uint64_t to = from + chunk_size < size ? from + chunk_size : size;
+
+    queue_push(&pool.queues[(first_queue + index) % workers], (chunk_t){ &job, from, to });
+  }
+
+  pthread_mutex_lock(&pool.lock);
+  pthread_cond_broadcast(&pool.wake);
+  pthread_mutex_unlock(&pool.lock);
+
+  while (take_chunk(UINT32_MAX, first_queue, &chunk))
+    run_chunk(chunk);
+
+  pthread_mutex_lock(&job.lock);
+  while (!job.done)
+    pthread_cond_wait(&job.finished, &job.lock);
+  pthread_mutex_unlock(&job.lock);
+
+  pthread_mutex_destroy(&job.lock);
+  pthread_cond_destroy(&job.finished);
+
+  leave_pool();
+}
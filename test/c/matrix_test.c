@@ -253,6 +253,53 @@ static void test_matrix_multiply_with_scalar() {
   }
 }
 
+static void test_matrix_reduce_columns() {
+  // Wider than a strip, so the last strip is partial.
+  Matrix matrix = matrix_new(3, 300);
+  Matrix result = matrix_new(1, 300);
+
+  for(int32_t index = 0; index < 3*300; index += 1) matrix[index + 2] = index % 7;
+
+  assert(matrix_reduce_columns(matrix, "sum", result) == 1); /* LCOV_EXCL_BR_LINE */
+  assert(MX_ROWS(result) == 1);   /* LCOV_EXCL_BR_LINE */
+  assert(MX_COLS(result) == 300); /* LCOV_EXCL_BR_LINE */
+
+  for(int32_t col = 0; col < 300; col += 1) {
+    assert(result[col + 2] == col % 7 + (300 + col) % 7 + (600 + col) % 7); /* LCOV_EXCL_BR_LINE */
+  }
+
+  assert(matrix_reduce_columns(matrix, "argmax", result) == 1); /* LCOV_EXCL_BR_LINE */
+  assert(result[2] == 2); /* LCOV_EXCL_BR_LINE */
+  assert(result[3] == 3); /* LCOV_EXCL_BR_LINE */
+  assert(result[7] == 1); /* LCOV_EXCL_BR_LINE */
+
+  assert(matrix_reduce_columns(matrix, "median", result) == 0); /* LCOV_EXCL_BR_LINE */
+
+  matrix_free(&matrix);
+  matrix_free(&result);
+}
+
+static void test_matrix_reduce_rows() {
+  Matrix matrix = matrix_new(2, 3);
+  Matrix result = matrix_new(2, 1);
+  float  data[6] = {1, 7, 3, 4, 5, 6};
+
+  for(int32_t index = 0; index < 6; index += 1) matrix[index + 2] = data[index];
+
+  assert(matrix_reduce_rows(matrix, "mean", result) == 1); /* LCOV_EXCL_BR_LINE */
+  assert(MX_ROWS(result) == 2); /* LCOV_EXCL_BR_LINE */
+  assert(MX_COLS(result) == 1); /* LCOV_EXCL_BR_LINE */
+  assert(result[2] == 11/3.0f); /* LCOV_EXCL_BR_LINE */
+  assert(result[3] == 5);       /* LCOV_EXCL_BR_LINE */
+
+  assert(matrix_reduce_rows(matrix, "min", result) == 1); /* LCOV_EXCL_BR_LINE */
+  assert(result[2] == 1); /* LCOV_EXCL_BR_LINE */
+  assert(result[3] == 4); /* LCOV_EXCL_BR_LINE */
+
+  matrix_free(&matrix);
+  matrix_free(&result);
+}
+
 static void test_matrix_subtract() {
   float first[8]    = {2, 3,  1, 2, 3, 4, 5, 6};
   float second[8]   = {2, 3,  5, 2, 1, 3, 4, 6};
@@ -283,3 +330,41 @@ static void test_matrix_transpose() {
     assert(expected[index] == result[index]); /* LCOV_EXCL_BR_LINE */
   }
 }
+
+static void test_matrix_transpose_tiled() {
+  // Not a multiple of either tile or block size, so edges are covered too.
+  Matrix matrix = matrix_new(70, 133);
+  Matrix result = matrix_new(133, 70);
+
+  for(int32_t index = 0; index < 70*133; index += 1) matrix[index + 2] = index;
+
+  matrix_transpose(matrix, result);
+
+  assert(MX_ROWS(result) == 133); /* LCOV_EXCL_BR_LINE */
+  assert(MX_COLS(result) == 70);  /* LCOV_EXCL_BR_LINE */
+
+  for(int32_t row = 0; row < 70; row += 1) {
+    for(int32_t col = 0; col < 133; col += 1) {
+      assert(result[col*70 + row + 2] == matrix[row*133 + col + 2]); /* LCOV_EXCL_BR_LINE */
+    }
+  }
+
+  matrix_free(&matrix);
+  matrix_free(&result);
+}
+
+static void test_matrix_transpose_in_place() {
+  Matrix matrix = matrix_new(131, 131);
+
+  for(int32_t index = 0; index < 131*131; index += 1) matrix[index + 2] = index;
+
+  matrix_transpose_in_place(matrix);
+
+  for(int32_t row = 0; row < 131; row += 1) {
+    for(int32_t col = 0; col < 131; col += 1) {
+      assert(matrix[col*131 + row + 2] == row*131 + col); /* LCOV_EXCL_BR_LINE */
+    }
+  }
+
+  matrix_free(&matrix);
+}
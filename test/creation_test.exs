@@ -247,6 +247,31 @@ defmodule CreationTest do
     refute Matrex.contains?(result, 1.0)
   end
 
+  test "#random/3 gives the same matrix for the same seed" do
+    first = Matrex.random(300, 400, seed: 42)
+
+    assert Matrex.random(300, 400, seed: 42) == first
+    assert Matrex.random(300, 400, seed: 43) != first
+    assert Matrex.random(3, 400, seed: 42) == Matrex.submatrix(first, 1..3, 1..400)
+  end
+
+  test "#random/3 generates uniform, normal, truncated normal and Bernoulli distributions" do
+    uniform = Matrex.random(500, 400, min: -2, max: 3, seed: 1)
+    assert Matrex.min(uniform) >= -2 and Matrex.max(uniform) < 3
+    assert_in_delta Matrex.sum(uniform) / 200_000, 0.5, 0.02
+
+    normal = Matrex.random(500, 400, distribution: :normal, mean: 1, std: 2, seed: 2)
+    assert_in_delta Matrex.sum(normal) / 200_000, 1, 0.02
+    assert_in_delta normal |> Matrex.subtract(1) |> Matrex.square() |> Matrex.sum(), 800_000, 8000
+
+    truncated = Matrex.random(500, 400, distribution: :truncated_normal, std: 0.5, seed: 3)
+    assert Matrex.min(truncated) >= -1 and Matrex.max(truncated) <= 1
+
+    bernoulli = Matrex.random(500, 400, distribution: :bernoulli, p: 0.3, seed: 4)
+    assert Enum.uniq(bernoulli) |> Enum.sort() == [0.0, 1.0]
+    assert_in_delta Matrex.sum(bernoulli) / 200_000, 0.3, 0.01
+  end
+
   test "#zeros/1 returns zero filled square matrix" do
     zero_matrix = Matrex.new([[0, 0, 0], [0, 0, 0], [0, 0, 0]])
     assert Matrex.zeros(3) == zero_matrix
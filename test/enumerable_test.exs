@@ -40,4 +40,19 @@ defmodule EnumerableTest do
   test "#reduce computes sum of matrix", %{matrex: matrex} do
     assert Enum.reduce(matrex, fn x, acc -> x + acc end) == 1_225
   end
+
+  test "#member? is false for values, which can't be elements", %{matrex: matrex} do
+    refute Enum.member?(matrex, "30")
+    refute Enum.member?(matrex, :nan)
+  end
+
+  test "#reduce walks matrix of many chunks and can be halted and suspended" do
+    matrex = Matrex.reshape(1..10_000, 100, 100)
+
+    assert Enum.to_list(matrex) == Enum.map(1..10_000, &(&1 * 1.0))
+    assert Enum.take_while(matrex, &(&1 < 5000)) |> length() == 4999
+    assert Enum.zip(matrex, 1..3) == [{1.0, 1}, {2.0, 2}, {3.0, 3}]
+    assert matrex |> Stream.map(&(&1 * 2)) |> Enum.take(2) == [2.0, 4.0]
+    assert Enum.slice(matrex, 4094..4097) == [4095.0, 4096.0, 4097.0, 4098.0]
+  end
 end
@@ -0,0 +1,93 @@
+defmodule LazyTest do
+  use ExUnit.Case, async: true
+  alias Matrex.Lazy
+  require Matrex.Lazy
+
+  doctest Matrex.Lazy
+
+  test "#fuse/1 gives the same result as step by step computation" do
+    y = Matrex.random(30, 50)
+    h = Matrex.random(30, 50)
+
+    expected =
+      y
+      |> Matrex.neg()
+      |> Matrex.multiply(Matrex.apply(h, :log))
+      |> Matrex.subtract(
+        Matrex.multiply(Matrex.subtract(1, y), Matrex.apply(Matrex.subtract(1, h), :log))
+      )
+
+    assert Lazy.fuse((-y <|> log(h)) - ((1 - y) <|> log(1 - h))) == expected
+  end
+
+  test "#fuse/1 applies operations with scalars on both sides" do
+    a = Matrex.new("1 2; 4 8")
+
+    assert Lazy.fuse(2 / a - a / 2 + (3 - a) * 2) ==
+             2
+             |> Matrex.divide(a)
+             |> Matrex.subtract(Matrex.divide(a, 2))
+             |> Matrex.add(Matrex.multiply(Matrex.subtract(3, a), 2))
+  end
+
+  test "#fuse/1 folds scalar subexpressions" do
+    a = Matrex.new("1 2 3")
+
+    assert Lazy.fuse(a * (2 + 3) - :math.pi()) ==
+             a |> Matrex.multiply(5) |> Matrex.subtract(:math.pi())
+  end
+
+  test "#fuse/1 applies math functions" do
+    a = Matrex.new("0.5 1 2")
+
+    assert Lazy.fuse(exp(a) + Matrex.apply(a, :sqrt) + apply(a, :sigmoid)) ==
+             a
+             |> Matrex.apply(:exp)
+             |> Matrex.add(Matrex.apply(a, :sqrt))
+             |> Matrex.add(Matrex.apply(a, :sigmoid))
+  end
+
+  test "#fuse/1 rewrites pipes" do
+    a = Matrex.new("1 2 3")
+
+    assert Lazy.fuse(a |> Lazy.add(1) |> pow2()) == Matrex.new("4 9 16")
+  end
+
+  test "#fuse/1 computes matrix product eagerly" do
+    a = Matrex.new("1 2; 3 4")
+    b = Matrex.new("1 0; 1 1")
+
+    assert Lazy.fuse(a * b + 1) == a |> Matrex.dot(b) |> Matrex.add(1)
+  end
+
+  test "#fuse/1 broadcasts operands of different sizes eagerly" do
+    a = Matrex.new("1 2 3; 4 5 6")
+    row = Matrex.new("10 20 30")
+
+    assert Lazy.fuse((a + row) * 2) == Matrex.new("22 44 66; 28 50 72")
+  end
+
+  test "#eval/1 splits programs longer than the native limit" do
+    a = Matrex.new("1 2; 3 4")
+    lazy = Enum.reduce(1..300, Lazy.new(a), fn _, acc -> Lazy.add(acc, a) end)
+
+    assert Lazy.eval(lazy) == Matrex.multiply(a, 301)
+  end
+
+  test "#eval/1 splits expressions deeper than the native stack" do
+    a = Matrex.new("1 2; 3 4")
+    lazy = Enum.reduce(1..40, Lazy.new(a), fn _, acc -> Lazy.subtract(a, acc) end)
+
+    assert Lazy.eval(lazy) == a
+  end
+
+  test "#eval/1 of a single matrix returns it" do
+    a = Matrex.new("1 2; 3 4")
+
+    assert Lazy.eval(Lazy.new(a)) == a
+  end
+
+  test "#inspect/1 shows size" do
+    assert inspect(Lazy.new(Matrex.zeros(3, 4))) == "#Matrex.Lazy[3×4]"
+  end
+end
@@ -14,11 +14,46 @@ defmodule MatrexTest do
     first = Matrex.new([[1, 2, 3], [4, 5, 6]])
     second = Matrex.new([[5, 2], [3, 4]])
 
-    assert_raise FunctionClauseError, fn ->
+    assert_raise ErlangError, ~r/Matrices sizes mismatch./, fn ->
       Matrex.add(first, second)
     end
   end
 
+  test "#add broadcasts row and column vectors over matrix" do
+    matrix = Matrex.new([[1, 2, 3], [4, 5, 6]])
+
+    assert Matrex.add(matrix, Matrex.new([[10, 20, 30]])) ==
+             Matrex.new([[11, 22, 33], [14, 25, 36]])
+
+    assert Matrex.add(Matrex.new([[10], [20]]), matrix, 1.0, 2.0) ==
+             Matrex.new([[12, 14, 16], [28, 30, 32]])
+
+    assert Matrex.add(Matrex.new([[1], [2]]), Matrex.new([[10, 20, 30]])) ==
+             Matrex.new([[11, 21, 31], [12, 22, 32]])
+  end
+
+  test "elementwise operations broadcast vectors over empty matrix into empty one" do
+    empty = Matrex.zeros(0, 3)
+    row = Matrex.new("1 2 3")
+
+    assert Matrex.add(empty, row) == empty
+    assert Matrex.subtract(row, empty) == empty
+    assert Matrex.multiply(empty, row) == empty
+    assert Matrex.divide(row, empty) == empty
+  end
+
+  test "elementwise operations broadcast vectors wider than a strip" do
+    matrix = Matrex.random(3, 2500)
+    row = Matrex.random(1, 2500)
+    column = Matrex.random(3, 1)
+    expanded_row = Matrex.new(3, 2500, fn _, col -> row[col] end)
+    expanded_column = Matrex.new(3, 2500, fn r, _ -> column[r] end)
+
+    assert Matrex.subtract(matrix, row) == Matrex.subtract(matrix, expanded_row)
+    assert Matrex.multiply(column, matrix) == Matrex.multiply(expanded_column, matrix)
+    assert Matrex.divide(row, matrix) == Matrex.divide(expanded_row, matrix)
+  end
+
   test "#add adds scalar to each element of a matrix" do
     matrix = Matrex.new([[1, 2, 3], [4, 5, 6]])
     scalar = 3
@@ -54,6 +89,30 @@ defmodule MatrexTest do
              Float.round(:math.exp(Matrex.at(input, 325, 414)), 5)
   end
 
+  test "#apply/2 computes vectorized math functions with float precision" do
+    input = Matrex.new([[-20.5, -3.3, -0.7, -1.0e-3, 0.0, 2.0e-3, 0.4, 1.5, 2.7, 9.9, 87.1]])
+    positive = Matrex.apply(input, &abs/1)
+
+    [
+      {:exp, input, &:math.exp/1},
+      {:log, Matrex.add(positive, 1.0e-3), &:math.log/1},
+      {:sigmoid, input, &(1 / (1 + :math.exp(-&1)))},
+      {:tanh, input, &:math.tanh/1},
+      {:erf, input, &:math.erf/1},
+      {:sqrt, positive, &:math.sqrt/1}
+    ]
+    |> Enum.each(fn {function, m, reference} ->
+      m
+      |> Matrex.apply(function)
+      |> Enum.zip(m)
+      |> Enum.each(fn {value, x} ->
+        expected = reference.(x)
+        assert abs(value - expected) <= 4.0e-7 * Kernel.max(abs(expected), 1.0e-30),
+               "#{function}(#{x})"
+      end)
+    end)
+  end
+
   test "#apply/2 applies a function/1 on each element of the matrix" do
     function = &(&1 + 1)
     input = Matrex.new([[1, 2, 3], [4, 5, 6]])
@@ -90,6 +149,37 @@ defmodule MatrexTest do
     assert Matrex.apply(first, second, function) == expected
   end
 
+  test "#apply/2 and #apply/3 apply functions on matrices of many chunks in parallel" do
+    input = Matrex.reshape(1..200_000, 400, 500)
+
+    assert Matrex.apply(input, &(&1 * 2)) == Matrex.multiply(input, 2)
+    assert Matrex.apply(input, fn _, index -> index end) == input
+
+    assert Matrex.apply(input, fn _, row, column -> row * 1000 + column end) ==
+             Matrex.new(400, 500, fn row, column -> row * 1000 + column end)
+
+    assert Matrex.apply(input, input, &(&1 - &2)) == Matrex.zeros(400, 500)
+  end
+
+  test "#apply/2 raises in the caller on errors in chunks of large matrices" do
+    input = Matrex.reshape(1..200_000, 400, 500)
+
+    assert_raise ArgumentError, fn ->
+      Matrex.apply(input, &if(&1 == 150_000, do: "bad", else: &1))
+    end
+
+    assert_raise ArithmeticError, fn ->
+      Matrex.apply(input, &(1 / (&1 - 100_000)))
+    end
+  end
+
+  test "#apply/2 passes and takes special values" do
+    input = Matrex.new([[1, :nan, :inf]])
+
+    assert Matrex.apply(input, &if(is_atom(&1), do: :neg_inf, else: &1)) ==
+             Matrex.new([[1, :neg_inf, :neg_inf]])
+  end
+
   test "#argmax returns the index of the maximal element" do
     first = Matrex.new([[1, 2, 3], [4, 5, 6]])
     second = Matrex.new([[8, 3, 4], [5, 6, 7]])
@@ -173,6 +263,24 @@ defmodule MatrexTest do
     assert Matrex.concat([z, o, t]) == expected
   end
 
+  test "#concat concatenates list of matrices along rows" do
+    pieces = for i <- 1..4, do: Matrex.reshape(1..(2 * i), i, 2)
+    expected = pieces |> Enum.flat_map(&Matrex.to_list_of_lists/1) |> Matrex.new()
+
+    assert Matrex.concat(pieces, :rows) == expected
+    assert Matrex.size(expected) == {10, 2}
+  end
+
+  test "#concat raises when sizes of list of matrices do not fit" do
+    assert_raise ArgumentError, fn ->
+      Matrex.concat([Matrex.ones(2, 2), Matrex.ones(3, 2), Matrex.ones(2, 2)])
+    end
+
+    assert_raise ArgumentError, fn ->
+      Matrex.concat([Matrex.ones(2, 2), Matrex.ones(2, 3)], :rows)
+    end
+  end
+
   test "#concat concatenates two matrices along rows" do
     first = Matrex.reshape(1..6, 3, 2)
     second = Matrex.reshape(1..4, 2, 2)
@@ -488,6 +596,34 @@ defmodule MatrexTest do
     assert Matrex.neg(matrix) == expected
   end
 
+  test "#new builds matrix from list of lists with special values" do
+    matrix = Matrex.new([[1, 2.5, :nan], [:inf, :neg_inf, -3]])
+
+    assert Matrex.size(matrix) == {2, 3}
+    assert Matrex.to_list(matrix) == [1.0, 2.5, :nan, :inf, :neg_inf, -3.0]
+    assert matrix == Matrex.new("1 2.5 NaN; Inf NegInf -3")
+  end
+
+  test "#new builds huge matrix from list of lists" do
+    lists = for row <- 0..999, do: Enum.to_list((row * 1000 + 1)..(row * 1000 + 1000))
+
+    assert Matrex.new(lists) == Matrex.reshape(1..1_000_000, 1000, 1000)
+  end
+
+  test "#new raises on rows of different lengths and unknown elements" do
+    assert_raise ArgumentError, fn -> Matrex.new([[1, 2], [3]]) end
+    assert_raise ArgumentError, fn -> Matrex.new([[1, 2], [3, 4, 5]]) end
+    assert_raise ArgumentError, fn -> Matrex.new([[1, 2], 3]) end
+    assert_raise ArgumentError, fn -> Matrex.new([[1, :infinity]]) end
+  end
+
+  test "#new/3 fills matrix from function in row order" do
+    assert Matrex.new(2, 3, fn row, col -> row * 10 + col end) ==
+             Matrex.new([[11, 12, 13], [21, 22, 23]])
+
+    assert Matrex.new(2, 2, fn -> 1 end) == Matrex.ones(2)
+  end
+
   test "#normalize puts matrix values in [0, 1] range" do
     matrix = Matrex.reshape(1..12, 4, 3)
 
@@ -720,6 +856,59 @@ defmodule MatrexTest do
     assert Matrex.sum(input) == :inf
   end
 
+  test "#sum/2 sums with compensation in :kahan mode" do
+    # 2^24 + 1 + ... + 1 loses every 1 in float, but not in double lanes.
+    input = Matrex.ones(1, 100_001) |> Matrex.set(1, 1, 16_777_216)
+
+    assert Matrex.sum(input, :kahan) == 16_877_216
+    assert Matrex.sum(input, :pairwise) == 16_877_216
+
+    # 1.0e20 swamps the ones added to its lane even in double, only compensation keeps them.
+    input = Matrex.ones(1, 100_002) |> Matrex.set(1, 1, 1.0e20) |> Matrex.set(1, 100_002, -1.0e20)
+
+    assert Matrex.sum(input, :kahan) == 100_000
+    assert Matrex.sum(input, :pairwise) < 100_000
+  end
+
+  test "reductions of big matrices, split between workers, match small ones" do
+    input = Matrex.new(1, 100_000, fn _, col -> rem(col * 7919, 100_003) end)
+    input = input |> Matrex.set(1, 77_777, 1_000_000) |> Matrex.set(1, 99_999, :nan)
+
+    assert Matrex.max(input) == 1_000_000
+    assert Matrex.argmax(input) == 77_777
+    assert Matrex.min(input) == 1
+    assert Matrex.max_finite(input) == 1_000_000
+    assert Matrex.find(input, :nan) == {1, 99_999}
+    assert Matrex.find(input, 1_000_000) == {1, 77_777}
+  end
+
+  test "axis reductions return columns for :rows and rows for :columns" do
+    matrix = Matrex.new("1 7 3 2; 8 5 6 -1; 0 4 9 4")
+
+    assert Matrex.sum(matrix, :rows) == Matrex.new("13; 18; 17")
+    assert Matrex.sum(matrix, :columns) == Matrex.new("9 16 18 5")
+    assert Matrex.mean(matrix, :columns) == Matrex.new("3 5.333333333 6 1.666666667")
+    assert Matrex.max(matrix, :rows) == Matrex.new("7; 8; 9")
+    assert Matrex.min(matrix, :columns) == Matrex.new("0 4 3 -1")
+    assert Matrex.argmax(matrix, :rows) == Matrex.new("2; 1; 3")
+    assert Matrex.argmax(matrix, :columns) == Matrex.new("2 1 3 3")
+  end
+
+  test "axis reductions of big matrices match reductions of their rows and columns" do
+    matrix = Matrex.random(300, 700)
+
+    assert Matrex.argmax(matrix, :rows) |> Enum.to_list() ==
+             Enum.map(1..300, &(matrix |> Matrex.row(&1) |> Matrex.argmax()))
+
+    assert Matrex.max(matrix, :columns) |> Enum.to_list() ==
+             Enum.map(1..700, &(matrix |> Matrex.column(&1) |> Matrex.max()))
+
+    matrix
+    |> Matrex.sum(:columns)
+    |> Enum.zip(Enum.map(1..700, &(matrix |> Matrex.column(&1) |> Matrex.sum())))
+    |> Enum.each(fn {sum, expected} -> assert abs(sum - expected) < 1.0e-3 end)
+  end
+
   test "#to_list returs whole matrix as a list" do
     matrex = Matrex.new("1 2 3; 4 5 6; 7 8 9;")
     expected = [1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0]
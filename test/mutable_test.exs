@@ -0,0 +1,114 @@
+defmodule MutableTest do
+  use ExUnit.Case, async: true
+  alias Matrex.Mutable
+
+  doctest Matrex.Mutable
+
+  test "#new/1 copies matrix" do
+    matrix = Matrex.new("1 2 3; 4 5 6")
+    mutable = Mutable.new(matrix)
+
+    assert Mutable.size(mutable) == {2, 3}
+    assert Mutable.to_matrex(mutable) == matrix
+  end
+
+  test "#add!/5 writes sum into destination" do
+    first = Matrex.new("1 2 3; 4 5 6")
+    second = Matrex.new("3 2 1; 6 5 4")
+    destination = Mutable.zeros(2, 3)
+
+    assert Mutable.add!(destination, first, second, 2.0, 3.0) == destination
+    assert Mutable.to_matrex(destination) == Matrex.add(first, second, 2.0, 3.0)
+  end
+
+  test "#add!/3 accumulates into one of operands" do
+    step = Matrex.new("1 2; 3 4")
+    accumulator = Mutable.zeros(2, 2)
+
+    for _ <- 1..3, do: Mutable.add!(accumulator, accumulator, step)
+
+    assert Mutable.to_matrex(accumulator) == Matrex.multiply(step, 3)
+  end
+
+  test "#multiply!/3 writes elementwise product into destination" do
+    first = Matrex.new("1 2 3; 4 5 6")
+    second = Mutable.new(Matrex.new("3 2 1; 6 5 4"))
+    destination = Mutable.zeros(2, 3)
+
+    Mutable.multiply!(destination, first, second)
+
+    assert Mutable.to_matrex(destination) == Matrex.new("3 4 3; 24 25 24")
+  end
+
+  test "#dot!/4 writes matrix product into destination" do
+    first = Matrex.random(7, 5)
+    second = Matrex.random(5, 3)
+    destination = Mutable.zeros(7, 3)
+
+    Mutable.dot!(destination, Mutable.new(first), second, 2.0)
+
+    expected = first |> Matrex.dot(second) |> Matrex.multiply(2.0)
+
+    destination
+    |> Mutable.to_matrex()
+    |> Matrex.subtract(expected)
+    |> Enum.each(&assert(abs(&1) < 1.0e-5))
+  end
+
+  test "#dot!/4 raises, when destination is one of operands" do
+    matrix = Mutable.new(Matrex.eye(3))
+
+    assert_raise ErlangError, ~r/Destination matrix must differ from operands/, fn ->
+      Mutable.dot!(matrix, matrix, Matrex.eye(3))
+    end
+  end
+
+  test "#dot!/4 raises, when destination is of wrong size" do
+    assert_raise ErlangError, ~r/Matrices sizes mismatch/, fn ->
+      Mutable.dot!(Mutable.zeros(2, 2), Matrex.ones(2, 3), Matrex.ones(3, 3))
+    end
+  end
+
+  test "#apply!/2 applies math function in place" do
+    matrix = Matrex.new("0 1; 2 3")
+    mutable = Mutable.new(matrix)
+
+    Mutable.apply!(mutable, :exp)
+
+    assert Mutable.to_matrex(mutable) == Matrex.apply(matrix, :exp)
+  end
+
+  test "#apply!/3 raises on unknown function" do
+    assert_raise ArgumentError, fn ->
+      Mutable.apply!(Mutable.zeros(2, 2), Matrex.ones(2, 2), :unknown)
+    end
+  end
+
+  test "#transpose!/1 transposes square matrix in place" do
+    matrix = Matrex.random(150)
+    mutable = Mutable.new(matrix)
+
+    Mutable.transpose!(mutable)
+
+    assert Mutable.to_matrex(mutable) == Matrex.transpose(matrix)
+  end
+
+  test "#transpose!/1 raises on non-square matrix" do
+    assert_raise ErlangError, ~r/Matrices sizes mismatch/, fn ->
+      Mutable.transpose!(Mutable.zeros(2, 3))
+    end
+  end
+
+  test "#transpose!/2 writes transposition into destination" do
+    matrix = Matrex.random(70, 130)
+    destination = Mutable.zeros(130, 70)
+
+    Mutable.transpose!(destination, matrix)
+
+    assert Mutable.to_matrex(destination) == Matrex.transpose(matrix)
+  end
+
+  test "#inspect/1 shows size" do
+    assert inspect(Mutable.zeros(3, 4)) == "#Matrex.Mutable[3×4]"
+  end
+end
@@ -62,18 +62,168 @@ defmodule SaveLoadTest do
     assert File.rm(@test_file_name_csv) == :ok
   end
 
+  test "Saves to .csv elements in the shortest form, which reads back exactly" do
+    m = Matrex.new([[0.1, 1.5e-38, -3], [:nan, :inf, 0]])
+    Matrex.save(m, @test_file_name_csv)
+
+    assert File.read!(@test_file_name_csv) == "0.1,1.5e-38,-3\nNaN,Inf,0\n"
+    assert Matrex.load(@test_file_name_csv) == m
+    assert File.rm(@test_file_name_csv) == :ok
+  end
+
+  test "Saves to and loads from .csv format matrix larger than read and write chunks" do
+    m = Matrex.random(700, 600)
+    Matrex.save(m, @test_file_name_csv)
+    assert Matrex.load(@test_file_name_csv, :csv) == m
+    assert File.rm(@test_file_name_csv) == :ok
+  end
+
+  test "#new/1 raises on malformed text" do
+    assert_raise ArgumentError, ~r/Unparseable matrix element value: 2x/, fn ->
+      Matrex.new("1 2x; 3 4")
+    end
+
+    assert_raise ArgumentError, ~r/different lengths/, fn ->
+      Matrex.new("1 2; 3")
+    end
+  end
+
+  test "#load/2 maps .mtx file read-only" do
+    file_name = "_test_mmap.mtx"
+    m = Matrex.random(30, 20)
+    Matrex.save(m, file_name)
+
+    mapped = Matrex.load(file_name, mmap: true)
+    assert mapped == m
+    assert Matrex.load(file_name, mmap: :read_only) |> Matrex.dot(Matrex.eye(20)) == m
+
+    # Rewriting the mapped file would change `mapped`, so typed matrix is saved into another one.
+    typed_file_name = "_test_mmap_typed.mtx"
+    typed = Matrex.Typed.new(m, :float16)
+    Matrex.Typed.save(typed, typed_file_name)
+    assert Matrex.load(typed_file_name, mmap: true) == typed
+
+    File.rm!(file_name)
+    File.rm!(typed_file_name)
+    assert Matrex.sum(mapped) == Matrex.sum(m)
+  end
+
+  test "#load/2 maps .mtx file copy-on-write as mutable matrix" do
+    file_name = "_test_mmap_cow.mtx"
+    m = Matrex.magic(4)
+    Matrex.save(m, file_name)
+
+    mutable = Matrex.load(file_name, mmap: :copy_on_write)
+    Matrex.Mutable.add!(mutable, mutable, m)
+
+    assert Matrex.Mutable.to_matrex(mutable) == Matrex.multiply(m, 2)
+    assert Matrex.load(file_name) == m
+    File.rm!(file_name)
+  end
+
+  test "#load/2 raises on mapping missing or malformed file" do
+    assert_raise ErlangError, ~r/Failed to open/, fn ->
+      Matrex.load("test/data/missing.mtx", mmap: true)
+    end
+
+    assert_raise ErlangError, ~r/Invalid matrix file/, fn ->
+      Matrex.load("test/data/matrex.csv", mmap: true)
+    end
+  end
+
+  test "#load/2 raises on typed matrix header, which size overflows" do
+    # 2^31 × 2^31 int32 elements take 2^64 bytes, which wraps to the 16 bytes of the header.
+    forged =
+      <<2_147_483_648::unsigned-integer-little-32, 2_147_483_648::unsigned-integer-little-32,
+        6::unsigned-integer-little-32, "MTXT">>
+
+    file_name = "_test_forged.mtx"
+    File.write!(file_name, forged)
+    File.write!(file_name <> ".gz", :zlib.gzip(forged))
+
+    assert_raise ErlangError, ~r/Invalid matrix file/, fn ->
+      Matrex.load(file_name, mmap: true)
+    end
+
+    assert_raise ErlangError, ~r/Invalid matrix file/, fn -> Matrex.load(file_name <> ".gz") end
+    assert_raise ArgumentError, fn -> Matrex.Typed.sum(%Matrex.Typed{data: forged}) end
+
+    File.rm!(file_name)
+    File.rm!(file_name <> ".gz")
+  end
+
+  test "#load/2 raises on float matrix header, which size overflows" do
+    # (2^31 × 2^31 + 2) floats take 2^64 + 8 bytes, which wraps to the 8 bytes of the header.
+    file_name = "_test_forged_float.mtx"
+
+    File.write!(
+      file_name,
+      <<2_147_483_648::unsigned-integer-little-32, 2_147_483_648::unsigned-integer-little-32>>
+    )
+
+    assert_raise ErlangError, ~r/Invalid matrix file/, fn ->
+      Matrex.load(file_name, mmap: true)
+    end
+
+    File.rm!(file_name)
+  end
+
   test "#load loads matrix from .idx format" do
     m = Matrex.load("test/data/t10k-labels-idx1-ubyte.idx")
-    assert Matrex.size(m) == {10_000, 1}
+    assert Matrex.Typed.size(m) == {10_000, 1}
+    assert Matrex.Typed.type(m) == :uint8
   end
 
   test "#load loads matrix from .idx format with explicit format set" do
     m = Matrex.load("test/data/t10k-labels-idx1-ubyte.idx", :idx)
-    assert Matrex.size(m) == {10_000, 1}
+    assert Matrex.Typed.size(m) == {10_000, 1}
+    assert m |> Matrex.Typed.to_list() |> Enum.all?(&(&1 in 0..9))
+  end
+
+  test "#load/2 converts .idx integers to floats and normalizes them" do
+    file_name = "test/data/t10k-images-idx3-ubyte.idx.gz"
+    floats = file_name |> Matrex.load() |> Matrex.Typed.to_matrex()
+
+    assert Matrex.load(file_name, float: true) == floats
+    assert Matrex.load(file_name, normalize: true) == Matrex.normalize(floats)
+  end
+
+  test "#load inflates .mtx.gz and .csv.gz files chunk by chunk" do
+    assert Matrex.load("test/data/Ytest.mtx.gz") == Matrex.load("test/data/Ytest.mtx")
+
+    m = Matrex.random(300, 200)
+    file_name = "_test_gz.csv.gz"
+    Matrex.save(m, "_test_gz.csv")
+    File.write!(file_name, :zlib.gzip(File.read!("_test_gz.csv")))
+
+    assert Matrex.load(file_name) == m
+    File.rm!("_test_gz.csv")
+    File.rm!(file_name)
+  end
+
+  test "#load raises on truncated .mtx.gz file" do
+    file_name = "_test_truncated.mtx.gz"
+    data = :zlib.gzip(binary_part(Matrex.random(10).data, 0, 100))
+    File.write!(file_name, data)
+
+    assert_raise ErlangError, ~r/Invalid matrix file/, fn -> Matrex.load(file_name) end
+    File.rm!(file_name)
+  end
+
+  test "#load raises on .mtx.gz file, truncated within gzip trailer" do
+    file_name = "_test_truncated_trailer.mtx.gz"
+    data = :zlib.gzip(Matrex.random(10).data)
+    # The matrix itself inflates completely, but CRC and size of the gzip trailer are missing.
+    File.write!(file_name, binary_part(data, 0, byte_size(data) - 8))
+
+    assert_raise ErlangError, ~r/data_error/, fn -> Matrex.load(file_name) end
+    File.rm!(file_name)
   end
 
-  test "#load loads matrix from .idx.gz format" do
+  test "#load loads matrix from .idx.gz format, keeping bytes" do
     m = Matrex.load("test/data/t10k-images-idx3-ubyte.idx.gz")
-    assert Matrex.size(m) == {10_000, 28 * 28}
+    assert Matrex.Typed.size(m) == {10_000, 28 * 28}
+    assert byte_size(m.data) == 16 + 10_000 * 28 * 28
+    assert Matrex.Typed.max(m) == 255
   end
 end
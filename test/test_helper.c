@@ -27,7 +27,11 @@ int main() {
   test_matrix_max();
   test_matrix_multiply();
   test_matrix_multiply_with_scalar();
+  test_matrix_reduce_columns();
+  test_matrix_reduce_rows();
   test_matrix_subtract();
   test_matrix_sum();
   test_matrix_transpose();
+  test_matrix_transpose_tiled();
+  test_matrix_transpose_in_place();
 }
@@ -0,0 +1,220 @@
+defmodule TypedTest do
+  use ExUnit.Case, async: true
+  alias Matrex.Typed
+
+  doctest Matrex.Typed
+
+  test "#new/2 converts Matrex and back" do
+    matrix = Matrex.random(5, 7)
+
+    for type <- [:float32, :float64] do
+      typed = Typed.new(matrix, type)
+
+      assert Typed.type(typed) == type
+      assert Typed.size(typed) == {5, 7}
+      assert Typed.to_matrex(typed) == matrix
+    end
+  end
+
+  test "#new/2 rounds to half precision and bfloat16 and keeps special values" do
+    for type <- [:float16, :bfloat16] do
+      typed = Typed.new([[1.0, 0.5], [:nan, :neg_inf]], type)
+
+      assert Typed.type(typed) == type
+      assert byte_size(typed.data) == 16 + 4 * 2
+      assert Typed.to_list(typed) == [1.0, 0.5, :nan, :neg_inf]
+    end
+
+    assert Typed.new([[65_520, 1.0e-8]], :float16) |> Typed.to_list() == [:inf, 0.0]
+    assert Typed.new([[1 + 1 / 256, 1 + 3 / 256]], :bfloat16) |> Typed.to_list() ==
+             [1.0, 1.015625]
+  end
+
+  test "#dot/3, #add/2, #sum/1 and #apply/2 of half precision matrices compute in float" do
+    a = Matrex.random(30, 40)
+    b = Matrex.random(40, 20)
+
+    for {type, tolerance} <- [float16: 4.0e-3, bfloat16: 3.2e-2] do
+      half_a = Typed.new(a, type)
+      half_b = Typed.new(b, type)
+
+      half_a |> Typed.dot(half_b) |> assert_close(Matrex.dot(a, b), tolerance)
+      half_a |> Typed.add(half_a) |> assert_close(Matrex.multiply(a, 2), tolerance)
+      half_a |> Typed.apply(:exp) |> assert_close(Matrex.apply(a, :exp), tolerance)
+
+      assert_in_delta Typed.sum(half_a), Matrex.sum(a), 30 * tolerance
+    end
+  end
+
+  test "#new/2 rounds and saturates integers" do
+    list = [[-300, -1.5, 0.5, 2.5, 300, :nan]]
+
+    assert list |> Typed.new(:int8) |> Typed.to_list() == [-128, -2, 0, 2, 127, 0]
+    assert list |> Typed.new(:uint8) |> Typed.to_list() == [0, 0, 0, 2, 255, 0]
+    assert list |> Typed.new(:int32) |> Typed.to_list() == [-300, -2, 0, 2, 300, 0]
+    assert Typed.new([[3_000_000_000]], :int32) |> Typed.to_list() == [2_147_483_647]
+  end
+
+  test "#add/2 and #sum/1 of integer matrices saturate and return integers" do
+    a = Typed.new([[100, 200], [250, 5]], :uint8)
+
+    assert a |> Typed.add(a) |> Typed.to_list() == [200, 255, 255, 10]
+    assert Typed.sum(a) == 555
+    assert Typed.max(a) == 250
+    assert Typed.to_matrex(a) == Matrex.new([[100, 200], [250, 5]])
+  end
+
+  test "#quantized_dot/3 multiplies int8 matrices exactly and applies scales" do
+    a = Matrex.new(for i <- 1..7, do: for(j <- 1..33, do: rem(i * j * 37, 255) - 127))
+    b = Matrex.new(for i <- 1..33, do: for(j <- 1..5, do: rem(i * j * 53, 255) - 127))
+    exact = Matrex.dot(a, b)
+
+    product = Typed.quantized_dot(Typed.new(a, :int8), Typed.new(b, :int8))
+
+    assert Typed.type(product) == :int32
+    assert Typed.to_matrex(product) == exact
+
+    row_scales = Matrex.new(for i <- 1..7, do: [i / 4])
+    column_scales = Matrex.new([[1, 2, 3, 4, 5]])
+
+    scaled =
+      Typed.quantized_dot(Typed.new(a, :int8), Typed.new(b, :int8),
+        scales: {row_scales, column_scales}
+      )
+
+    assert Typed.type(scaled) == :float32
+
+    scaled
+    |> Typed.to_matrex()
+    |> Enum.zip(exact |> Matrex.multiply(row_scales) |> Matrex.multiply(column_scales))
+    |> Enum.each(fn {value, expected} ->
+      assert_in_delta value, expected, 1.0e-6 * abs(expected)
+    end)
+  end
+
+  test "#quantized_dot/3 raises on matrices of other types" do
+    assert_raise ErlangError, ~r/Matrices types mismatch/, fn ->
+      Typed.quantized_dot(Typed.zeros(2, 2, :uint8), Typed.zeros(2, 2, :int8))
+    end
+  end
+
+  test "#quantized_dot/3 raises on inner dimension, which could overflow int32 sums" do
+    assert_raise ArgumentError, fn ->
+      Typed.quantized_dot(Typed.zeros(1, 131_072, :int8), Typed.zeros(131_072, 1, :int8))
+    end
+  end
+
+  test "#new/2 keeps double precision and special values" do
+    typed = Typed.new([[0.1, :nan], [:inf, :neg_inf]])
+
+    assert Typed.to_list(typed) == [0.1, :nan, :inf, :neg_inf]
+    assert typed |> Typed.convert(:float32) |> Typed.to_list() |> hd() == 0.10000000149011612
+  end
+
+  test "#add/2, #subtract/2, #multiply/2 and #divide/2 work with matrices and scalars" do
+    a = Typed.new([[1, 2], [3, 4]])
+    b = Typed.new([[4, 3], [2, 1]])
+
+    assert Typed.to_list(Typed.add(a, b)) == [5.0, 5.0, 5.0, 5.0]
+    assert Typed.to_list(Typed.subtract(1, a)) == [0.0, -1.0, -2.0, -3.0]
+    assert Typed.to_list(Typed.multiply(a, 0.5)) == [0.5, 1.0, 1.5, 2.0]
+    assert Typed.to_list(Typed.divide(a, b)) == [0.25, 2 / 3, 1.5, 4.0]
+    assert Typed.to_list(Typed.divide(2, a)) == [2.0, 1.0, 2 / 3, 0.5]
+  end
+
+  test "#add/2 raises on different types or sizes" do
+    assert_raise ErlangError, ~r/Matrices types mismatch/, fn ->
+      Typed.add(Typed.zeros(2, 2), Typed.zeros(2, 2, :float32))
+    end
+
+    assert_raise ErlangError, ~r/Matrices sizes mismatch/, fn ->
+      Typed.add(Typed.zeros(2, 2), Typed.zeros(2, 3))
+    end
+  end
+
+  test "#dot/3 multiplies in double precision" do
+    a = Typed.new([[1.0e-8, 1], [1, 1]])
+    b = Typed.new([[1], [-1]])
+
+    assert Typed.to_list(Typed.dot(a, b, 2)) == [2 * (1.0e-8 - 1), 0.0]
+  end
+
+  test "#dot/3 of float32 matrices gives the same result as Matrex.dot/2" do
+    a = Matrex.random(20, 30)
+    b = Matrex.random(30, 10)
+
+    result = Typed.dot(Typed.new(a, :float32), Typed.new(b, :float32)) |> Typed.to_matrex()
+
+    result
+    |> Matrex.subtract(Matrex.dot(a, b))
+    |> Enum.each(&assert(abs(&1) < 1.0e-5))
+  end
+
+  test "#transpose/1 transposes" do
+    a = Typed.new([[1, 2, 3], [4, 5, 6]])
+
+    assert a |> Typed.transpose() |> Typed.to_list_of_lists() ==
+             [[1.0, 4.0], [2.0, 5.0], [3.0, 6.0]]
+  end
+
+  test "#apply/2 applies math functions in double precision" do
+    assert [[1]] |> Typed.new() |> Typed.apply(:exp) |> Typed.to_list() == [:math.exp(1)]
+    assert [[2]] |> Typed.new() |> Typed.apply(:sqrt) |> Typed.to_list() == [:math.sqrt(2)]
+  end
+
+  test "#sum/1, #max/1 and #min/1 reduce" do
+    a = Typed.new([[0.1, 0.2], [-0.3, 0.4]])
+
+    assert Typed.sum(a) == 0.1 + 0.2 + -0.3 + 0.4
+    assert Typed.max(a) == 0.4
+    assert Typed.min(a) == -0.3
+  end
+
+  test "#cholesky/1 and #forward_substitute/2 solve ill-conditioned system" do
+    size = 8
+    hilbert = Typed.new(for i <- 1..size, do: for(j <- 1..size, do: 1 / (i + j - 1)))
+    lower = Typed.cholesky(hilbert)
+
+    lower
+    |> Typed.dot(Typed.transpose(lower))
+    |> Typed.subtract(hilbert)
+    |> Typed.to_list()
+    |> Enum.each(&assert(abs(&1) < 1.0e-14))
+
+    solution = Typed.forward_substitute(lower, Typed.ones(size, 1))
+
+    lower
+    |> Typed.dot(solution)
+    |> Typed.subtract(1)
+    |> Typed.to_list()
+    |> Enum.each(&assert(abs(&1) < 1.0e-9))
+  end
+
+  test "#eye/2 creates identity matrix" do
+    assert Typed.eye(2, :float32) |> Typed.to_matrex() == Matrex.eye(2)
+  end
+
+  test "#save/2 saves typed matrix, which Matrex.load/1 reads back" do
+    file_name = "test/typed_test.mtx"
+    typed = Typed.new([[1.0e-300, 2], [3, 4]])
+
+    Typed.save(typed, file_name)
+    loaded = Matrex.load(file_name)
+    File.rm!(file_name)
+
+    assert loaded == typed
+  end
+
+  test "#inspect/1 shows type and size" do
+    assert inspect(Typed.zeros(3, 4)) == "#Matrex.Typed<float64>[3×4]"
+  end
+
+  defp assert_close(typed, expected, tolerance) do
+    typed
+    |> Typed.to_matrex()
+    |> Enum.zip(expected)
+    |> Enum.each(fn {value, exact} ->
+      assert abs(value - exact) <= tolerance * max(abs(exact), 1)
+    end)
+  end
+end
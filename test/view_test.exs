@@ -0,0 +1,84 @@
+defmodule ViewTest do
+  use ExUnit.Case, async: true
+  alias Matrex.View
+
+  doctest Matrex.View
+
+  test "#submatrix/3 refers to matrix data without copying it" do
+    matrix = Matrex.magic(6)
+    view = View.submatrix(matrix, 2..4, 3..6)
+
+    assert %View{offset: 8, rows: 3, columns: 4, stride: 6} = view
+    assert View.to_matrex(view) == Matrex.submatrix(matrix, 2..4, 3..6)
+  end
+
+  test "#submatrix/3 of a view is relative to the view" do
+    matrix = Matrex.magic(8)
+
+    view =
+      matrix
+      |> View.submatrix(2..7, 2..7)
+      |> View.submatrix(2..3, 3..5)
+
+    assert View.to_matrex(view) == Matrex.submatrix(matrix, 3..4, 4..6)
+  end
+
+  test "#submatrix/3 raises, when position is out of range" do
+    assert_raise RuntimeError, ~r/View position out of range/, fn ->
+      View.submatrix(Matrex.magic(4), 2..5, 1..2)
+    end
+  end
+
+  test "#sum/1 rejects view, which stride wraps its last row into matrix bounds" do
+    %Matrex{data: data} = Matrex.magic(2)
+    view = %View{matrix: data, offset: 0, rows: 2, columns: 1, stride: 0xFFFF_FFFF_FFFF_FFFF}
+
+    assert_raise ArgumentError, fn -> View.sum(view) end
+  end
+
+  test "#row/2 and #column/2 match their Matrex counterparts" do
+    matrix = Matrex.magic(5)
+
+    assert View.to_matrex(View.row(matrix, 3)) == Matrex.row(matrix, 3)
+    assert View.to_matrex(View.column(matrix, 4)) == Matrex.column(matrix, 4)
+  end
+
+  test "#sum/1 sums view elements" do
+    matrix = Matrex.magic(7)
+
+    assert View.sum(View.submatrix(matrix, 2..5, 3..4)) ==
+             Matrex.sum(Matrex.submatrix(matrix, 2..5, 3..4))
+  end
+
+  test "#add/4 adds views" do
+    matrix = Matrex.magic(6)
+    first = View.submatrix(matrix, 1..3, 1..3)
+    second = View.submatrix(matrix, 4..6, 4..6)
+
+    assert View.add(first, second, 2.0, 3.0) ==
+             Matrex.add(View.to_matrex(first), View.to_matrex(second), 2.0, 3.0)
+  end
+
+  test "#add/4 raises, when sizes do not match" do
+    assert_raise ErlangError, ~r/Matrices sizes mismatch/, fn ->
+      View.add(View.row(Matrex.magic(3), 1), View.column(Matrex.magic(3), 1))
+    end
+  end
+
+  test "#dot/3 multiplies views and matrices" do
+    inputs = Matrex.random(100, 20)
+    weights = Matrex.random(20, 5)
+    batch = View.rows(inputs, 31..40)
+
+    expected = Matrex.submatrix(inputs, 31..40, 1..20) |> Matrex.dot(weights)
+
+    batch
+    |> View.dot(weights)
+    |> Matrex.subtract(expected)
+    |> Enum.each(&assert(abs(&1) < 1.0e-5))
+  end
+
+  test "#inspect/1 shows size" do
+    assert inspect(View.rows(Matrex.magic(4), 2..3)) == "#Matrex.View[2×4]"
+  end
+end